@@ -0,0 +1,380 @@
+/**
+ * @file ntc-alarm.c
+ * @brief NTC thermistor library (alarms)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ntc-alarm.h"
+
+/* constants ================================================================ */
+/* Number of readings compared before testing if one of them crossed */
+#define BLOCK 64
+
+/* structures =============================================================== */
+#if defined(__GNUC__)
+/* Vectors of the resistance compares, lowered to SSE2 or NEON */
+typedef double vdouble __attribute__ ((vector_size (16)));
+typedef int64_t vmask __attribute__ ((vector_size (16)));
+#define VLEN (sizeof (vdouble) / sizeof (double))
+#endif
+
+/* Condition of a transition: reading above, or below, the threshold */
+typedef struct xEdge {
+  int bAbove;
+  double dBound;
+  int32_t iBound;
+} xEdge;
+
+struct xNtcAlarm {
+  unsigned uCount;
+  uint32_t uState;
+  int bCode;                      /* alarm on ADC codes */
+  xEdge xEdge[NTC_ALARM_MAX][2];  /* activation, clearing */
+  /* band in which the state can not change */
+  double dLow, dHigh;
+  int32_t iLow, iHigh;
+};
+
+/* private functions ======================================================== */
+/*
+ * Resistance of an ADC code, infinite or null beyond the divider range.
+ */
+static double
+rescode (const xNtcAdcConfig * c, unsigned code) {
+  double r = dNtcAdcCodeToRes (c, code);
+
+  if (isnan (r)) {
+    return (c->eDivider == eNtcPullUp) ? INFINITY : 0.0;
+  }
+  return r;
+}
+
+/*
+ * Condition on the ADC codes equivalent to a resistance above (bAbove) or
+ * below dBound, the resistance is monotonic in the code.
+ */
+static void
+edgecode (const xNtcAdcConfig * c, xEdge * e) {
+  unsigned code, n = 1U << c->iBits, count = 0;
+  double r;
+
+  /* codes on the side of the transition */
+  for (code = 0; code < n; code++) {
+
+    r = rescode (c, code);
+    count += e->bAbove ? (r > e->dBound) : (r < e->dBound);
+  }
+  /* side of the lowest codes: the same for the resistances of a pull-up */
+  if (e->bAbove == (c->eDivider == eNtcPullUp)) {
+
+    e->bAbove = 1;
+    e->iBound = n - count - 1;
+  }
+  else {
+
+    e->bAbove = 0;
+    e->iBound = count;
+  }
+}
+
+/*
+ * Band of the readings that do not change the state.
+ */
+static void
+band (xNtcAlarm * a) {
+  const xEdge * e;
+  unsigned i;
+
+  a->dLow = -INFINITY;
+  a->dHigh = INFINITY;
+  a->iLow = INT32_MIN;
+  a->iHigh = INT32_MAX;
+  for (i = 0; i < a->uCount; i++) {
+
+    e = &a->xEdge[i][ (a->uState >> i) & 1];
+    if (e->bAbove) {
+
+      a->dHigh = (e->dBound < a->dHigh) ? e->dBound : a->dHigh;
+      a->iHigh = (e->iBound < a->iHigh) ? e->iBound : a->iHigh;
+    }
+    else {
+
+      a->dLow = (e->dBound > a->dLow) ? e->dBound : a->dLow;
+      a->iLow = (e->iBound > a->iLow) ? e->iBound : a->iLow;
+    }
+  }
+}
+
+/*
+ * Index of the first resistance outside of [low, high] from i, n if none.
+ * The compares of a block are not branched on, so that they are vectorized.
+ */
+static size_t
+scanres (const double r[], size_t i, size_t n, double low, double high) {
+#if defined(__GNUC__)
+  vdouble v;
+  vmask out;
+  size_t j;
+
+  for (; i + BLOCK <= n; i += BLOCK) {
+
+    out = (vmask) { 0 };
+    for (j = 0; j < BLOCK; j += VLEN) {
+
+      memcpy (&v, &r[i + j], sizeof (v));
+      out |= (v < low) | (v > high);
+    }
+    if (out[0] | out[1]) {
+      break;
+    }
+  }
+#endif
+  for (; i < n; i++) {
+
+    if ( (r[i] < low) || (r[i] > high)) {
+      break;
+    }
+  }
+  return i;
+}
+
+/*
+ * Index of the first ADC code outside of [low, high] from i, n if none,
+ * vectorized by the compiler.
+ */
+static size_t
+scancode (const uint16_t c[], size_t i, size_t n, int32_t low, int32_t high) {
+  size_t j;
+  int out;
+
+  for (; i + BLOCK <= n; i += BLOCK) {
+
+    out = 0;
+    for (j = 0; j < BLOCK; j++) {
+
+      out |= (c[i + j] < low) | (c[i + j] > high);
+    }
+    if (out) {
+      break;
+    }
+  }
+  for (; i < n; i++) {
+
+    if ( (c[i] < low) || (c[i] > high)) {
+      break;
+    }
+  }
+  return i;
+}
+
+/*
+ * Transitions of a reading, 0 if they do not fit in the n events left.
+ */
+static int
+evaluate (xNtcAlarm * a, double r, int32_t c, size_t index,
+          xNtcAlarmEvent * ev, size_t n) {
+  const xEdge * e;
+  uint32_t flip = 0;
+  unsigned i, count = 0;
+
+  for (i = 0; i < a->uCount; i++) {
+
+    e = &a->xEdge[i][ (a->uState >> i) & 1];
+    if (a->bCode ? (e->bAbove ? c > e->iBound : c < e->iBound) :
+        (e->bAbove ? r > e->dBound : r < e->dBound)) {
+
+      flip |= 1UL << i;
+      count++;
+    }
+  }
+  if (count > n) {
+
+    return -1;
+  }
+  for (i = 0; i < a->uCount; i++) {
+
+    if (flip & (1UL << i)) {
+
+      ev->xIndex = index;
+      ev->uSetpoint = i;
+      ev->bActive = ! ( (a->uState >> i) & 1);
+      ev++;
+    }
+  }
+  a->uState ^= flip;
+  band (a);
+  return count;
+}
+
+/* internal public functions ================================================ */
+// -----------------------------------------------------------------------------
+xNtcAlarm *
+xNtcAlarmNew (const double dCoeff[4], const xNtcAlarmSetpoint xSet[],
+              unsigned uCount, const xNtcAdcConfig * xAdc) {
+  xNtcAlarm * a;
+  double on, off;
+  unsigned i, j;
+
+  if ( (uCount < 1) || (uCount > NTC_ALARM_MAX) ||
+       (xAdc && ( (xAdc->iBits < 1) || (xAdc->iBits > 16) ||
+                  (xAdc->dSeries <= 0.0) || (xAdc->dVref <= 0.0)))) {
+
+    return NULL;
+  }
+  a = calloc (1, sizeof (xNtcAlarm));
+  if (a == NULL) {
+
+    return NULL;
+  }
+  a->uCount = uCount;
+  a->bCode = (xAdc != NULL);
+  for (i = 0; i < uCount; i++) {
+
+    if (! (xSet[i].dHyst >= 0.0)) {
+
+      free (a);
+      return NULL;
+    }
+    /* the resistance decreases when the temperature increases */
+    if (xSet[i].eType == eNtcAlarmOver) {
+
+      on = dNtcTempToRes (xSet[i].dTemp, (double *) dCoeff);
+      off = dNtcTempToRes (xSet[i].dTemp - xSet[i].dHyst, (double *) dCoeff);
+      a->xEdge[i][0].bAbove = 0;
+      a->xEdge[i][1].bAbove = 1;
+    }
+    else {
+
+      on = dNtcTempToRes (xSet[i].dTemp, (double *) dCoeff);
+      off = dNtcTempToRes (xSet[i].dTemp + xSet[i].dHyst, (double *) dCoeff);
+      a->xEdge[i][0].bAbove = 1;
+      a->xEdge[i][1].bAbove = 0;
+    }
+    if (isnan (on) || isnan (off)) {
+
+      free (a);
+      return NULL;
+    }
+    a->xEdge[i][0].dBound = on;
+    a->xEdge[i][1].dBound = off;
+    for (j = 0; xAdc && (j < 2); j++) {
+
+      edgecode (xAdc, &a->xEdge[i][j]);
+    }
+  }
+  band (a);
+  return a;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcAlarmDelete (xNtcAlarm * xAlarm) {
+
+  free (xAlarm);
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcAlarmThresholds (const xNtcAlarm * xAlarm, unsigned uSetpoint,
+                     double * dOn, double * dOff) {
+
+  if (uSetpoint >= xAlarm->uCount) {
+
+    return -1;
+  }
+  if (xAlarm->bCode) {
+
+    *dOn = xAlarm->xEdge[uSetpoint][0].iBound;
+    *dOff = xAlarm->xEdge[uSetpoint][1].iBound;
+  }
+  else {
+
+    *dOn = xAlarm->xEdge[uSetpoint][0].dBound;
+    *dOff = xAlarm->xEdge[uSetpoint][1].dBound;
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+uint32_t
+uNtcAlarmState (const xNtcAlarm * xAlarm) {
+
+  return xAlarm->uState;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcAlarmSetState (xNtcAlarm * xAlarm, uint32_t uState) {
+
+  xAlarm->uState = uState &
+                   ( (xAlarm->uCount < 32) ? (1UL << xAlarm->uCount) - 1 :
+                     UINT32_MAX);
+  band (xAlarm);
+}
+
+// -----------------------------------------------------------------------------
+size_t
+xNtcAlarmRes (xNtcAlarm * xAlarm, const double dR[], size_t xCount,
+              xNtcAlarmEvent xEvent[], size_t * xEvents) {
+  size_t i, n = 0;
+  int k;
+
+  for (i = 0; !xAlarm->bCode && (i < xCount); i++) {
+
+    i = scanres (dR, i, xCount, xAlarm->dLow, xAlarm->dHigh);
+    if (i == xCount) {
+      break;
+    }
+    k = evaluate (xAlarm, dR[i], 0, i, &xEvent[n], *xEvents - n);
+    if (k < 0) {
+      break;
+    }
+    n += k;
+  }
+  *xEvents = n;
+  return xAlarm->bCode ? 0 : i;
+}
+
+// -----------------------------------------------------------------------------
+size_t
+xNtcAlarmCode (xNtcAlarm * xAlarm, const uint16_t uCode[], size_t xCount,
+               xNtcAlarmEvent xEvent[], size_t * xEvents) {
+  size_t i, n = 0;
+  int k;
+
+  for (i = 0; xAlarm->bCode && (i < xCount); i++) {
+
+    i = scancode (uCode, i, xCount, xAlarm->iLow, xAlarm->iHigh);
+    if (i == xCount) {
+      break;
+    }
+    k = evaluate (xAlarm, 0.0, uCode[i], i, &xEvent[n], *xEvents - n);
+    if (k < 0) {
+      break;
+    }
+    n += k;
+  }
+  *xEvents = n;
+  return xAlarm->bCode ? i : 0;
+}
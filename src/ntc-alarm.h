@@ -0,0 +1,168 @@
+/**
+ * @file ntc-alarm.h
+ * @brief NTC thermistor library (alarms)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ *
+ * An alarm compares the readings of a thermistor with temperature
+ * setpoints without converting them to temperature: the setpoints and their
+ * hysteresis are converted once, at creation, to thresholds of resistance
+ * or of ADC code. The readings are then scanned by blocks with compares
+ * only, vectorized by the compiler, until one of them crosses the band in
+ * which the state of the alarm can not change, only this reading is
+ * evaluated and the transitions are reported.
+ */
+#ifndef _NTC_ALARM_H_
+#define _NTC_ALARM_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ========================================================================== */
+#include <stddef.h>
+#include <stdint.h>
+#include "ntc.h"
+#include "ntc-lut.h"
+
+/* constants ================================================================ */
+/** Maximal number of setpoints of an alarm */
+#define NTC_ALARM_MAX 32
+
+/**
+ * Kind of setpoint
+ */
+typedef enum {
+  eNtcAlarmOver = 0,  /**< active above dTemp, cleared below dTemp - dHyst */
+  eNtcAlarmUnder = 1  /**< active below dTemp, cleared above dTemp + dHyst */
+} eNtcAlarmType;
+
+/* structures =============================================================== */
+/**
+ * Temperature setpoint
+ */
+typedef struct xNtcAlarmSetpoint {
+  eNtcAlarmType eType;  /**< kind of setpoint */
+  double dTemp;         /**< temperature of activation (in degree Celsius) */
+  double dHyst;         /**< hysteresis (in degree Celsius), 0 or more */
+} xNtcAlarmSetpoint;
+
+/**
+ * Transition of a setpoint
+ */
+typedef struct xNtcAlarmEvent {
+  size_t xIndex;        /**< index of the reading in the batch */
+  unsigned uSetpoint;   /**< number of the setpoint */
+  int bActive;          /**< new state of the setpoint */
+} xNtcAlarmEvent;
+
+/**
+ * Alarm (opaque)
+ */
+typedef struct xNtcAlarm xNtcAlarm;
+
+/* internal public functions ================================================ */
+/**
+ * Create an alarm
+ * The temperatures of the setpoints are converted by dNtcTempToRes(). For
+ * an alarm on ADC codes, a reading of code c has the resistance
+ * dNtcAdcCodeToRes (xAdc, c) (infinite, or null for a pull-down, for a
+ * code beyond the range of the divider) and each threshold is the last
+ * code on the quiet side of the resistance of the setpoint. All the
+ * setpoints are initially inactive.
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @param xSet setpoints
+ * @param uCount number of setpoints, 1 to NTC_ALARM_MAX
+ * @param xAdc divider and ADC configuration for an alarm on ADC codes, NULL
+ *        for an alarm on resistances
+ * @return the alarm, NULL on error. Must be released with vNtcAlarmDelete()
+ */
+xNtcAlarm * xNtcAlarmNew (const double dCoeff[4], const xNtcAlarmSetpoint xSet[],
+                          unsigned uCount, const xNtcAdcConfig * xAdc);
+
+/**
+ * Release an alarm created by xNtcAlarmNew()
+ * @param xAlarm alarm to release, may be NULL
+ */
+void vNtcAlarmDelete (xNtcAlarm * xAlarm);
+
+/**
+ * Thresholds of a setpoint
+ * A reading below the threshold, or above it, in resistance or ADC code, is
+ * on the active side of the setpoint, e.g. for an over-temperature
+ * setpoint on resistances, active if r < dOn and cleared if r > dOff.
+ * @param xAlarm alarm
+ * @param uSetpoint number of the setpoint
+ * @param dOn threshold of activation
+ * @param dOff threshold of clearing
+ * @return 0, -1 if uSetpoint is out of range
+ */
+int iNtcAlarmThresholds (const xNtcAlarm * xAlarm, unsigned uSetpoint,
+                         double * dOn, double * dOff);
+
+/**
+ * State of an alarm
+ * @param xAlarm alarm
+ * @return bit n set if the setpoint n is active
+ */
+uint32_t uNtcAlarmState (const xNtcAlarm * xAlarm);
+
+/**
+ * Set the state of an alarm
+ * @param xAlarm alarm
+ * @param uState bit n set if the setpoint n is active
+ */
+void vNtcAlarmSetState (xNtcAlarm * xAlarm, uint32_t uState);
+
+/**
+ * Evaluation of a batch of resistances
+ * The readings are evaluated in order, the state of the alarm is kept
+ * from a batch to the next one. A NaN reading does not change the state.
+ * The evaluation stops before a reading whose transitions do not fit in
+ * xEvent, which must hold at least as many events as setpoints to evaluate
+ * any reading.
+ * @param xAlarm alarm on resistances
+ * @param dR resistances (in Ohm)
+ * @param xCount number of readings
+ * @param xEvent transitions, in order
+ * @param xEvents size of xEvent, number of transitions on return
+ * @return number of readings evaluated, xCount unless xEvent is full
+ */
+size_t xNtcAlarmRes (xNtcAlarm * xAlarm, const double dR[], size_t xCount,
+                     xNtcAlarmEvent xEvent[], size_t * xEvents);
+
+/**
+ * Evaluation of a batch of ADC codes
+ * Same as xNtcAlarmRes() with integer compares of ADC codes.
+ * @param xAlarm alarm on ADC codes
+ * @param uCode ADC codes
+ * @param xCount number of readings
+ * @param xEvent transitions, in order
+ * @param xEvents size of xEvent, number of transitions on return
+ * @return number of readings evaluated, xCount unless xEvent is full
+ */
+size_t xNtcAlarmCode (xNtcAlarm * xAlarm, const uint16_t uCode[],
+                      size_t xCount, xNtcAlarmEvent xEvent[],
+                      size_t * xEvents);
+
+/* ========================================================================== */
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NTC_ALARM_H_ defined */
@@ -0,0 +1,292 @@
+/**
+ * @file ntc-bank.c
+ * @brief NTC thermistor library (sensor banks)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ntc-bank.h"
+
+/* constants ================================================================ */
+/* Number of readings gathered on the stack by eNtcBankGather */
+#define GATHER_BLOCK 256
+/* Number of readings sorted together by eNtcBankGroup */
+#define GROUP_BLOCK 4096
+
+/* structures =============================================================== */
+struct xNtcBank {
+  unsigned uChannels;
+  unsigned uModels;     /* number of models, model 0 has NaN coefficients */
+  unsigned uMaxModels;  /* allocated models */
+  uint32_t * uModel;    /* model of each channel, 0 if not set */
+  double * dA[4];       /* coefficients of each channel */
+  double * dM[4];       /* coefficients of each model */
+};
+
+/* private functions ======================================================== */
+/*
+ * Model of a reading, 0 for an unknown channel.
+ */
+static inline uint32_t
+model (const xNtcBank * b, uint32_t c) {
+
+  return (c < b->uChannels) ? b->uModel[c] : 0;
+}
+
+/*
+ * Gathers the coefficients of each reading then converts them.
+ */
+static void
+gather (const xNtcBank * b, const uint32_t uChannel[], const double dR[],
+        double dT[], size_t xCount) {
+  double a[4][GATHER_BLOCK];
+  const double * const p[4] = { a[0], a[1], a[2], a[3] };
+  const double * m0 = b->dM[0], * m1 = b->dM[1];
+  const double * m2 = b->dM[2], * m3 = b->dM[3];
+  size_t i, j, n;
+  uint32_t m;
+
+  for (i = 0; i < xCount; i += n) {
+
+    n = (xCount - i < GATHER_BLOCK) ? xCount - i : GATHER_BLOCK;
+    for (j = 0; j < n; j++) {
+
+      m = model (b, uChannel[i + j]);
+      a[0][j] = m0[m];
+      a[1][j] = m1[m];
+      a[2][j] = m2[m];
+      a[3][j] = m3[m];
+    }
+    vNtcResToTempArraySoa (&dR[i], &dT[i], n, p);
+  }
+}
+
+/*
+ * Sorts the readings by model, converts each group then scatters the
+ * temperatures back.
+ */
+static int
+group (const xNtcBank * b, const uint32_t uChannel[], const double dR[],
+       double dT[], size_t xCount) {
+  size_t * start, * pos, i, j, n;
+  uint32_t * m;
+  double * r, c[4];
+  unsigned k, l;
+
+  start = malloc ( (b->uModels + 1) * sizeof (size_t));
+  pos = malloc (GROUP_BLOCK * sizeof (size_t));
+  m = malloc (GROUP_BLOCK * sizeof (uint32_t));
+  r = malloc (GROUP_BLOCK * sizeof (double));
+  if ( (start == NULL) || (pos == NULL) || (m == NULL) || (r == NULL)) {
+
+    free (start);
+    free (pos);
+    free (m);
+    free (r);
+    return -1;
+  }
+
+  for (i = 0; i < xCount; i += n) {
+
+    n = (xCount - i < GROUP_BLOCK) ? xCount - i : GROUP_BLOCK;
+    /* counting sort */
+    memset (start, 0, (b->uModels + 1) * sizeof (size_t));
+    for (j = 0; j < n; j++) {
+
+      m[j] = model (b, uChannel[i + j]);
+      start[m[j] + 1]++;
+    }
+    for (k = 1; k <= b->uModels; k++) {
+
+      start[k] += start[k - 1];
+    }
+    for (j = 0; j < n; j++) {
+
+      pos[j] = start[m[j]]++;
+      r[pos[j]] = dR[i + j];
+    }
+    /* start[k] is now the end of the group k */
+    for (k = 0, j = 0; k < b->uModels; j = start[k++]) {
+
+      if (start[k] > j) {
+
+        for (l = 0; l < 4; l++) {
+
+          c[l] = b->dM[l][k];
+        }
+        vNtcResToTempArray (&r[j], &r[j], start[k] - j, c);
+      }
+    }
+    for (j = 0; j < n; j++) {
+
+      dT[i + j] = r[pos[j]];
+    }
+  }
+  free (start);
+  free (pos);
+  free (m);
+  free (r);
+  return 0;
+}
+
+/* internal public functions ================================================ */
+// -----------------------------------------------------------------------------
+xNtcBank *
+xNtcBankNew (unsigned uChannels) {
+  xNtcBank * xBank;
+  unsigned i, k;
+
+  xBank = calloc (1, sizeof (xNtcBank));
+  if (xBank == NULL) {
+
+    return NULL;
+  }
+  xBank->uChannels = uChannels;
+  xBank->uModels = 1;
+  xBank->uMaxModels = 8;
+  xBank->uModel = calloc (uChannels + 1, sizeof (uint32_t));
+  for (k = 0; k < 4; k++) {
+
+    xBank->dA[k] = malloc ( (uChannels + 1) * sizeof (double));
+    xBank->dM[k] = malloc (xBank->uMaxModels * sizeof (double));
+    if ( (xBank->dA[k] == NULL) || (xBank->dM[k] == NULL)) {
+
+      vNtcBankDelete (xBank);
+      return NULL;
+    }
+    for (i = 0; i < uChannels; i++) {
+
+      xBank->dA[k][i] = NAN;
+    }
+    xBank->dM[k][0] = NAN;
+  }
+  if (xBank->uModel == NULL) {
+
+    vNtcBankDelete (xBank);
+    return NULL;
+  }
+  return xBank;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcBankDelete (xNtcBank * xBank) {
+  unsigned k;
+
+  if (xBank) {
+
+    for (k = 0; k < 4; k++) {
+
+      free (xBank->dA[k]);
+      free (xBank->dM[k]);
+    }
+    free (xBank->uModel);
+    free (xBank);
+  }
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcBankSetChannel (xNtcBank * xBank, unsigned uChannel,
+                    const double dCoeff[4]) {
+  unsigned m, k;
+
+  if (uChannel >= xBank->uChannels) {
+
+    return -1;
+  }
+  for (m = 1; m < xBank->uModels; m++) {
+
+    if ( (xBank->dM[0][m] == dCoeff[0]) && (xBank->dM[1][m] == dCoeff[1]) &&
+         (xBank->dM[2][m] == dCoeff[2]) && (xBank->dM[3][m] == dCoeff[3])) {
+      break;
+    }
+  }
+  if (m == xBank->uModels) {
+
+    if (m == xBank->uMaxModels) {
+
+      for (k = 0; k < 4; k++) {
+        double * p = realloc (xBank->dM[k], 2 * m * sizeof (double));
+
+        if (p == NULL) {
+
+          return -1;
+        }
+        xBank->dM[k] = p;
+      }
+      xBank->uMaxModels = 2 * m;
+    }
+    for (k = 0; k < 4; k++) {
+
+      xBank->dM[k][m] = dCoeff[k];
+    }
+    xBank->uModels++;
+  }
+  xBank->uModel[uChannel] = m;
+  for (k = 0; k < 4; k++) {
+
+    xBank->dA[k][uChannel] = dCoeff[k];
+  }
+  return (int) m;
+}
+
+// -----------------------------------------------------------------------------
+unsigned
+uNtcBankChannels (const xNtcBank * xBank) {
+
+  return xBank->uChannels;
+}
+
+// -----------------------------------------------------------------------------
+unsigned
+uNtcBankModels (const xNtcBank * xBank) {
+
+  return xBank->uModels - 1;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcBankResToTemp (const xNtcBank * xBank, const double dR[], double dT[]) {
+  const double * const a[4] = {
+    xBank->dA[0], xBank->dA[1], xBank->dA[2], xBank->dA[3]
+  };
+
+  vNtcResToTempArraySoa (dR, dT, xBank->uChannels, a);
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcBankStreamResToTemp (const xNtcBank * xBank, const uint32_t uChannel[],
+                         const double dR[], double dT[], size_t xCount,
+                         eNtcBankEval eEval) {
+
+  if (eEval == eNtcBankGroup) {
+
+    return group (xBank, uChannel, dR, dT, xCount);
+  }
+  gather (xBank, uChannel, dR, dT, xCount);
+  return 0;
+}
+
+/* ========================================================================== */
@@ -0,0 +1,133 @@
+/**
+ * @file ntc-bank.h
+ * @brief NTC thermistor library (sensor banks)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#ifndef _NTC_BANK_H_
+#define _NTC_BANK_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ========================================================================== */
+#include <stdint.h>
+#include "ntc.h"
+
+/* constants ================================================================ */
+/**
+ * Evaluation of a stream of (channel, resistance) readings
+ */
+typedef enum {
+  eNtcBankGather = 0, /**< coefficients gathered per reading */
+  eNtcBankGroup = 1   /**< readings grouped by model */
+} eNtcBankEval;
+
+/* structures =============================================================== */
+/**
+ * Sensor bank
+ * Set of channels, each one with the coefficients of its thermistor. The
+ * coefficients are stored as a structure of arrays, per channel and per
+ * distinct model (channels with the same part share a model), so that the
+ * conversion loops load them with vector instructions. Opaque structure.
+ */
+typedef struct xNtcBank xNtcBank;
+
+/* internal public functions ================================================ */
+/**
+ * Create a sensor bank
+ * The channels have no coefficients, their temperature is NaN until
+ * iNtcBankSetChannel() is called.
+ * @param uChannels number of channels
+ * @return the bank, NULL on error. Must be released with vNtcBankDelete()
+ */
+xNtcBank * xNtcBankNew (unsigned uChannels);
+
+/**
+ * Release a bank created by xNtcBankNew()
+ * @param xBank bank to release, may be NULL
+ */
+void vNtcBankDelete (xNtcBank * xBank);
+
+/**
+ * Set the coefficients of a channel
+ * Channels with identical coefficients share the same model.
+ * @param xBank sensor bank
+ * @param uChannel channel number, from 0 to uNtcBankChannels() - 1
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @return model number of the channel (from 1), -1 on error
+ */
+int iNtcBankSetChannel (xNtcBank * xBank, unsigned uChannel,
+                        const double dCoeff[4]);
+
+/**
+ * Number of channels of a bank
+ * @param xBank sensor bank
+ * @return number of channels
+ */
+unsigned uNtcBankChannels (const xNtcBank * xBank);
+
+/**
+ * Number of distinct models of a bank
+ * @param xBank sensor bank
+ * @return number of models
+ */
+unsigned uNtcBankModels (const xNtcBank * xBank);
+
+/**
+ * Conversion of one reading per channel
+ * dR[i] is the resistance of the channel i, the conversion is done by
+ * vNtcResToTempArraySoa() on the coefficients of the channels.
+ * @param xBank sensor bank
+ * @param dR resistances of all the channels (in Ohm)
+ * @param dT corresponding temperatures (in degree Celsius), may be dR
+ */
+void vNtcBankResToTemp (const xNtcBank * xBank, const double dR[],
+                        double dT[]);
+
+/**
+ * Conversion of a stream of (channel, resistance) readings
+ * With eNtcBankGather, the coefficients of each reading are gathered from
+ * the table of models, which is small and stays in cache, then converted
+ * by vNtcResToTempArraySoa(). With eNtcBankGroup, the readings are sorted
+ * by model (counting sort by blocks), each group is converted by
+ * vNtcResToTempArray() then scattered back. Gathering is usually faster,
+ * grouping may be better on targets where the kernel with per lane
+ * coefficients is slow and when a few models are shared by many channels.
+ * The temperature of an unknown channel or of
+ * a channel without coefficients is NaN. The bank is not modified, the
+ * function may be called from several threads.
+ * @param xBank sensor bank
+ * @param uChannel channel numbers of the readings
+ * @param dR resistances of the readings (in Ohm)
+ * @param dT corresponding temperatures (in degree Celsius), may be dR
+ * @param xCount number of readings
+ * @param eEval evaluation method
+ * @return 0, -1 on memory allocation failure (eNtcBankGroup only)
+ */
+int iNtcBankStreamResToTemp (const xNtcBank * xBank, const uint32_t uChannel[],
+                             const double dR[], double dT[], size_t xCount,
+                             eNtcBankEval eEval);
+
+/* ========================================================================== */
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NTC_BANK_H_ defined */
@@ -0,0 +1,463 @@
+/**
+ * @file ntc-catalog.c
+ * @brief NTC thermistor library (model catalog)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ntc-catalog.h"
+
+/* constants ================================================================ */
+/* Magic number of the header */
+#define MAGIC "NTCCATLG"
+/* Alignment of the sections */
+#define ALIGN 8
+
+/* structures =============================================================== */
+/* Header of the file, 64 bytes */
+typedef struct xHeader {
+  char sMagic[8];
+  uint32_t uVersion;
+  uint32_t uModels;
+  uint32_t uBuckets;
+  uint32_t uModelSize;
+  uint64_t uIndex;
+  uint64_t uModel;
+  uint64_t uParts;
+  uint64_t uSize;
+  uint64_t uReserved;
+} xHeader;
+
+struct xNtcCatalog {
+  const char * pMap;
+  size_t xSize;
+  const xHeader * xHead;
+  const uint32_t * uIndex;
+  const xNtcCatalogModel * xModel;
+};
+
+/* private variables ======================================================== */
+/* Number of the next temporary file of the process */
+static unsigned uTemp;
+
+/* private functions ======================================================== */
+/*
+ * FNV-1a hash of a part number.
+ */
+static uint32_t
+hash (const char * s) {
+  uint32_t h = 2166136261u;
+
+  while (*s) {
+
+    h = (h ^ (uint8_t) *s++) * 16777619u;
+  }
+  return h;
+}
+
+/*
+ * Rounds up to the alignment of the sections.
+ */
+static inline uint64_t
+align (uint64_t x) {
+
+  return (x + ALIGN - 1) & ~ (uint64_t) (ALIGN - 1);
+}
+
+/*
+ * Number of buckets of the index: a power of 2, at least twice the number
+ * of models.
+ */
+static uint32_t
+buckets (unsigned n) {
+  uint32_t b = 1;
+
+  while (b < 2 * (uint64_t) n) {
+
+    b <<= 1;
+  }
+  return b;
+}
+
+/*
+ * Bucket of a part number, the empty bucket where it would be inserted if
+ * it is not in the index.
+ */
+static uint32_t
+bucket (const char * pMap, const uint32_t * uIndex, uint32_t uBuckets,
+        const xNtcCatalogModel * xModel, const char * sPart) {
+  uint32_t b, mask = uBuckets - 1;
+
+  for (b = hash (sPart) & mask; uIndex[b]; b = (b + 1) & mask) {
+
+    if (strcmp (pMap + xModel[uIndex[b] - 1].uPart, sPart) == 0) {
+      break;
+    }
+  }
+  return b;
+}
+
+/*
+ * Checks a catalog mapped in memory.
+ */
+static int
+check (const xNtcCatalog * c) {
+  const xHeader * h = c->xHead;
+  const xNtcCatalogModel * m;
+  uint64_t size = c->xSize;
+  uint32_t i, n = 0;
+
+  if ( (size < sizeof (xHeader)) ||
+       (memcmp (h->sMagic, MAGIC, sizeof (h->sMagic)) != 0) ||
+       (h->uVersion != NTC_CATALOG_VERSION) ||
+       (h->uModelSize != sizeof (xNtcCatalogModel)) || (h->uSize != size) ||
+       (h->uBuckets == 0) || (h->uBuckets & (h->uBuckets - 1)) ||
+       (h->uBuckets <= h->uModels) ||
+       (h->uIndex % ALIGN) || (h->uModel % ALIGN) ||
+       (h->uIndex > size) || (h->uBuckets > (size - h->uIndex) / 4) ||
+       (h->uModel > size) ||
+       (h->uModels > (size - h->uModel) / sizeof (xNtcCatalogModel)) ||
+       (h->uParts > size)) {
+
+    return -1;
+  }
+  /* an empty bucket at least, so that the probing ends */
+  for (i = 0; i < h->uBuckets; i++) {
+
+    if (c->uIndex[i] > h->uModels) {
+      return -1;
+    }
+    n += (c->uIndex[i] != 0);
+  }
+  if (n > h->uModels) {
+    return -1;
+  }
+  for (i = 0; i < h->uModels; i++) {
+
+    m = &c->xModel[i];
+    if ( (m->uPart < h->uParts) || (m->uPart >= size) ||
+         (memchr (c->pMap + m->uPart, 0, size - m->uPart) == NULL) ||
+         (m->uLutBits > 16) ||
+         (m->uLutBits && ( (m->uLut % ALIGN) || (m->uLut > size) ||
+                           ( (size - m->uLut) >> m->uLutBits) < 2))) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/* internal public functions ================================================ */
+// -----------------------------------------------------------------------------
+int
+iNtcCatalogWrite (const char * sPath, const xNtcCatalogEntry xEntry[],
+                  unsigned uCount) {
+  const xNtcCatalogEntry * e;
+  xNtcCatalogModel * model;
+  xNtcLut * lut = NULL;
+  uint32_t * index, b, n;
+  uint64_t size, parts, luts;
+  xHeader * h;
+  char * buf, * tmp = NULL;
+  unsigned i, c;
+  int fd = -1, err = 0;
+  size_t len;
+  FILE * f;
+
+  /* layout */
+  n = buckets (uCount);
+  parts = align (sizeof (xHeader) + n * sizeof (uint32_t)) +
+          uCount * sizeof (xNtcCatalogModel);
+  luts = parts;
+  for (i = 0; i < uCount; i++) {
+
+    if ( (xEntry[i].sPart == NULL) || (*xEntry[i].sPart == 0)) {
+
+      errno = EINVAL;
+      return -1;
+    }
+    luts += strlen (xEntry[i].sPart) + 1;
+  }
+  size = luts = align (luts);
+  for (i = 0; i < uCount; i++) {
+
+    if (xEntry[i].xLut) {
+
+      if ( (xEntry[i].xLut->iBits < 1) || (xEntry[i].xLut->iBits > 16)) {
+
+        errno = EINVAL;
+        return -1;
+      }
+      size += align ( (sizeof (int16_t) << xEntry[i].xLut->iBits));
+    }
+  }
+  buf = calloc (1, size);
+  if (buf == NULL) {
+
+    return -1;
+  }
+
+  h = (xHeader *) buf;
+  memcpy (h->sMagic, MAGIC, sizeof (h->sMagic));
+  h->uVersion = NTC_CATALOG_VERSION;
+  h->uModels = uCount;
+  h->uBuckets = n;
+  h->uModelSize = sizeof (xNtcCatalogModel);
+  h->uIndex = sizeof (xHeader);
+  h->uModel = align (sizeof (xHeader) + n * sizeof (uint32_t));
+  h->uParts = parts;
+  h->uSize = size;
+  index = (uint32_t *) (buf + h->uIndex);
+  model = (xNtcCatalogModel *) (buf + h->uModel);
+
+  for (i = 0; i < uCount; i++) {
+
+    e = &xEntry[i];
+    len = strlen (e->sPart) + 1;
+    memcpy (buf + parts, e->sPart, len);
+    memcpy (model[i].dCoeff, e->dCoeff, sizeof (model[i].dCoeff));
+    model[i].dTmin = e->dTmin;
+    model[i].dTmax = e->dTmax;
+    model[i].dMaxError = e->dMaxError;
+    model[i].dRmsError = e->dRmsError;
+    model[i].uPart = parts;
+    model[i].uForm = e->eForm;
+    parts += len;
+
+    b = bucket (buf, index, n, model, e->sPart);
+    if (index[b]) {
+
+      err = EEXIST;
+      goto error;
+    }
+    index[b] = i + 1;
+
+    if (e->xLut) {
+
+      lut = xNtcLutNew (e->xLut, e->dCoeff, 1);
+      if (lut == NULL) {
+
+        err = EINVAL;
+        goto error;
+      }
+      for (c = 0; c < uNtcLutSize (lut); c++) {
+
+        ( (int16_t *) (buf + luts)) [c] = iNtcLutCodeToTempFixed (lut, c);
+      }
+      vNtcLutDelete (lut);
+      model[i].dSeries = e->xLut->dSeries;
+      model[i].dVref = e->xLut->dVref;
+      model[i].dVsupply = e->xLut->dVsupply;
+      model[i].uLut = luts;
+      model[i].uLutBits = e->xLut->iBits;
+      model[i].uDivider = e->xLut->eDivider;
+      luts += align (sizeof (int16_t) << e->xLut->iBits);
+    }
+  }
+
+  /*
+   * temporary file in the directory of the catalog, then renamed, created
+   * with the mode 0666 restricted by the umask as any new file
+   */
+  tmp = malloc (strlen (sPath) + 32);
+  if (tmp == NULL) {
+
+    err = errno;
+    goto error;
+  }
+  do {
+
+    sprintf (tmp, "%s.%ld.%u", sPath, (long) getpid (),
+             __atomic_fetch_add (&uTemp, 1, __ATOMIC_RELAXED));
+    fd = open (tmp, O_WRONLY | O_CREAT | O_EXCL, 0666);
+  } while ( (fd < 0) && (errno == EEXIST));
+  f = (fd < 0) ? NULL : fdopen (fd, "w");
+  if (f == NULL) {
+
+    err = errno;
+    if (fd >= 0) {
+
+      close (fd);
+      unlink (tmp);
+    }
+    goto error;
+  }
+  if (fwrite (buf, size, 1, f) != 1) {
+
+    err = errno;
+  }
+  if ( (fclose (f) != 0) && (err == 0)) {
+
+    err = errno;
+  }
+  if (err) {
+
+    unlink (tmp);
+    goto error;
+  }
+  if (rename (tmp, sPath) != 0) {
+
+    err = errno;
+    unlink (tmp);
+  }
+
+error:
+  free (tmp);
+  free (buf);
+  if (err) {
+
+    errno = err;
+    return -1;
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+xNtcCatalog *
+xNtcCatalogOpen (const char * sPath) {
+  xNtcCatalog * c;
+  struct stat st;
+  void * map;
+  int fd, err;
+
+  fd = open (sPath, O_RDONLY);
+  if (fd < 0) {
+
+    return NULL;
+  }
+  if (fstat (fd, &st) != 0) {
+
+    err = errno;
+    close (fd);
+    errno = err;
+    return NULL;
+  }
+  if (!S_ISREG (st.st_mode) || (st.st_size < (off_t) sizeof (xHeader))) {
+
+    close (fd);
+    errno = EINVAL;
+    return NULL;
+  }
+  map = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  err = errno;
+  close (fd);
+  if (map == MAP_FAILED) {
+
+    errno = err;
+    return NULL;
+  }
+  c = malloc (sizeof (xNtcCatalog));
+  if (c == NULL) {
+
+    munmap (map, st.st_size);
+    return NULL;
+  }
+  c->pMap = map;
+  c->xSize = st.st_size;
+  c->xHead = map;
+  c->uIndex = (const uint32_t *) (c->pMap + c->xHead->uIndex);
+  c->xModel = (const xNtcCatalogModel *) (c->pMap + c->xHead->uModel);
+  if (check (c) != 0) {
+
+    vNtcCatalogClose (c);
+    errno = EINVAL;
+    return NULL;
+  }
+  return c;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcCatalogClose (xNtcCatalog * xCatalog) {
+
+  if (xCatalog) {
+
+    munmap ( (void *) xCatalog->pMap, xCatalog->xSize);
+    free (xCatalog);
+  }
+}
+
+// -----------------------------------------------------------------------------
+unsigned
+uNtcCatalogModels (const xNtcCatalog * xCatalog) {
+
+  return xCatalog->xHead->uModels;
+}
+
+// -----------------------------------------------------------------------------
+const xNtcCatalogModel *
+xNtcCatalogModelAt (const xNtcCatalog * xCatalog, unsigned uIndex) {
+
+  if (uIndex >= xCatalog->xHead->uModels) {
+
+    return NULL;
+  }
+  return &xCatalog->xModel[uIndex];
+}
+
+// -----------------------------------------------------------------------------
+const xNtcCatalogModel *
+xNtcCatalogFind (const xNtcCatalog * xCatalog, const char * sPart) {
+  uint32_t b;
+
+  b = bucket (xCatalog->pMap, xCatalog->uIndex, xCatalog->xHead->uBuckets,
+              xCatalog->xModel, sPart);
+  if (xCatalog->uIndex[b] == 0) {
+
+    return NULL;
+  }
+  return &xCatalog->xModel[xCatalog->uIndex[b] - 1];
+}
+
+// -----------------------------------------------------------------------------
+const char *
+sNtcCatalogPart (const xNtcCatalog * xCatalog,
+                 const xNtcCatalogModel * xModel) {
+
+  return xCatalog->pMap + xModel->uPart;
+}
+
+// -----------------------------------------------------------------------------
+unsigned
+uNtcCatalogLut (const xNtcCatalog * xCatalog, const xNtcCatalogModel * xModel,
+                xNtcAdcConfig * xConfig, const int16_t ** iTable) {
+
+  if (xModel->uLutBits == 0) {
+
+    return 0;
+  }
+  if (xConfig) {
+
+    xConfig->dSeries = xModel->dSeries;
+    xConfig->dVref = xModel->dVref;
+    xConfig->dVsupply = xModel->dVsupply;
+    xConfig->iBits = xModel->uLutBits;
+    xConfig->eDivider = (eNtcDivider) xModel->uDivider;
+  }
+  *iTable = (const int16_t *) (xCatalog->pMap + xModel->uLut);
+  return 1U << xModel->uLutBits;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file ntc-catalog.h
+ * @brief NTC thermistor library (model catalog)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ *
+ * A catalog is a file holding the models of many thermistors, found by their
+ * part number. It is mapped read-only in memory, so that opening it costs
+ * an mmap and finding a model a hash lookup, and its pages are shared by
+ * all the processes using it. All the values are in the byte order of the
+ * host, the offsets are from the beginning of the file:
+ * - header (64 bytes): magic "NTCCATLG", version, number of models, number
+ *   of buckets of the index (a power of 2), size of a model, offsets of the
+ *   index, of the models and of the part numbers, size of the file,
+ * - index: one uint32_t per bucket, 0 for an empty bucket or the number of a
+ *   model plus 1, open addressing with linear probing on the FNV-1a hash of
+ *   the part number,
+ * - models: array of xNtcCatalogModel,
+ * - part numbers: null terminated strings,
+ * - lookup tables: int16_t per ADC code in 1/NTC_LUT_FIXED_SCALE degree
+ *   Celsius (see ntc-lut.h), aligned on 8 bytes.
+ * .
+ */
+#ifndef _NTC_CATALOG_H_
+#define _NTC_CATALOG_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ========================================================================== */
+#include <stdint.h>
+#include "ntc.h"
+#include "ntc-lut.h"
+
+/* constants ================================================================ */
+/** Version of the catalog format */
+#define NTC_CATALOG_VERSION 1
+
+/* structures =============================================================== */
+/**
+ * Model of a catalog, as stored in the file
+ */
+typedef struct xNtcCatalogModel {
+  double dCoeff[4];   /**< Steinhart-Hart coefficients */
+  double dTmin;       /**< minimal temperature of validity (in degree Celsius) */
+  double dTmax;       /**< maximal temperature of validity (in degree Celsius) */
+  double dMaxError;   /**< maximal error of the fit (in degree Celsius) */
+  double dRmsError;   /**< root mean square error of the fit */
+  double dSeries;     /**< series resistor of the lookup table (in Ohm) */
+  double dVref;       /**< ADC reference voltage of the lookup table */
+  double dVsupply;    /**< divider supply voltage of the lookup table */
+  uint64_t uLut;      /**< offset of the lookup table, 0 if none */
+  uint32_t uPart;     /**< offset of the part number */
+  uint32_t uForm;     /**< form of the coefficients (eNtcForm) */
+  uint32_t uLutBits;  /**< ADC resolution of the lookup table, 0 if none */
+  uint32_t uDivider;  /**< divider of the lookup table (eNtcDivider) */
+} xNtcCatalogModel;
+
+/**
+ * Model to write in a catalog
+ */
+typedef struct xNtcCatalogEntry {
+  const char * sPart;     /**< part number, unique in the catalog */
+  double dCoeff[4];       /**< Steinhart-Hart coefficients */
+  eNtcForm eForm;         /**< form of the coefficients */
+  double dTmin;           /**< minimal temperature of validity */
+  double dTmax;           /**< maximal temperature of validity */
+  double dMaxError;       /**< maximal error of the fit */
+  double dRmsError;       /**< root mean square error of the fit */
+  const xNtcAdcConfig * xLut; /**< configuration of the fixed point lookup
+                                   table to store, NULL for none */
+} xNtcCatalogEntry;
+
+/**
+ * Part of a header generated by ntc-catalog -c
+ * The generated header (src/ntc-parts.h for the tables of ntc-data) defines
+ * const precomputed models and the array xNtcParts[] of NTC_PARTS parts,
+ * and the lookup tables if NTC_PARTS_LUT is defined before including it.
+ */
+typedef struct xNtcPart {
+  const char * sPart;         /**< part number */
+  const xNtcModel * xModel;   /**< model, initialized */
+  double dTmin;               /**< minimal temperature of validity */
+  double dTmax;               /**< maximal temperature of validity */
+  double dMaxError;           /**< maximal error of the fit */
+  xNtcAdcConfig xLut;         /**< configuration of iLut */
+  const int16_t * iLut;       /**< fixed point lookup table (see
+                                   uNtcCatalogLut()), NULL if none */
+} xNtcPart;
+
+/**
+ * Catalog mapped in memory (opaque)
+ */
+typedef struct xNtcCatalog xNtcCatalog;
+
+/* internal public functions ================================================ */
+/**
+ * Write a catalog
+ * The catalog is written to a temporary file renamed to sPath, so that
+ * the processes that mapped the previous catalog keep a consistent one.
+ * Its mode is 0666 restricted by the umask of the process.
+ * The lookup tables are built with xNtcLutNew().
+ * @param sPath path of the catalog
+ * @param xEntry models
+ * @param uCount number of models
+ * @return 0, -1 on error with errno set: EEXIST for a part number given
+ *         twice, EINVAL for an empty part number or a lookup table that can
+ *         not be built, or the error of the file access
+ */
+int iNtcCatalogWrite (const char * sPath, const xNtcCatalogEntry xEntry[],
+                      unsigned uCount);
+
+/**
+ * Open a catalog
+ * The file is mapped read-only and its header, index and models are
+ * checked, the lookup tables are only read when they are used.
+ * @param sPath path of the catalog
+ * @return the catalog, NULL on error with errno set (EINVAL for a file that
+ *         is not a valid catalog). Must be released with vNtcCatalogClose()
+ */
+xNtcCatalog * xNtcCatalogOpen (const char * sPath);
+
+/**
+ * Release a catalog opened by xNtcCatalogOpen()
+ * The models and part numbers of the catalog are no longer valid.
+ * @param xCatalog catalog to release, may be NULL
+ */
+void vNtcCatalogClose (xNtcCatalog * xCatalog);
+
+/**
+ * Number of models of a catalog
+ * @param xCatalog catalog
+ * @return number of models
+ */
+unsigned uNtcCatalogModels (const xNtcCatalog * xCatalog);
+
+/**
+ * Model of a catalog by number
+ * @param xCatalog catalog
+ * @param uIndex number of the model, from 0 to uNtcCatalogModels() - 1
+ * @return the model, NULL if uIndex is out of range
+ */
+const xNtcCatalogModel * xNtcCatalogModelAt (const xNtcCatalog * xCatalog,
+                                             unsigned uIndex);
+
+/**
+ * Model of a catalog by part number
+ * @param xCatalog catalog
+ * @param sPart part number
+ * @return the model, NULL if the part number is not in the catalog
+ */
+const xNtcCatalogModel * xNtcCatalogFind (const xNtcCatalog * xCatalog,
+                                          const char * sPart);
+
+/**
+ * Part number of a model of a catalog
+ * @param xCatalog catalog
+ * @param xModel model of the catalog
+ * @return the part number
+ */
+const char * sNtcCatalogPart (const xNtcCatalog * xCatalog,
+                              const xNtcCatalogModel * xModel);
+
+/**
+ * Lookup table of a model of a catalog
+ * The temperature of the ADC code c is iTable[c], in 1/NTC_LUT_FIXED_SCALE
+ * degree Celsius, NTC_LUT_INVALID for a code without valid resistance.
+ * @param xCatalog catalog
+ * @param xModel model of the catalog
+ * @param xConfig divider and ADC configuration of the table, may be NULL
+ * @param iTable table, in the catalog
+ * @return number of codes of the table, 0 if the model has no table
+ */
+unsigned uNtcCatalogLut (const xNtcCatalog * xCatalog,
+                         const xNtcCatalogModel * xModel,
+                         xNtcAdcConfig * xConfig, const int16_t ** iTable);
+
+/* ========================================================================== */
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NTC_CATALOG_H_ defined */
@@ -0,0 +1,1292 @@
+/**
+ * @file ntc-fit.c
+ * @brief NTC thermistor library (least squares fit)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include "ntc-fit.h"
+#include "ntc-stream.h"
+
+/* constants ================================================================ */
+/* Number of coefficients */
+#define M 4
+/* Absolute zero */
+#define TABS (-273.15)
+/* Smallest diagonal element of R relative to the first one */
+#define SINGULAR 1e-12
+/* Maximal number of exchanges of each pass of the minimax fit */
+#define MINIMAX_ITERATIONS 100
+/* Passes of the minimax fit, each one linearizes the temperature error
+   around the polynom of the previous one */
+#define MINIMAX_PASSES 3
+/* Relative gap between the maximal error and the levelled error to stop */
+#define MINIMAX_GAP 1e-6
+/* Maximal error of the minimax fit reached by rounding errors (Celsius) */
+#define MINIMAX_FLOOR 1e-9
+/* Reweighted passes of a robust fit */
+#define ROBUST_PASSES 4
+/* Thresholds of the robust fits, in robust standard deviations */
+#define ROBUST_HUBER 1.345
+#define ROBUST_TRIM 3.0
+/* Robust standard deviation of a normal law over its median deviation */
+#define ROBUST_MAD 1.4826
+/* Smallest robust standard deviation (Celsius), below table resolutions */
+#define ROBUST_FLOOR 1e-6
+/* Histogram of the absolute errors: bins per decade from 10^HIST_MIN */
+#define HIST_MIN (-9)
+#define HIST_STEPS 64
+#define HIST_BINS (12 * HIST_STEPS)
+/* Maximal number of threads of xNtcFitTables() */
+#define MAX_THREADS 256
+
+/* structures =============================================================== */
+/* Model of a slot as the words copied atomically */
+typedef union xWords {
+  xNtcModel xModel;
+  uint64_t uWord[NTC_FIT_SLOT_WORDS];
+} xWords;
+
+_Static_assert (sizeof (xWords) == sizeof (((xNtcFitSlot *) 0)->uModel),
+                "the model must fill the words of a slot");
+
+struct xNtcFit {
+  double dR[M][M + 1];  /* triangular factor R and rotated right side */
+  double dRss;          /* residual sum of squares */
+  double dShift;        /* origin of the abscissa, first ln R added */
+  double dLambda;       /* forgetting factor */
+  double dSqrtLambda;
+  double dWeight;       /* sum of the weights of the pairs */
+  long long llCount;    /* number of pairs */
+};
+
+/* Temperature errors of the coefficients of each form */
+typedef struct xTest {
+  double dCoeff[3][4];
+  int iValid[3];        /* the form has been solved */
+  double dSum[3];
+  double dMax[3];
+  double dAt[3];
+} xTest;
+
+/* Passes of a robust fit */
+typedef struct xRobust {
+  xNtcFit xFit;
+  xTest xTest;          /* errors of the forms over the pairs not removed */
+  xTest xDown;          /* errors of the forms over the pairs downweighted */
+  const xNtcFitOptions * xOptions;
+  double dCoeff[4];     /* coefficients whose errors weight the pass */
+  double dThreshold;    /* error beyond which the pairs are downweighted */
+  long long llIndex;    /* index of the pair read */
+  long long llKept;     /* pairs of non zero weight */
+  long long llDownweighted;
+  long long llHist[HIST_BINS]; /* absolute errors of dCoeff */
+} xRobust;
+
+/* Pair of the minimax fit, sorted by abscissa */
+typedef struct xPoint {
+  double dX;            /* ln R - shift */
+  double dY;            /* 1/T */
+  double dT;            /* absolute temperature */
+  double dS;            /* scale of the residual of 1/T to the temperature */
+} xPoint;
+
+/* Pairs of a table kept in memory */
+typedef struct xPairs {
+  double * dTemp;
+  double * dRes;
+  size_t xCount;
+  size_t xSize;
+} xPairs;
+
+/* Files fitted by xNtcFitTables() */
+typedef struct xBatch {
+  const char * const * sPath;
+  xNtcFitResult * xResult;
+  size_t xCount;
+  const xNtcFitOptions * xOptions;
+  size_t xNext;         /* next file to fit, shared by the threads */
+  size_t xFailed;
+} xBatch;
+
+/* private variables ======================================================== */
+/* Binomial coefficients C(k,j), dBinom[j][k] */
+static const double dBinom[M][M] = {
+  { 1, 1, 1, 1 }, { 0, 1, 2, 3 }, { 0, 0, 1, 3 }, { 0, 0, 0, 1 }
+};
+
+/* private functions ======================================================== */
+/*
+ * Adds a point (x = ln R, y = 1/T) with a weight w.
+ * The row sqrt(w).(1, u, u^2, u^3 | y) with u = x - shift is rotated into R by
+ * Givens rotations, as accurate as a Householder QR of the whole
+ * Vandermonde matrix. The shift by the first x keeps the powers of u small.
+ */
+static void
+add (xNtcFit * f, double x, double y, double w) {
+  double row[M + 1];
+  double c, s, h, t;
+  int i, j;
+
+  if (f->llCount++ == 0) {
+
+    f->dShift = x;
+  }
+  if (f->dLambda < 1.0) {
+
+    /* exponential weighting: the previous rows are scaled by sqrt(lambda) */
+    for (i = 0; i < M; i++) {
+
+      for (j = i; j <= M; j++) {
+
+        f->dR[i][j] *= f->dSqrtLambda;
+      }
+    }
+    f->dRss *= f->dLambda;
+    f->dWeight *= f->dLambda;
+  }
+  f->dWeight += w;
+  x -= f->dShift;
+  row[0] = (w == 1.0) ? 1.0 : sqrt (w);
+  for (i = 1; i < M; i++) {
+
+    row[i] = row[i - 1] * x;
+  }
+  row[M] = row[0] * y;
+  for (i = 0; i < M; i++) {
+
+    if (row[i] == 0.0) {
+      continue;
+    }
+    h = sqrt (f->dR[i][i] * f->dR[i][i] + row[i] * row[i]);
+    c = f->dR[i][i] / h;
+    s = row[i] / h;
+    f->dR[i][i] = h;
+    for (j = i + 1; j <= M; j++) {
+
+      t = f->dR[i][j];
+      f->dR[i][j] = c * t + s * row[j];
+      row[j] = c * row[j] - s * t;
+    }
+  }
+  f->dRss += row[M] * row[M];
+}
+
+// -----------------------------------------------------------------------------
+static void
+init (xNtcFit * f, double dLambda) {
+
+  memset (f, 0, sizeof (xNtcFit));
+  f->dLambda = dLambda;
+  f->dSqrtLambda = sqrt (dLambda);
+}
+
+// -----------------------------------------------------------------------------
+static inline double
+poly3 (double x, const double a[4]) {
+
+  return ( (a[3] * x + a[2]) * x + a[1]) * x + a[0];
+}
+
+// -----------------------------------------------------------------------------
+static inline int
+valid (double dTemp, double dRes) {
+
+  return (dRes > 0) && (dTemp > TABS) && !isinf (dRes) && !isinf (dTemp);
+}
+
+// -----------------------------------------------------------------------------
+static inline int
+blank (char c) {
+
+  return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+/*
+ * Reads the number of the next column of a table line [*p, eol).
+ * Leading blanks are skipped, as well as the separator following the number.
+ * Returns 0, -1 if the column is missing or is not a number.
+ */
+static int
+column (const char ** p, const char * eol, double * v) {
+  const char * s = *p, * e;
+
+  while ( (s < eol) && blank (*s)) {
+    s++;
+  }
+  for (e = s; (e < eol) && !blank (*e) && (*e != ',') && (*e != ';'); e++) {
+  }
+  if ( (e == s) || (iNtcStreamParseNumber (s, e, v) != 0)) {
+
+    return -1;
+  }
+  while ( (e < eol) && blank (*e)) {
+    e++;
+  }
+  if ( (e < eol) && ( (*e == ',') || (*e == ';'))) {
+    e++;
+  }
+  *p = e;
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+static int
+point (void * pvUser, double dTemp, double dRes) {
+
+  return iNtcFitAdd ( (xNtcFit *) pvUser, dTemp, dRes);
+}
+
+// -----------------------------------------------------------------------------
+static int
+test (void * pvUser, double dTemp, double dRes) {
+  xTest * t = pvUser;
+  double e;
+  int i;
+
+  for (i = 0; i < 3; i++) {
+
+    if (t->iValid[i]) {
+
+      e = fabs (dNtcResToTemp (dRes, t->dCoeff[i]) - dTemp);
+      t->dSum[i] += e * e;
+      if (e > t->dMax[i]) {
+
+        t->dMax[i] = e;
+        t->dAt[i] = dTemp;
+      }
+    }
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+static int
+abscissa (const void * a, const void * b) {
+  double x = ( (const xPoint *) a)->dX;
+  double y = ( (const xPoint *) b)->dX;
+
+  return (x > y) - (x < y);
+}
+
+/*
+ * Levelled error of a reference of the minimax fit, the n + 1 equations
+ * s_k (y_k - p(x_k)) = (-1)^k h of the n coefficients of the columns col of
+ * p and h, solved by Gaussian elimination with partial pivoting.
+ */
+static int
+level (const xPoint * p, const size_t * ref, const int * col, int n,
+       double b[M], double * h) {
+  double a[M + 1][M + 2], v[M + 1], pw[M], t;
+  int i, j, k, m;
+
+  for (k = 0; k <= n; k++) {
+
+    const xPoint * q = &p[ref[k]];
+
+    pw[0] = 1.0;
+    for (j = 1; j < M; j++) {
+
+      pw[j] = pw[j - 1] * q->dX;
+    }
+    for (j = 0; j < n; j++) {
+
+      a[k][j] = q->dS * pw[col[j]];
+    }
+    a[k][n] = (k & 1) ? -1.0 : 1.0;
+    a[k][n + 1] = q->dS * q->dY;
+  }
+  for (i = 0; i <= n; i++) {
+
+    for (m = i, k = i + 1; k <= n; k++) {
+
+      m = (fabs (a[k][i]) > fabs (a[m][i])) ? k : m;
+    }
+    for (j = i; j <= n + 1; j++) {
+
+      t = a[i][j];
+      a[i][j] = a[m][j];
+      a[m][j] = t;
+    }
+    if (! (fabs (a[i][i]) > SINGULAR * fabs (a[0][0]))) {
+
+      return -1;
+    }
+    for (k = i + 1; k <= n; k++) {
+
+      t = a[k][i] / a[i][i];
+      for (j = i; j <= n + 1; j++) {
+
+        a[k][j] -= t * a[i][j];
+      }
+    }
+  }
+  for (i = n; i >= 0; i--) {
+
+    v[i] = a[i][n + 1];
+    for (j = i + 1; j <= n; j++) {
+
+      v[i] -= a[i][j] * v[j];
+    }
+    v[i] /= a[i][i];
+  }
+  memset (b, 0, M * sizeof (double));
+  for (j = 0; j < n; j++) {
+
+    b[col[j]] = v[j];
+  }
+  *h = v[n];
+  return 0;
+}
+
+/*
+ * Single point exchange: the point k whose residual has the sign sk
+ * replaces the neighbour of the reference with the same sign, or enters at
+ * one end and the other end leaves, keeping the alternation of the signs.
+ * The sign of the residual at ref[j] is sh.(-1)^j.
+ */
+static void
+exchange (size_t * ref, int n, size_t k, int sk, int sh) {
+  int j;
+
+  for (j = 0; (j <= n) && (ref[j] < k); j++)
+    ;
+  if (j == 0) {
+
+    if (sk != sh) {
+
+      memmove (&ref[1], &ref[0], n * sizeof (size_t));
+    }
+    ref[0] = k;
+  }
+  else if (j > n) {
+
+    if (sk != ( (n & 1) ? -sh : sh)) {
+
+      memmove (&ref[0], &ref[1], n * sizeof (size_t));
+    }
+    ref[n] = k;
+  }
+  else {
+
+    ref[ (sk == ( ( (j - 1) & 1) ? -sh : sh)) ? j - 1 : j] = k;
+  }
+}
+
+// -----------------------------------------------------------------------------
+static int
+collect (void * pvUser, double dTemp, double dRes) {
+  xPairs * p = pvUser;
+  double * t, * r;
+
+  if (p->xCount == p->xSize) {
+
+    p->xSize = p->xSize ? 2 * p->xSize : 1024;
+    t = realloc (p->dTemp, p->xSize * sizeof (double));
+    if (t == NULL) {
+      return -1;
+    }
+    p->dTemp = t;
+    r = realloc (p->dRes, p->xSize * sizeof (double));
+    if (r == NULL) {
+      return -1;
+    }
+    p->dRes = r;
+  }
+  p->dTemp[p->xCount] = dTemp;
+  p->dRes[p->xCount++] = dRes;
+  return 0;
+}
+
+/*
+ * Errors of coefficients over pairs in memory, stored in a result.
+ */
+static void
+measure (const xPairs * p, const double a[4], xNtcFitResult * r) {
+  double e, y, sum = 0.0, sumy = 0.0;
+  size_t i;
+
+  r->dMaxError = 0.0;
+  for (i = 0; i < p->xCount; i++) {
+
+    e = fabs (dNtcResToTemp (p->dRes[i], (double *) a) - p->dTemp[i]);
+    sum += e * e;
+    if (e > r->dMaxError) {
+
+      r->dMaxError = e;
+      r->dMaxErrorTemp = p->dTemp[i];
+    }
+    y = poly3 (log (p->dRes[i]), a) - 1.0 / (p->dTemp[i] - TABS);
+    sumy += y * y;
+  }
+  r->dRmsError = sqrt (sum / p->xCount);
+  r->xStats.llCount = p->xCount;
+  r->xStats.dRms = sqrt (sumy / p->xCount);
+}
+
+/*
+ * Minimax fit of a table: the form whose minimax error is below the
+ * maximal error of the options, from the simplified one.
+ */
+static int
+minimax (const char * sPath, double dMaxError, xNtcFitResult * xResult) {
+  xPairs p = { NULL, NULL, 0, 0 };
+  double a[4], err;
+  int form, ret = -1;
+
+  if (llNtcFitReadTable (sPath, collect, &p, &xResult->xLine) < 0) {
+
+    if (errno == ECANCELED) {
+
+      xResult->iError = ENOMEM;
+      xResult->xLine = 0;
+    }
+    else {
+
+      xResult->iError = errno;
+    }
+    goto end;
+  }
+  for (form = (dMaxError > 0.0) ? 0 : eNtcFormExtended; form < 3; form++) {
+
+    if ( (iNtcFitMinimax (p.dTemp, p.dRes, p.xCount, form, a, &err) == 0) &&
+         ( (err <= dMaxError) || (form == eNtcFormExtended))) {
+
+      xResult->eForm = form;
+      memcpy (xResult->dCoeff, a, sizeof (a));
+      measure (&p, a, xResult);
+      ret = 0;
+      goto end;
+    }
+  }
+  xResult->iError = EDOM;
+end:
+  free (p.dTemp);
+  free (p.dRes);
+  return ret;
+}
+
+/*
+ * Coefficients of the smallest form within dMaxError, the extended one
+ * otherwise, and their errors over llKept pairs.
+ */
+static void
+choose (const xTest * t, const xNtcFitStats stats[3], long long llKept,
+        double dMaxError, xNtcFitResult * xResult) {
+  int form;
+
+  for (form = 0; form < eNtcFormExtended; form++) {
+
+    if (t->iValid[form] && (t->dMax[form] <= dMaxError)) {
+      break;
+    }
+  }
+  xResult->eForm = form;
+  memcpy (xResult->dCoeff, t->dCoeff[form], sizeof (xResult->dCoeff));
+  xResult->xStats = stats[form];
+  xResult->dRmsError = llKept ? sqrt (t->dSum[form] / llKept) : 0.0;
+  xResult->dMaxError = t->dMax[form];
+  xResult->dMaxErrorTemp = t->dAt[form];
+}
+
+// -----------------------------------------------------------------------------
+static double
+weight (const xRobust * r, double e) {
+
+  e = fabs (e);
+  if (e <= r->dThreshold) {
+
+    return 1.0;
+  }
+  return (r->xOptions->eMethod == eNtcFitHuber) ? r->dThreshold / e : 0.0;
+}
+
+// -----------------------------------------------------------------------------
+static void
+histogram (xRobust * r, double e) {
+  double b;
+
+  b = (e != 0.0) ? (log10 (fabs (e)) - HIST_MIN) * HIST_STEPS : 0.0;
+  b = (b < 0.0) ? 0.0 : b;
+  r->llHist[ (b < HIST_BINS - 1) ? (int) b : HIST_BINS - 1]++;
+}
+
+/*
+ * Threshold of the next pass: ROBUST_MAD times the median of the absolute
+ * errors of the histogram (at the center of its bin) is the robust
+ * standard deviation, the histogram is cleared.
+ */
+static void
+threshold (xRobust * r) {
+  long long n = 0, half;
+  double sd;
+  int i;
+
+  for (i = 0; i < HIST_BINS; i++) {
+
+    n += r->llHist[i];
+  }
+  half = (n + 1) / 2;
+  for (n = 0, i = 0; (i < HIST_BINS - 1) && (n + r->llHist[i] < half); i++) {
+
+    n += r->llHist[i];
+  }
+  sd = ROBUST_MAD * pow (10.0, (i + 0.5) / HIST_STEPS + HIST_MIN);
+  sd = (sd < ROBUST_FLOOR) ? ROBUST_FLOOR : sd;
+  if (r->xOptions->dThreshold > 0.0) {
+
+    r->dThreshold = r->xOptions->dThreshold;
+  }
+  else {
+
+    r->dThreshold = sd * ( (r->xOptions->eMethod == eNtcFitHuber) ?
+                           ROBUST_HUBER : ROBUST_TRIM);
+  }
+  memset (r->llHist, 0, sizeof (r->llHist));
+}
+
+// -----------------------------------------------------------------------------
+static int
+scale (void * pvUser, double dTemp, double dRes) {
+  xRobust * r = pvUser;
+
+  histogram (r, dNtcResToTemp (dRes, r->dCoeff) - dTemp);
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+static int
+reweight (void * pvUser, double dTemp, double dRes) {
+  xRobust * r = pvUser;
+  double x = log (dRes), e;
+
+  e = 1.0 / poly3 (x, r->dCoeff) + TABS - dTemp;
+  histogram (r, e);
+  add (&r->xFit, x, 1.0 / (dTemp - TABS), weight (r, e));
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+static int
+report (void * pvUser, double dTemp, double dRes) {
+  xRobust * r = pvUser;
+  double e, w;
+
+  e = dNtcResToTemp (dRes, r->dCoeff) - dTemp;
+  w = weight (r, e);
+  if (w < 1.0) {
+
+    r->llDownweighted++;
+    test (&r->xDown, dTemp, dRes);
+    if (r->xOptions->vOutlier) {
+
+      r->xOptions->vOutlier (r->xOptions->pvUser, r->llIndex, dTemp, dRes,
+                             e, w);
+    }
+  }
+  if (w > 0.0) {
+
+    r->llKept++;
+    test (&r->xTest, dTemp, dRes);
+  }
+  r->llIndex++;
+  return 0;
+}
+
+/*
+ * Robust fit of a table, streaming passes (see iNtcFitTable()).
+ */
+static int
+robust (const char * sPath, const xNtcFitOptions * xOptions,
+        xNtcFitResult * xResult) {
+  int i, pass, err = EDOM, passes = (xOptions->iPasses > 0) ?
+                                      xOptions->iPasses : ROBUST_PASSES;
+  xNtcFitStats stats[3];
+  xRobust * r;
+
+  r = calloc (1, sizeof (xRobust));
+  if (r == NULL) {
+
+    xResult->iError = ENOMEM;
+    return -1;
+  }
+  r->xOptions = xOptions;
+  init (&r->xFit, 1.0);
+  if (llNtcFitAddTable (&r->xFit, sPath, &xResult->xLine) < 0) {
+
+    goto read;
+  }
+  if (iNtcFitSolve (&r->xFit, r->dCoeff, NULL) != 0) {
+
+    goto error;
+  }
+  if (llNtcFitReadTable (sPath, scale, r, &xResult->xLine) < 0) {
+
+    goto read;
+  }
+  for (pass = 0; pass < passes; pass++) {
+
+    threshold (r);
+    init (&r->xFit, 1.0);
+    if (llNtcFitReadTable (sPath, reweight, r, &xResult->xLine) < 0) {
+
+      goto read;
+    }
+    /* the coefficients weighting the last pass weight the report */
+    if ( (pass < passes - 1) &&
+         (iNtcFitSolve (&r->xFit, r->dCoeff, NULL) != 0)) {
+
+      goto error;
+    }
+  }
+  for (i = (xOptions->dMaxError > 0.0) ? 0 : eNtcFormExtended; i < 3; i++) {
+
+    r->xTest.iValid[i] = (iNtcFitSolveForm (&r->xFit, i, r->xTest.dCoeff[i],
+                                             &stats[i]) == 0);
+  }
+  if (!r->xTest.iValid[eNtcFormExtended]) {
+
+    goto error;
+  }
+  memcpy (r->xDown.dCoeff, r->xTest.dCoeff, sizeof (r->xDown.dCoeff));
+  memcpy (r->xDown.iValid, r->xTest.iValid, sizeof (r->xDown.iValid));
+  if (llNtcFitReadTable (sPath, report, r, &xResult->xLine) < 0) {
+
+    goto read;
+  }
+  choose (&r->xTest, stats, r->llKept, xOptions->dMaxError, xResult);
+  xResult->llDownweighted = r->llDownweighted;
+  xResult->dDownweightedError = r->xDown.dMax[xResult->eForm];
+  free (r);
+  return 0;
+
+read:
+  err = errno;
+error:
+  xResult->iError = err;
+  free (r);
+  return -1;
+}
+
+/*
+ * Fits the next files of a batch until there are no more.
+ */
+static void *
+work (void * arg) {
+  xBatch * b = arg;
+  size_t i;
+
+  while ( (i = __atomic_fetch_add (&b->xNext, 1, __ATOMIC_RELAXED)) <
+          b->xCount) {
+
+    if (iNtcFitTable (b->sPath[i], b->xOptions, &b->xResult[i]) != 0) {
+
+      __atomic_fetch_add (&b->xFailed, 1, __ATOMIC_RELAXED);
+    }
+  }
+  return NULL;
+}
+
+/* internal public functions ================================================ */
+
+// -----------------------------------------------------------------------------
+xNtcFit *
+xNtcFitNew (void) {
+
+  xNtcFit * f = malloc (sizeof (xNtcFit));
+
+  if (f) {
+
+    init (f, 1.0);
+  }
+  return f;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcFitDelete (xNtcFit * xFit) {
+
+  free (xFit);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcFitClear (xNtcFit * xFit) {
+
+  init (xFit, xFit->dLambda);
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcFitSetForgetting (xNtcFit * xFit, double dLambda) {
+
+  if (! ( (dLambda > 0.0) && (dLambda <= 1.0))) {
+
+    return -1;
+  }
+  xFit->dLambda = dLambda;
+  xFit->dSqrtLambda = sqrt (dLambda);
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcFitPublish (xNtcFitSlot * xSlot, const xNtcModel * xModel) {
+  unsigned seq = xSlot->uSeq;
+  xWords w;
+  size_t i;
+
+  memset (&w, 0, sizeof (w));
+  memcpy (&w.xModel, xModel, sizeof (xNtcModel));
+  /* odd sequence while the model is written */
+  __atomic_store_n (&xSlot->uSeq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+  for (i = 0; i < NTC_FIT_SLOT_WORDS; i++) {
+
+    __atomic_store_n (&xSlot->uModel[i], w.uWord[i], __ATOMIC_RELAXED);
+  }
+  __atomic_store_n (&xSlot->uSeq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// -----------------------------------------------------------------------------
+unsigned
+uNtcFitGetModel (const xNtcFitSlot * xSlot, xNtcModel * xModel) {
+  unsigned seq;
+  xWords w;
+  size_t i;
+
+  for (;;) {
+
+    seq = __atomic_load_n (&xSlot->uSeq, __ATOMIC_ACQUIRE);
+    if (seq & 1) {
+      continue;
+    }
+    for (i = 0; i < NTC_FIT_SLOT_WORDS; i++) {
+
+      w.uWord[i] = __atomic_load_n (&xSlot->uModel[i], __ATOMIC_RELAXED);
+    }
+    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+    if (__atomic_load_n (&xSlot->uSeq, __ATOMIC_RELAXED) == seq) {
+
+      memcpy (xModel, &w.xModel, sizeof (xNtcModel));
+      return seq / 2;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+unsigned
+uNtcFitSlotVersion (const xNtcFitSlot * xSlot) {
+
+  return __atomic_load_n (&xSlot->uSeq, __ATOMIC_ACQUIRE) / 2;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcFitAdd (xNtcFit * xFit, double dTemp, double dRes) {
+
+  if (!valid (dTemp, dRes)) {
+
+    return -1;
+  }
+  add (xFit, log (dRes), 1.0 / (dTemp - TABS), 1.0);
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcFitAddWeighted (xNtcFit * xFit, double dTemp, double dRes,
+                    double dWeight) {
+
+  if (!valid (dTemp, dRes) || ! (dWeight >= 0.0) || isinf (dWeight)) {
+
+    return -1;
+  }
+  add (xFit, log (dRes), 1.0 / (dTemp - TABS), dWeight);
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcFitAddArray (xNtcFit * xFit, const double dTemp[], const double dRes[],
+                 size_t xCount) {
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    if (!valid (dTemp[i], dRes[i])) {
+
+      return -1;
+    }
+  }
+  for (i = 0; i < xCount; i++) {
+
+    add (xFit, log (dRes[i]), 1.0 / (dTemp[i] - TABS), 1.0);
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcFitSolve (const xNtcFit * xFit, double dCoeff[4], xNtcFitStats * xStats) {
+  double b[M];
+  int i, j;
+
+  /* back substitution R.b = Q'y, b coefficients of u = x - shift */
+  for (i = M - 1; i >= 0; i--) {
+
+    if (! (fabs (xFit->dR[i][i]) > SINGULAR * fabs (xFit->dR[0][0]))) {
+
+      return -1;
+    }
+    b[i] = xFit->dR[i][M];
+    for (j = i + 1; j < M; j++) {
+
+      b[i] -= xFit->dR[i][j] * b[j];
+    }
+    b[i] /= xFit->dR[i][i];
+  }
+
+  /* Taylor shift of b(x - shift) to the powers of x */
+  for (i = 0; i < M - 1; i++) {
+
+    for (j = M - 2; j >= i; j--) {
+
+      b[j] -= xFit->dShift * b[j + 1];
+    }
+  }
+  for (i = 0; i < M; i++) {
+
+    dCoeff[i] = b[i];
+  }
+  if (xStats) {
+
+    xStats->llCount = xFit->llCount;
+    xStats->dRms = sqrt (xFit->dRss / xFit->dWeight);
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcFitSolveForm (const xNtcFit * xFit, eNtcForm eForm, double dCoeff[4],
+                  xNtcFitStats * xStats) {
+  static const int col[2][3] = { { 0, 1 }, { 0, 1, 3 } };
+  double a[M][M], b[M], p[M], c, s, h, t, rss = 0.0;
+  int i, j, k, m, n;
+
+  if (eForm == eNtcFormExtended) {
+
+    return iNtcFitSolve (xFit, dCoeff, xStats);
+  }
+  n = (eForm == eNtcFormSimplified) ? 2 : 3;
+
+  /*
+   * Least squares of the columns of the form, x = u + shift:
+   * |V(x).c - y|^2 = |R.B.c - Q'y|^2 + rss with B[j][k] = C(k,j) shift^(k-j)
+   * the matrix of the powers of x in the powers of u.
+   */
+  p[0] = 1.0;
+  for (i = 1; i < M; i++) {
+
+    p[i] = p[i - 1] * xFit->dShift;
+  }
+  for (i = 0; i < M; i++) {
+
+    for (k = 0; k < n; k++) {
+
+      m = col[n - 2][k];
+      a[i][k] = 0.0;
+      for (j = i; j <= m; j++) {
+
+        a[i][k] += xFit->dR[i][j] * dBinom[j][m] * p[m - j];
+      }
+    }
+    a[i][n] = xFit->dR[i][M];
+  }
+
+  /* QR of the M x n matrix by Givens rotations */
+  for (k = 0; k < n; k++) {
+
+    for (i = k + 1; i < M; i++) {
+
+      if (a[i][k] == 0.0) {
+        continue;
+      }
+      h = sqrt (a[k][k] * a[k][k] + a[i][k] * a[i][k]);
+      c = a[k][k] / h;
+      s = a[i][k] / h;
+      for (j = k; j <= n; j++) {
+
+        t = a[k][j];
+        a[k][j] = c * t + s * a[i][j];
+        a[i][j] = c * a[i][j] - s * t;
+      }
+    }
+  }
+  for (i = n; i < M; i++) {
+
+    rss += a[i][n] * a[i][n];
+  }
+  for (i = n - 1; i >= 0; i--) {
+
+    if (! (fabs (a[i][i]) > SINGULAR * fabs (a[0][0]))) {
+
+      return -1;
+    }
+    b[i] = a[i][n];
+    for (j = i + 1; j < n; j++) {
+
+      b[i] -= a[i][j] * b[j];
+    }
+    b[i] /= a[i][i];
+  }
+  for (i = 0; i < M; i++) {
+
+    dCoeff[i] = 0.0;
+  }
+  for (k = 0; k < n; k++) {
+
+    dCoeff[col[n - 2][k]] = b[k];
+  }
+  if (xStats) {
+
+    xStats->llCount = xFit->llCount;
+    xStats->dRms = sqrt ( (xFit->dRss + rss) / xFit->dWeight);
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcFitMinimax (const double dTemp[], const double dRes[], size_t xCount,
+                eNtcForm eForm, double dCoeff[4], double * dMaxError) {
+  static const int col[3][M] = { { 0, 1 }, { 0, 1, 3 }, { 0, 1, 2, 3 } };
+  double b[M], best[M], e, h, max, err, shift = 0.0;
+  size_t ref[M + 1], i, k;
+  int j, it, pass, n = eForm + 2, ret = -1;
+  xPoint * p;
+
+  if (xCount <= (size_t) n) {
+
+    return -1;
+  }
+  p = malloc (xCount * sizeof (xPoint));
+  if (p == NULL) {
+
+    return -1;
+  }
+  for (i = 0; i < xCount; i++) {
+
+    if (!valid (dTemp[i], dRes[i])) {
+
+      goto end;
+    }
+    p[i].dX = log (dRes[i]);
+    p[i].dT = dTemp[i] - TABS;
+    p[i].dY = 1.0 / p[i].dT;
+    /* dT = -T^2 d(1/T) */
+    p[i].dS = p[i].dT * p[i].dT;
+    shift += p[i].dX;
+  }
+  /* the shift keeps all the powers of x in the extended form only */
+  shift = (eForm == eNtcFormExtended) ? shift / xCount : 0.0;
+  for (i = 0; i < xCount; i++) {
+
+    p[i].dX -= shift;
+  }
+  qsort (p, xCount, sizeof (xPoint), abscissa);
+
+  /*
+   * Remez exchange on the pairs: the polynom levelling the error of n + 1
+   * pairs with alternate signs, the pair of the maximal error replaces one
+   * of them until it is the levelled error. s = T.T' with T' = 1 / p(x) of
+   * the previous pass makes the residual the exact temperature error.
+   */
+  for (pass = 0; pass < MINIMAX_PASSES; pass++) {
+
+    for (j = 0; j <= n; j++) {
+
+      ref[j] = j * (xCount - 1) / n;
+    }
+    err = INFINITY;
+    for (it = 0; it < MINIMAX_ITERATIONS; it++) {
+
+      if (level (p, ref, col[eForm], n, b, &h) != 0) {
+
+        break;
+      }
+      for (max = 0.0, k = i = 0; i < xCount; i++) {
+
+        e = fabs (p[i].dS * (p[i].dY - poly3 (p[i].dX, b)));
+        if (e > max) {
+
+          max = e;
+          k = i;
+        }
+      }
+      if (max < err) {
+
+        err = max;
+        memcpy (best, b, sizeof (b));
+        ret = 0;
+      }
+      if (max <= fabs (h) * (1.0 + MINIMAX_GAP) + MINIMAX_FLOOR) {
+
+        break;
+      }
+      e = p[k].dY - poly3 (p[k].dX, b);
+      exchange (ref, n, k, (e < 0) ? -1 : 1, (h < 0) ? -1 : 1);
+    }
+    if (ret != 0) {
+
+      goto end;
+    }
+    for (i = 0; i < xCount; i++) {
+
+      e = poly3 (p[i].dX, best);
+      p[i].dS = (e > 0.0) ? p[i].dT / e : p[i].dS;
+    }
+  }
+
+  /* Taylor shift of best(x - shift) to the powers of x */
+  for (i = 0; i < M - 1; i++) {
+
+    for (j = M - 2; j >= (int) i; j--) {
+
+      best[j] -= shift * best[j + 1];
+    }
+  }
+  memcpy (dCoeff, best, sizeof (best));
+  if (dMaxError) {
+
+    *dMaxError = dNtcFitMaxError (dTemp, dRes, xCount, dCoeff, NULL);
+  }
+end:
+  free (p);
+  return ret;
+}
+
+// -----------------------------------------------------------------------------
+long long
+llNtcFitReadTable (const char * sPath, iNtcFitPoint iPoint, void * pvUser,
+                   size_t * xLine) {
+  const char * map, * p, * eol, * end;
+  double temp, res;
+  long long count = 0;
+  struct stat st;
+  size_t size, line = 0;
+  int fd, err = 0;
+
+  fd = open (sPath, O_RDONLY);
+  if (fd < 0) {
+
+    goto error;
+  }
+  if (fstat (fd, &st) != 0) {
+
+    close (fd);
+    goto error;
+  }
+  if (!S_ISREG (st.st_mode) || (st.st_size == 0)) {
+
+    close (fd);
+    errno = EINVAL;
+    goto error;
+  }
+  size = st.st_size;
+  map = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED) {
+
+    goto error;
+  }
+  madvise ( (void *) map, size, MADV_SEQUENTIAL);
+
+  end = map + size;
+  for (p = map, line = 1; p < end; p = eol + 1, line++) {
+
+    eol = memchr (p, '\n', end - p);
+    if (eol == NULL) {
+      eol = end;
+    }
+    while ( (p < eol) && blank (*p)) {
+      p++;
+    }
+    if ( (p == eol) || (*p == '#')) {
+      continue;
+    }
+    if (column (&p, eol, &temp) != 0) {
+
+      if (count == 0) {
+        /* header */
+        continue;
+      }
+      err = EINVAL;
+      break;
+    }
+    if (column (&p, eol, &res) != 0) {
+
+      err = EINVAL;
+      break;
+    }
+    if (!valid (temp, res)) {
+
+      err = ERANGE;
+      break;
+    }
+    if (iPoint (pvUser, temp, res) != 0) {
+
+      err = ECANCELED;
+      break;
+    }
+    count++;
+  }
+  munmap ( (void *) map, size);
+  if (err == 0) {
+
+    return count;
+  }
+  errno = err;
+
+error:
+  if (xLine) {
+
+    *xLine = line;
+  }
+  return -1;
+}
+
+// -----------------------------------------------------------------------------
+long long
+llNtcFitAddTable (xNtcFit * xFit, const char * sPath, size_t * xLine) {
+
+  return llNtcFitReadTable (sPath, point, xFit, xLine);
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcFitTable (const char * sPath, const xNtcFitOptions * xOptions,
+              xNtcFitResult * xResult) {
+  double dMaxError = xOptions ? xOptions->dMaxError : 0.0;
+  xNtcFitStats stats[3];
+  xTest t;
+  xNtcFit f;
+  int i;
+
+  memset (xResult, 0, sizeof (xNtcFitResult));
+  if (xOptions && (xOptions->eMethod == eNtcFitMinimax)) {
+
+    return minimax (sPath, dMaxError, xResult);
+  }
+  if (xOptions && ( (xOptions->eMethod == eNtcFitHuber) ||
+                    (xOptions->eMethod == eNtcFitTrimmed))) {
+
+    return robust (sPath, xOptions, xResult);
+  }
+  memset (&t, 0, sizeof (t));
+  init (&f, 1.0);
+  if (llNtcFitAddTable (&f, sPath, &xResult->xLine) < 0) {
+
+    xResult->iError = errno;
+    return -1;
+  }
+  for (i = (dMaxError > 0.0) ? 0 : eNtcFormExtended; i < 3; i++) {
+
+    t.iValid[i] = (iNtcFitSolveForm (&f, i, t.dCoeff[i], &stats[i]) == 0);
+  }
+  if (!t.iValid[eNtcFormExtended]) {
+
+    xResult->iError = EDOM;
+    return -1;
+  }
+  if (llNtcFitReadTable (sPath, test, &t, &xResult->xLine) < 0) {
+
+    /* file modified since the fit */
+    xResult->iError = errno;
+    return -1;
+  }
+
+  choose (&t, stats, stats[eNtcFormExtended].llCount, dMaxError, xResult);
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+size_t
+xNtcFitTables (const char * const sPath[], xNtcFitResult xResult[],
+               size_t xCount, const xNtcFitOptions * xOptions,
+               int iThreads) {
+  xBatch b = { sPath, xResult, xCount, xOptions, 0, 0 };
+  pthread_t tid[MAX_THREADS];
+  int i, n, started[MAX_THREADS];
+
+  n = (iThreads > 0) ? iThreads : (int) sysconf (_SC_NPROCESSORS_ONLN);
+  n = ( (size_t) n > xCount) ? (int) xCount : n;
+  n = (n > MAX_THREADS) ? MAX_THREADS : n;
+  for (i = 1; i < n; i++) {
+
+    started[i] = (pthread_create (&tid[i], NULL, work, &b) == 0);
+  }
+  /* the calling thread works too, and alone if thread creation failed */
+  work (&b);
+  for (i = 1; i < n; i++) {
+
+    if (started[i]) {
+
+      pthread_join (tid[i], NULL);
+    }
+  }
+  return b.xFailed;
+}
+
+// -----------------------------------------------------------------------------
+double
+dNtcFitMaxError (const double dTemp[], const double dRes[], size_t xCount,
+                 const double dCoeff[4], double * dAtTemp) {
+  double e, max = 0, at = 0;
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    e = fabs (dNtcResToTemp (dRes[i], (double *) dCoeff) - dTemp[i]);
+    if (e > max) {
+
+      max = e;
+      at = dTemp[i];
+    }
+  }
+  if (dAtTemp) {
+
+    *dAtTemp = at;
+  }
+  return max;
+}
+
+/* ========================================================================== */
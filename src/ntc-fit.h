@@ -0,0 +1,384 @@
+/**
+ * @file ntc-fit.h
+ * @brief NTC thermistor library (least squares fit)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#ifndef _NTC_FIT_H_
+#define _NTC_FIT_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ========================================================================== */
+#include <stddef.h>
+#include <stdint.h>
+#include "ntc.h"
+
+/* constants ================================================================ */
+/**
+ * Criterion of the fit of a table
+ */
+typedef enum eNtcFitMethod {
+  eNtcFitLeastSquares = 0, /**< least squares of the errors of 1/T */
+  eNtcFitMinimax,          /**< minimal maximal error of the temperature */
+  eNtcFitHuber,            /**< least squares with the weight threshold/|e| of
+                                the pairs whose temperature error e is
+                                beyond the threshold (Huber) */
+  eNtcFitTrimmed           /**< least squares without the pairs whose
+                                temperature error is beyond the threshold */
+} eNtcFitMethod;
+
+/** Number of 64-bit words of the model of a slot */
+#define NTC_FIT_SLOT_WORDS ( (sizeof (xNtcModel) + 7) / 8)
+
+/* structures =============================================================== */
+/**
+ * Least squares fit of the Steinhart-Hart coefficients
+ * Finds the coefficients a0...a3 minimizing the sum of the squares of
+ * 1/T - (a0 + a1 ln R + a2 (ln R)^2 + a3 (ln R)^3) over the (T, R) pairs
+ * added. Each pair is rotated into the triangular factor of a QR
+ * decomposition as soon as it is added, the pairs are not stored and the
+ * fit takes a constant memory whatever their number. Opaque structure,
+ * a fit is used by one thread at a time, different fits are independent.
+ */
+typedef struct xNtcFit xNtcFit;
+
+/**
+ * Model published by an online fit
+ * The model is written by one thread with vNtcFitPublish() and read by
+ * any number of converting threads with uNtcFitGetModel(), without locks:
+ * a sequence number, odd while the model is written, lets the readers
+ * retry a copy that was overwritten. The model is stored as words that are
+ * each accessed atomically. The fields are private, the structure
+ * is declared here only to allow static or automatic allocation, it must
+ * be initialized to zero or by a first vNtcFitPublish().
+ */
+typedef struct xNtcFitSlot {
+  unsigned uSeq;      /**< sequence number, twice the version */
+  uint64_t uModel[NTC_FIT_SLOT_WORDS]; /**< words of the model published */
+} xNtcFitSlot;
+
+/**
+ * Statistics of a fit
+ */
+typedef struct xNtcFitStats {
+  long long llCount;  /**< number of pairs */
+  double dRms;        /**< root mean square of the residuals of 1/T (in 1/K),
+                           weighted by the forgetting factor or the weights
+                           of the pairs */
+} xNtcFitStats;
+
+/**
+ * Result of the fit of a T-R table file
+ */
+typedef struct xNtcFitResult {
+  double dCoeff[4];       /**< Steinhart-Hart coefficients */
+  eNtcForm eForm;         /**< form of the coefficients */
+  xNtcFitStats xStats;    /**< statistics of the least squares fit */
+  double dRmsError;       /**< root mean square of the temperature errors */
+  double dMaxError;       /**< maximal temperature error (in degree Celsius) */
+  double dMaxErrorTemp;   /**< temperature of the maximal error */
+  int iError;             /**< 0, errno value if the fit failed */
+  size_t xLine;           /**< line of the error, 0 if not in a line */
+  long long llDownweighted; /**< pairs downweighted by a robust fit */
+  double dDownweightedError; /**< maximal temperature error of the pairs
+                                  downweighted by a robust fit */
+} xNtcFitResult;
+
+/**
+ * Function called for each pair downweighted by a robust fit
+ * @param pvUser user pointer of the options
+ * @param llIndex index of the pair in the table, from 0
+ * @param dTemp temperature of the pair (in degree Celsius)
+ * @param dRes resistance of the pair (in Ohm)
+ * @param dError temperature error of the pair (in degree Celsius)
+ * @param dWeight weight of the pair in the fit, in [0,1[
+ */
+typedef void (*vNtcFitOutlier) (void * pvUser, long long llIndex,
+                                double dTemp, double dRes, double dError,
+                                double dWeight);
+
+/**
+ * Options of the fit of a table
+ */
+typedef struct xNtcFitOptions {
+  eNtcFitMethod eMethod;  /**< criterion */
+  double dMaxError;       /**< maximal temperature error of the form
+                               selection (in degree Celsius), 0 to fit the
+                               extended form only */
+  double dThreshold;      /**< temperature error beyond which a robust fit
+                               downweights a pair (in degree Celsius), 0 for
+                               1.345 (Huber) or 3 (trimmed) times the robust
+                               standard deviation of the errors */
+  int iPasses;            /**< reweighted passes of a robust fit, 0 for 4 */
+  vNtcFitOutlier vOutlier; /**< called for each pair downweighted by a robust
+                                fit, may be NULL */
+  void * pvUser;          /**< user pointer of vOutlier */
+} xNtcFitOptions;
+
+/**
+ * Function called for each pair of a table
+ * @param pvUser pointer given to llNtcFitReadTable()
+ * @param dTemp temperature (in degree Celsius)
+ * @param dRes resistance (in Ohm)
+ * @return 0 to continue, -1 to stop the reading with an error
+ */
+typedef int (*iNtcFitPoint) (void * pvUser, double dTemp, double dRes);
+
+/* internal public functions ================================================ */
+/**
+ * Create a fit without pairs
+ * @return the fit, NULL on error. Must be released with vNtcFitDelete()
+ */
+xNtcFit * xNtcFitNew (void);
+
+/**
+ * Release a fit created by xNtcFitNew()
+ * @param xFit fit to release, may be NULL
+ */
+void vNtcFitDelete (xNtcFit * xFit);
+
+/**
+ * Remove all the pairs of a fit
+ * @param xFit fit
+ */
+void vNtcFitClear (xNtcFit * xFit);
+
+/**
+ * Set the forgetting factor of a fit
+ * Each added pair multiplies the weight of the previous ones by dLambda,
+ * so that the fit follows a drifting thermistor: the weight of a pair
+ * added n pairs ago is dLambda^n, the fit "remembers" about
+ * 1 / (1 - dLambda) pairs. The update stays in constant time. The factor
+ * is kept by vNtcFitClear().
+ * @param xFit fit
+ * @param dLambda forgetting factor, in ]0, 1], 1 (default) for an ordinary
+ *        least squares fit
+ * @return 0, -1 if dLambda is out of range
+ */
+int iNtcFitSetForgetting (xNtcFit * xFit, double dLambda);
+
+/**
+ * Add a pair to a fit
+ * The update takes a constant time (a few Givens rotations), with
+ * iNtcFitSolve() after each pair, a fit is a recursive least squares
+ * calibration of the thermistor.
+ * @param xFit fit
+ * @param dTemp temperature (in degree Celsius), above absolute zero
+ * @param dRes resistance (in Ohm), greater than 0
+ * @return 0, -1 if the pair is out of range (not added)
+ */
+int iNtcFitAdd (xNtcFit * xFit, double dTemp, double dRes);
+
+/**
+ * Add a weighted pair to a fit
+ * The squared residual of the pair counts dWeight times in the sum
+ * minimized, a pair of weight 1 is the same as iNtcFitAdd().
+ * @param xFit fit
+ * @param dTemp temperature (in degree Celsius), above absolute zero
+ * @param dRes resistance (in Ohm), greater than 0
+ * @param dWeight weight, positive or null
+ * @return 0, -1 if the pair or the weight is out of range (not added)
+ */
+int iNtcFitAddWeighted (xNtcFit * xFit, double dTemp, double dRes,
+                        double dWeight);
+
+/**
+ * Add pairs to a fit
+ * @param xFit fit
+ * @param dTemp temperatures (in degree Celsius)
+ * @param dRes corresponding resistances (in Ohm)
+ * @param xCount number of pairs
+ * @return 0, -1 if a pair is out of range (no pair added)
+ */
+int iNtcFitAddArray (xNtcFit * xFit, const double dTemp[], const double dRes[],
+                     size_t xCount);
+
+/**
+ * Solve a fit
+ * May be called at any time, more pairs may be added afterward.
+ * @param xFit fit
+ * @param dCoeff Steinhart-Hart coefficients found
+ * @param xStats statistics of the fit, may be NULL
+ * @return 0, -1 if there are less than 4 different resistances
+ */
+int iNtcFitSolve (const xNtcFit * xFit, double dCoeff[4],
+                  xNtcFitStats * xStats);
+
+/**
+ * Publish a model to the converting threads
+ * Must be called by one thread at a time for a given slot, does not wait
+ * for the readers.
+ * @param xSlot slot of the model
+ * @param xModel model, initialized with the coefficients of iNtcFitSolve()
+ */
+void vNtcFitPublish (xNtcFitSlot * xSlot, const xNtcModel * xModel);
+
+/**
+ * Copy the model of a slot
+ * May be called by several threads while the model is published, the copy
+ * is never a mix of two models.
+ * @param xSlot slot of the model
+ * @param xModel copy of the last model published
+ * @return version of the model, the number of vNtcFitPublish() calls
+ */
+unsigned uNtcFitGetModel (const xNtcFitSlot * xSlot, xNtcModel * xModel);
+
+/**
+ * Version of the model of a slot
+ * Cheap enough to be checked before each conversion batch, the model is
+ * copied again by uNtcFitGetModel() only when the version changed.
+ * @param xSlot slot of the model
+ * @return number of vNtcFitPublish() calls
+ */
+unsigned uNtcFitSlotVersion (const xNtcFitSlot * xSlot);
+
+/**
+ * Solve a fit with a form of the polynom
+ * The coefficients that are not in the form are null, so that the
+ * conversions with these coefficients skip them (see eNtcFormOf()).
+ * @param xFit fit
+ * @param eForm form of the polynom
+ * @param dCoeff Steinhart-Hart coefficients found
+ * @param xStats statistics of the fit, may be NULL
+ * @return 0, -1 if there are not enough different resistances for the form
+ */
+int iNtcFitSolveForm (const xNtcFit * xFit, eNtcForm eForm, double dCoeff[4],
+                      xNtcFitStats * xStats);
+
+/**
+ * Minimax fit of pairs
+ * Finds the coefficients of a form minimizing the maximal temperature
+ * error over the pairs, max |dNtcResToTemp(dRes[i]) - dTemp[i]|, instead of
+ * the squares of the errors of 1/T. Remez exchange on the pairs: the
+ * polynom levelling the error of n + 1 reference pairs (n coefficients of
+ * the form) with alternate signs is solved, then the pair of the maximal
+ * error replaces a reference pair, until the maximal error is within
+ * 1e-6 (relative, plus 1e-9 degree) of the levelled error or after 100
+ * exchanges. The error of 1/T is weighted by T^2, linearized around the
+ * polynom of the previous pass, 3 passes. If the levelled system becomes
+ * singular or the exchanges do not converge, the polynom of the smallest
+ * maximal error found is kept. The pairs are copied, sorted by resistance.
+ * @param dTemp temperatures (in degree Celsius)
+ * @param dRes corresponding resistances (in Ohm)
+ * @param xCount number of pairs
+ * @param eForm form of the polynom
+ * @param dCoeff Steinhart-Hart coefficients found
+ * @param dMaxError maximal temperature error of dCoeff, may be NULL
+ * @return 0, -1 if a pair is out of range, there are not enough different
+ *         resistances for the form, or on memory allocation failure
+ */
+int iNtcFitMinimax (const double dTemp[], const double dRes[], size_t xCount,
+                    eNtcForm eForm, double dCoeff[4], double * dMaxError);
+
+/**
+ * Read the pairs of a T-R table file
+ * The file is mapped in memory and parsed in place. Each line holds a
+ * temperature and a resistance separated by blanks, a comma or a semicolon,
+ * further columns are ignored. Empty lines and lines beginning with '#'
+ * are skipped, as well as the lines preceding the first pair whose first
+ * column is not a number (headers).
+ * @param sPath path of the file, a regular file
+ * @param iPoint function called for each pair
+ * @param pvUser pointer passed to iPoint
+ * @param xLine number of the line of the error, 0 if the file can not be
+ *        read, may be NULL
+ * @return number of pairs read, -1 on error with errno set: EINVAL for a
+ *         line that is not valid, ERANGE for a pair out of range, ECANCELED
+ *         if iPoint stopped the reading, or the error of the file access
+ */
+long long llNtcFitReadTable (const char * sPath, iNtcFitPoint iPoint,
+                             void * pvUser, size_t * xLine);
+
+/**
+ * Add the pairs of a T-R table file to a fit
+ * Calls llNtcFitReadTable() with iNtcFitAdd().
+ * @param xFit fit
+ * @param sPath path of the file
+ * @param xLine number of the line of the error, may be NULL
+ * @return number of pairs added, -1 on error (the pairs read before the
+ *         error stay added)
+ */
+long long llNtcFitAddTable (xNtcFit * xFit, const char * sPath,
+                            size_t * xLine);
+
+/**
+ * Fit a T-R table file
+ * Reads the table twice: to fit it, then to measure the temperature errors
+ * of the coefficients found. With a maximal error, the three forms are
+ * fitted (from the same decomposition) and the smallest one whose maximal
+ * temperature error over the table is below the maximal error is selected,
+ * the extended form if none is. The minimax method reads the table once,
+ * in memory, and calls iNtcFitMinimax() for each form tried.
+ * The robust methods keep streaming the file, iPasses + 3 times: least
+ * squares, the robust standard deviation of the errors (1.4826 times their
+ * median, from a logarithmic histogram), iPasses passes weighting each pair
+ * by the error of the previous coefficients (with the standard deviation of
+ * the previous pass), the last one measuring the errors and reporting the
+ * pairs downweighted by the last weighted pass. The forms are solved from
+ * that pass, their errors (form selection, dRmsError and dMaxError) are
+ * measured over all the pairs but the ones removed by the trimmed fit; the
+ * maximal error of the downweighted pairs is given by dDownweightedError.
+ * @param sPath path of the file
+ * @param xOptions options, NULL for an extended least squares fit
+ * @param xResult result of the fit
+ * @return 0, -1 on error with xResult->iError set: EDOM if there are less
+ *         than 4 different resistances, ENOMEM, or the error of
+ *         llNtcFitReadTable()
+ */
+int iNtcFitTable (const char * sPath, const xNtcFitOptions * xOptions,
+                  xNtcFitResult * xResult);
+
+/**
+ * Fit T-R table files in parallel
+ * Each thread takes the next file not yet fitted and calls iNtcFitTable(),
+ * so that large and small tables are balanced between the threads.
+ * @param sPath paths of the files
+ * @param xResult results of the fits, in the order of sPath
+ * @param xCount number of files
+ * @param xOptions options of the fits, may be NULL (see iNtcFitTable()),
+ *        vOutlier is called by all the threads
+ * @param iThreads number of threads, 0 for the number of online processors
+ * @return number of files whose fit failed (see xResult[i].iError)
+ */
+size_t xNtcFitTables (const char * const sPath[], xNtcFitResult xResult[],
+                      size_t xCount, const xNtcFitOptions * xOptions,
+                      int iThreads);
+
+/**
+ * Maximal temperature error of coefficients
+ * @param dTemp temperatures (in degree Celsius)
+ * @param dRes corresponding resistances (in Ohm)
+ * @param xCount number of pairs
+ * @param dCoeff Steinhart-Hart coefficients
+ * @param dAtTemp temperature of the maximal error, may be NULL
+ * @return the largest absolute difference between dTemp[i] and
+ *         dNtcResToTemp(dRes[i]) (in degree Celsius)
+ */
+double dNtcFitMaxError (const double dTemp[], const double dRes[],
+                        size_t xCount, const double dCoeff[4],
+                        double * dAtTemp);
+
+/* ========================================================================== */
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NTC_FIT_H_ defined */
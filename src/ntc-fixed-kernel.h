@@ -0,0 +1,90 @@
+/**
+ * @file ntc-fixed-kernel.h
+ * @brief NTC thermistor library (fixed point array kernels, private)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ *
+ * This file is a template, it has no include guard and is included by
+ * ntc-fixed.c once for each instruction set of the array conversions.
+ * Before inclusion, NTC_KERNEL_SUFFIX must be defined, it is appended to
+ * every generated identifier. The block functions of ntc-fixed.c are
+ * inlined, so that the compiler vectorizes their loops over the BLOCK
+ * lanes with the instructions of the target.
+ */
+
+/* macros =================================================================== */
+#define NTC_KCAT2(a, b) a##_##b
+#define NTC_KCAT(a, b) NTC_KCAT2(a, b)
+#define NTC_K(name) NTC_KCAT(name, NTC_KERNEL_SUFFIX)
+
+/* kernels ================================================================== */
+static void
+NTC_K(vResToTempArray) (const xNtcFixModel * xModel, const uint32_t uR[],
+                        int32_t iT[], size_t xCount) {
+  const xNtcFixPoly * p = &xModel->xForward;
+  uint32_t r[BLOCK];
+  int32_t x[BLOCK];
+  size_t i, j, n;
+
+  for (i = 0; i < xCount; i += n) {
+
+    n = (xCount - i < BLOCK) ? xCount - i : BLOCK;
+    for (j = 0; j < BLOCK; j++) {
+
+      r[j] = (j < n) ? uR[i + j] : 1U;
+    }
+    log2q24_block (r, x);
+    variable_block (p, x);
+    clenshaw_block (p->iC, p->iDegree, x, x);
+    for (j = 0; j < n; j++) {
+
+      iT[i + j] = (x[j] + 128) >> 8;
+    }
+  }
+}
+
+static void
+NTC_K(vTempToResArray) (const xNtcFixModel * xModel, const int32_t iT[],
+                        uint32_t uR[], size_t xCount) {
+  const xNtcFixPoly * p = &xModel->xInverse;
+  int32_t x[BLOCK];
+  size_t i, j, n;
+
+  for (i = 0; i < xCount; i += n) {
+
+    n = (xCount - i < BLOCK) ? xCount - i : BLOCK;
+    for (j = 0; j < BLOCK; j++) {
+
+      x[j] = (j < n) ? iT[i + j] : 0;
+    }
+    variable_block (p, x);
+    clenshaw_block (p->iC, p->iDegree, x, x);
+    for (j = 0; j < n; j++) {
+
+      uR[i + j] = exp2q22 (x[j]);
+    }
+  }
+}
+
+/* ========================================================================== */
+#undef NTC_K
+#undef NTC_KCAT
+#undef NTC_KCAT2
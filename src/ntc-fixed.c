@@ -0,0 +1,408 @@
+/**
+ * @file ntc-fixed.c
+ * @brief NTC thermistor library (fixed point, implementation)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#include <math.h>
+#include "ntc-fixed.h"
+
+/* constants ================================================================ */
+/* Fit tolerance of the forward polynom, in Q8 of 1/100 degree (0.0005 degree) */
+#define FORWARD_TOLERANCE (0.0005 * NTC_FIX_TEMP_SCALE * 256.0)
+/* Fit tolerance of the inverse polynom, in Q22 of log2(r) (1e-6 relative) */
+#define INVERSE_TOLERANCE (1e-6 / M_LN2 * 4194304.0)
+/* Number of points where the fit is checked */
+#define CHECK_POINTS 1024
+/* Number of values converted together by the array functions */
+#define BLOCK 16
+
+/*
+ * Chebyshev coefficients in Q28 of log2(1 + f), f in [0, 1),
+ * with t = 2f - 1 (max. error 5.6e-8).
+ */
+static const int32_t iLog2[] = {
+  145789070, 132890227, -11400179, 1303974, -167795, 23031, -3293, 484, -71
+};
+
+/*
+ * Chebyshev coefficients in Q28 of 2^f, f in [0, 1),
+ * with t = 2f - 1 (max. error 2.8e-9).
+ */
+static const int32_t iExp2[] = {
+  391110426, 133553315, 11514032, 663419, 28697, 994, 29
+};
+
+/* private functions ======================================================== */
+/*
+ * Clenshaw recurrence: sum of c[k] T_k(t), t in Q24, result in the format
+ * of the coefficients.
+ */
+static inline int32_t
+clenshaw (const int32_t c[], int n, int32_t t) {
+  int32_t b, b1 = 0, b2 = 0;
+  int k;
+
+  for (k = n; k >= 1; k--) {
+
+    b  = c[k] + (int32_t) ( ( (int64_t) t * b1) >> 23) - b2;
+    b2 = b1;
+    b1 = b;
+  }
+  return c[0] + (int32_t) ( ( (int64_t) t * b1) >> 24) - b2;
+}
+
+/*
+ * Variable of a polynom in Q24, clamped to [-1, 1].
+ */
+static inline int32_t
+variable (const xNtcFixPoly * p, int32_t x) {
+  int64_t t;
+
+  t = ( ( (int64_t) x - p->iOffset) * p->iScale) >> p->iShift;
+  t = (t > (1 << 24)) ? (1 << 24) : t;
+  t = (t < -(1 << 24)) ? -(1 << 24) : t;
+  return (int32_t) t;
+}
+
+/*
+ * log2 in Q24 of a resistance in Q24.8, branchless normalization (no clz
+ * instruction is needed) followed by the polynom of the mantissa.
+ */
+static inline int32_t
+log2q24 (uint32_t x) {
+  int32_t e = 31, s;
+
+  s = (x < 0x10000U) << 4;
+  x <<= s;
+  e -= s;
+  s = (x < 0x1000000U) << 3;
+  x <<= s;
+  e -= s;
+  s = (x < 0x10000000U) << 2;
+  x <<= s;
+  e -= s;
+  s = (x < 0x40000000U) << 1;
+  x <<= s;
+  e -= s;
+  s = (x < 0x80000000U);
+  x <<= s;
+  e -= s;
+  /* x = (1 + f) 2^31, t = 2f - 1 */
+  s = (int32_t) ( (x - 0x80000000U) >> 6) - (1 << 24);
+  return (e - NTC_FIX_RES_SHIFT) * (1 << 24) + (clenshaw (iLog2, 8, s) >> 4);
+}
+
+/*
+ * 2^v, v in Q22, as a resistance in Q24.8, saturated.
+ */
+static inline uint32_t
+exp2q22 (int32_t v) {
+  uint64_t r;
+  int32_t e, t;
+
+  v += NTC_FIX_RES_SHIFT << 22;
+  e = v >> 22;
+  t = ( (v & ( (1 << 22) - 1)) << 3) - (1 << 24);
+  e = (e < 0) ? 0 : e;
+  e = (e > 31) ? 31 : e;
+  r = ( (uint64_t) clenshaw (iExp2, 6, t) << e) >> 28;
+  return (r > UINT32_MAX) ? UINT32_MAX : (uint32_t) r;
+}
+
+/*
+ * Block versions of the functions above: each loop runs over the BLOCK
+ * lanes with straight-line code, so that the compiler vectorizes it
+ * with integer SIMD when the target has a widening 32-bit multiplication
+ * (SSE4.1, AVX2, NEON). SSE2 has none: on x86_64, the array functions
+ * are compiled for AVX2 and AVX-512 too (ntc-fixed-kernel.h) and the
+ * instruction set of the batch conversions is used (eNtcIsaGet()).
+ */
+static inline void
+clenshaw_block (const int32_t c[], int n, const int32_t t[], int32_t y[]) {
+  int32_t b[BLOCK], b1[BLOCK], b2[BLOCK];
+  int j, k;
+
+  for (j = 0; j < BLOCK; j++) {
+
+    b1[j] = 0;
+    b2[j] = 0;
+  }
+  for (k = n; k >= 1; k--) {
+    for (j = 0; j < BLOCK; j++) {
+
+      b[j]  = c[k] + (int32_t) ( ( (int64_t) t[j] * b1[j]) >> 23) - b2[j];
+      b2[j] = b1[j];
+      b1[j] = b[j];
+    }
+  }
+  for (j = 0; j < BLOCK; j++) {
+
+    y[j] = c[0] + (int32_t) ( ( (int64_t) t[j] * b1[j]) >> 24) - b2[j];
+  }
+}
+
+static inline void
+variable_block (const xNtcFixPoly * p, int32_t x[]) {
+  int64_t t;
+  int j;
+
+  for (j = 0; j < BLOCK; j++) {
+
+    t = ( ( (int64_t) x[j] - p->iOffset) * p->iScale) >> p->iShift;
+    t = (t > (1 << 24)) ? (1 << 24) : t;
+    t = (t < -(1 << 24)) ? -(1 << 24) : t;
+    x[j] = (int32_t) t;
+  }
+}
+
+static inline void
+log2q24_block (const uint32_t r[], int32_t y[]) {
+  int32_t e[BLOCK], t[BLOCK];
+  uint32_t x;
+  int j;
+
+  for (j = 0; j < BLOCK; j++) {
+
+    x = r[j];
+    e[j] = 31 - NTC_FIX_RES_SHIFT;
+    e[j] -= (x < 0x10000U) ? 16 : 0;
+    x = (x < 0x10000U) ? x << 16 : x;
+    e[j] -= (x < 0x1000000U) ? 8 : 0;
+    x = (x < 0x1000000U) ? x << 8 : x;
+    e[j] -= (x < 0x10000000U) ? 4 : 0;
+    x = (x < 0x10000000U) ? x << 4 : x;
+    e[j] -= (x < 0x40000000U) ? 2 : 0;
+    x = (x < 0x40000000U) ? x << 2 : x;
+    e[j] -= (x < 0x80000000U) ? 1 : 0;
+    x = (x < 0x80000000U) ? x << 1 : x;
+    t[j] = (int32_t) ( (x - 0x80000000U) >> 6) - (1 << 24);
+  }
+  clenshaw_block (iLog2, 8, t, y);
+  for (j = 0; j < BLOCK; j++) {
+
+    y[j] = e[j] * (1 << 24) + (y[j] >> 4);
+  }
+}
+
+/*
+ * Array kernels of each instruction set, the default one is used for the
+ * scalar, SSE2 and generic vector levels.
+ */
+#define NTC_KERNEL_SUFFIX base
+#include "ntc-fixed-kernel.h"
+#undef NTC_KERNEL_SUFFIX
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define NTC_HAVE_X86_KERNELS 1
+
+#pragma GCC push_options
+#pragma GCC target ("avx2")
+#define NTC_KERNEL_SUFFIX avx2
+#include "ntc-fixed-kernel.h"
+#undef NTC_KERNEL_SUFFIX
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target ("avx512f")
+#define NTC_KERNEL_SUFFIX avx512
+#include "ntc-fixed-kernel.h"
+#undef NTC_KERNEL_SUFFIX
+#pragma GCC pop_options
+#endif
+
+typedef struct xKernel {
+  void (*vResToTemp) (const xNtcFixModel *, const uint32_t *, int32_t *,
+                      size_t);
+  void (*vTempToRes) (const xNtcFixModel *, const int32_t *, uint32_t *,
+                      size_t);
+} xKernel;
+
+#define KERNEL(suffix) { vResToTempArray_##suffix, vTempToResArray_##suffix }
+
+static const xKernel xBase = KERNEL (base);
+#if defined(NTC_HAVE_X86_KERNELS)
+static const xKernel xAvx2 = KERNEL (avx2);
+static const xKernel xAvx512 = KERNEL (avx512);
+#endif
+
+/*
+ * Kernel of the instruction set of the batch conversions.
+ */
+static inline const xKernel *
+kernel (void) {
+
+#if defined(NTC_HAVE_X86_KERNELS)
+  switch (eNtcIsaGet()) {
+
+    case eNtcIsaAvx2:
+      return &xAvx2;
+    case eNtcIsaAvx512:
+      return &xAvx512;
+    default:
+      break;
+  }
+#endif
+  return &xBase;
+}
+
+/*
+ * Functions fitted by the polynoms.
+ */
+typedef double (*fitfunc) (const double a[4], double x);
+
+static double
+forward (const double a[4], double u) {
+
+  u = dNtcResToTemp (exp2 (u / 16777216.0), (double *) a);
+  return u * NTC_FIX_TEMP_SCALE * 256.0;
+}
+
+static double
+inverse (const double a[4], double t) {
+
+  return log2 (dNtcTempToRes (t / NTC_FIX_TEMP_SCALE, (double *) a)) * 4194304.0;
+}
+
+/*
+ * Fits the Chebyshev polynom of lowest degree of f over [lo, hi].
+ */
+static int
+fit (xNtcFixPoly * p, const double a[4], fitfunc f, double lo, double hi,
+     double tol) {
+  double c[NTC_FIX_MAX_DEGREE + 1], center, half, scale, x, th, s, err;
+  int n, j, k;
+
+  center = 0.5 * (lo + hi);
+  half = 0.5 * (hi - lo);
+  if ( (half < 1.0) || (fabs (center) > INT32_MAX / 2) ||
+       (fabs (half) > INT32_MAX / 2)) {
+
+    return -1;
+  }
+  p->iOffset = (int32_t) lround (center);
+  for (p->iShift = 0, scale = 16777216.0 / half; scale < (1 << 29); p->iShift++) {
+    scale *= 2.0;
+  }
+  p->iScale = (int32_t) lround (scale);
+
+  for (n = 1; n <= NTC_FIX_MAX_DEGREE; n++) {
+
+    /* interpolation at the n + 1 Chebyshev nodes */
+    for (k = 0; k <= n; k++) {
+
+      s = 0.0;
+      for (j = 0; j <= n; j++) {
+
+        th = M_PI * (j + 0.5) / (n + 1);
+        s += f (a, center + half * cos (th)) * cos (k * th);
+      }
+      c[k] = 2.0 * s / (n + 1);
+    }
+    c[0] *= 0.5;
+    p->iDegree = n;
+    for (k = 0; k <= n; k++) {
+
+      if (fabs (c[k]) > (1 << 30)) {
+        return -1;
+      }
+      p->iC[k] = (int32_t) lround (c[k]);
+    }
+    for (k = n + 1; k <= NTC_FIX_MAX_DEGREE; k++) {
+
+      p->iC[k] = 0;
+    }
+
+    /* check of the integer evaluation */
+    for (j = 0, err = 0.0; j <= CHECK_POINTS; j++) {
+
+      x = round (lo + (hi - lo) * j / CHECK_POINTS);
+      s = fabs (clenshaw (p->iC, n, variable (p, (int32_t) x)) - f (a, x));
+      err = (s > err) ? s : err;
+    }
+    if (err < tol) {
+
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/* internal public functions ================================================ */
+// -----------------------------------------------------------------------------
+int
+iNtcFixModelInit (xNtcFixModel * xModel, const double dCoeff[4],
+                  double dTmin, double dTmax) {
+  double rmin, rmax;
+
+  if (dTmax <= dTmin) {
+
+    return -1;
+  }
+  rmin = dNtcTempToRes (dTmax, (double *) dCoeff);
+  rmax = dNtcTempToRes (dTmin, (double *) dCoeff);
+  if ( (rmin * (1 << NTC_FIX_RES_SHIFT) < 1.0) ||
+       (rmax * (1 << NTC_FIX_RES_SHIFT) > UINT32_MAX)) {
+
+    return -1;
+  }
+  if (fit (&xModel->xForward, dCoeff, forward, log2 (rmin) * 16777216.0,
+           log2 (rmax) * 16777216.0, FORWARD_TOLERANCE) != 0) {
+
+    return -1;
+  }
+  return fit (&xModel->xInverse, dCoeff, inverse, dTmin * NTC_FIX_TEMP_SCALE,
+              dTmax * NTC_FIX_TEMP_SCALE, INVERSE_TOLERANCE);
+}
+
+// -----------------------------------------------------------------------------
+int32_t
+iNtcFixResToTemp (const xNtcFixModel * xModel, uint32_t uR) {
+  const xNtcFixPoly * p = &xModel->xForward;
+
+  return (clenshaw (p->iC, p->iDegree, variable (p, log2q24 (uR))) + 128) >> 8;
+}
+
+// -----------------------------------------------------------------------------
+uint32_t
+uNtcFixTempToRes (const xNtcFixModel * xModel, int32_t iT) {
+  const xNtcFixPoly * p = &xModel->xInverse;
+
+  return exp2q22 (clenshaw (p->iC, p->iDegree, variable (p, iT)));
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcFixResToTempArray (const xNtcFixModel * xModel, const uint32_t uR[],
+                       int32_t iT[], size_t xCount) {
+
+  kernel()->vResToTemp (xModel, uR, iT, xCount);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcFixTempToResArray (const xNtcFixModel * xModel, const int32_t iT[],
+                       uint32_t uR[], size_t xCount) {
+
+  kernel()->vTempToRes (xModel, iT, uR, xCount);
+}
+
+/* ========================================================================== */
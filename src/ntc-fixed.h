@@ -0,0 +1,143 @@
+/**
+ * @file ntc-fixed.h
+ * @brief NTC thermistor library (fixed point)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#ifndef _NTC_FIXED_H_
+#define _NTC_FIXED_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ========================================================================== */
+#include <stdint.h>
+#include "ntc.h"
+
+/* constants ================================================================ */
+/** Resistances are unsigned Q24.8 (1/256 Ohm, up to 16.7 MOhm) */
+#define NTC_FIX_RES_SHIFT 8
+
+/** Number of fixed point temperature units in one degree Celsius */
+#define NTC_FIX_TEMP_SCALE 100
+
+/** Maximal degree of the polynoms of a fixed point model */
+#define NTC_FIX_MAX_DEGREE 14
+
+/* structures =============================================================== */
+/**
+ * Chebyshev polynom with integer coefficients
+ * The variable x is mapped to t = ((x - iOffset) * iScale) >> iShift,
+ * t in Q24 clamped to [-1, 1], then the sum of iC[k] T<sub>k</sub>(t) is
+ * evaluated with the Clenshaw recurrence.
+ */
+typedef struct xNtcFixPoly {
+  int32_t iOffset;                     /**< center of the variable */
+  int32_t iScale;                      /**< scale factor of the variable */
+  int32_t iShift;                      /**< shift of the variable */
+  int32_t iDegree;                     /**< degree of the polynom */
+  int32_t iC[NTC_FIX_MAX_DEGREE + 1];  /**< Chebyshev coefficients */
+} xNtcFixPoly;
+
+/**
+ * Fixed point thermistor model
+ * Only contains integers: it may be computed on a host and stored as a
+ * constant in the firmware of a target without FPU.
+ */
+typedef struct xNtcFixModel {
+  xNtcFixPoly xForward; /**< temperature (Q8 of 1/100 degree) over log2(r) in Q24 */
+  xNtcFixPoly xInverse; /**< log2(r) in Q22 over temperature (1/100 degree) */
+} xNtcFixModel;
+
+/* internal public functions ================================================ */
+/**
+ * Initialize a fixed point model
+ * Chebyshev polynoms are fitted over [dTmin, dTmax] to the Steinhart-Hart
+ * polynom, with the lowest degree giving less than 0.0005 degree Celsius
+ * (forward) and 1e-6 relative on the resistance (inverse). This function
+ * uses floating point, the conversions do not.
+ *
+ * Error budget of the conversions against dNtcResToTemp(), inside
+ * [dTmin, dTmax]: polynom fit 0.0005, integer log2 (5.6e-8 on log2 r)
+ * less than 0.0001, Q formats less than 0.0001 and final rounding to
+ * 1/NTC_FIX_TEMP_SCALE 0.005, that is less than 0.006 degree Celsius. The
+ * resistance is given to 1e-6 relative plus one 1/256 Ohm unit. Outside
+ * [dTmin, dTmax], the result is clamped to the range.
+ * @param xModel model to initialize
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @param dTmin minimal temperature (in degree Celsius)
+ * @param dTmax maximal temperature (in degree Celsius)
+ * @return 0, -1 on error (range or accuracy not reachable)
+ */
+int iNtcFixModelInit (xNtcFixModel * xModel, const double dCoeff[4],
+                      double dTmin, double dTmax);
+
+/**
+ * Fixed point conversion from resistance to temperature
+ * Integer operations only: log2 by normalization and a Chebyshev polynom of
+ * the mantissa, then the Clenshaw recurrence of the model.
+ * @param xModel fixed point model
+ * @param uR resistance in 1/2^NTC_FIX_RES_SHIFT Ohm, not null
+ * @return temperature in 1/NTC_FIX_TEMP_SCALE degree Celsius
+ */
+int32_t iNtcFixResToTemp (const xNtcFixModel * xModel, uint32_t uR);
+
+/**
+ * Fixed point conversion from temperature to resistance
+ * Integer operations only: Clenshaw recurrence of the model, then 2^x by a
+ * Chebyshev polynom of the fraction and a shift.
+ * @param xModel fixed point model
+ * @param iT temperature in 1/NTC_FIX_TEMP_SCALE degree Celsius
+ * @return resistance in 1/2^NTC_FIX_RES_SHIFT Ohm, saturated
+ */
+uint32_t uNtcFixTempToRes (const xNtcFixModel * xModel, int32_t iT);
+
+/**
+ * Fixed point conversion from resistance to temperature of an array
+ * Values are converted by blocks of 16 with loops over the lanes that only
+ * contain 32-bit integer operations and 32x32 to 64-bit multiplications,
+ * they are vectorized by the compiler with integer SIMD when the target has
+ * a widening multiplication (SSE4.1, AVX2, NEON). On x86_64, whose base
+ * SSE2 has none, the loops are also compiled for AVX2 and AVX-512 and
+ * follow the instruction set of the batch conversions (see iNtcIsaSet()),
+ * with the same results.
+ * @param xModel fixed point model
+ * @param uR resistances in 1/2^NTC_FIX_RES_SHIFT Ohm
+ * @param iT corresponding temperatures in 1/NTC_FIX_TEMP_SCALE degree Celsius
+ * @param xCount number of values to convert
+ */
+void vNtcFixResToTempArray (const xNtcFixModel * xModel, const uint32_t uR[],
+                            int32_t iT[], size_t xCount);
+
+/**
+ * Fixed point conversion from temperature to resistance of an array
+ * @param xModel fixed point model
+ * @param iT temperatures in 1/NTC_FIX_TEMP_SCALE degree Celsius
+ * @param uR corresponding resistances in 1/2^NTC_FIX_RES_SHIFT Ohm
+ * @param xCount number of values to convert
+ */
+void vNtcFixTempToResArray (const xNtcFixModel * xModel, const int32_t iT[],
+                            uint32_t uR[], size_t xCount);
+
+/* ========================================================================== */
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NTC_FIXED_H_ defined */
@@ -0,0 +1,469 @@
+/**
+ * @file ntc-kernel.h
+ * @brief NTC thermistor library (vector kernels, private)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ *
+ * This file is a template, it has no include guard and is included by ntc.c
+ * once for each vector width. Before inclusion, the following macros must be
+ * defined:
+ * - NTC_VEC_BYTES width of a vector register in bytes (16, 32 or 64),
+ * - NTC_KERNEL_SUFFIX suffix appended to every generated identifier.
+ * .
+ * The kernels are written with the GCC vector extensions, the compiler
+ * lowers them to SSE2, AVX2 or NEON according to the target.
+ */
+#include <stdint.h>
+#include <string.h>
+
+/* macros =================================================================== */
+#define NTC_KCAT2(a, b) a##_##b
+#define NTC_KCAT(a, b) NTC_KCAT2(a, b)
+#define NTC_K(name) NTC_KCAT(name, NTC_KERNEL_SUFFIX)
+
+typedef double NTC_K(vdouble) __attribute__ ((vector_size (NTC_VEC_BYTES)));
+typedef uint64_t NTC_K(vuint) __attribute__ ((vector_size (NTC_VEC_BYTES)));
+typedef float NTC_K(vfloat) __attribute__ ((vector_size (NTC_VEC_BYTES)));
+typedef int32_t NTC_K(vint32) __attribute__ ((vector_size (NTC_VEC_BYTES)));
+
+#define VD NTC_K(vdouble)
+#define VU NTC_K(vuint)
+#define VF NTC_K(vfloat)
+#define VI NTC_K(vint32)
+#define VLEN (NTC_VEC_BYTES / sizeof (double))
+#define VFLEN (NTC_VEC_BYTES / sizeof (float))
+
+/* private functions ======================================================== */
+/*
+ * Natural logarithm of each element of x.
+ * fdlibm algorithm: x = 2^k * (1 + f) with sqrt(2)/2 <= 1 + f < sqrt(2), then
+ * log(1 + f) = f - f^2/2 + s * (f^2/2 + R(s^2)), s = f / (2 + f).
+ * Error is less than 1 ulp for positive normal x, other values are not
+ * supported (no NaN, infinity or denormal handling).
+ */
+static inline VD
+NTC_K(vLog) (VD x) {
+  VU ix;
+  VD f, k, s, z, w, t1, t2, hfsq;
+
+  ix = (VU) x;
+  /* reduce x into [sqrt(2)/2, sqrt(2)) */
+  ix += 0x3ff0000000000000ULL - 0x3fe6a09e00000000ULL;
+  k = (VD) ((ix >> 52) | 0x4330000000000000ULL) - (4503599627370496.0 + 1023.0);
+  ix = (ix & 0x000fffffffffffffULL) + 0x3fe6a09e00000000ULL;
+  f = (VD) ix - 1.0;
+
+  s = f / (2.0 + f);
+  z = s * s;
+  w = z * z;
+  t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 +
+                                            w * 1.531383769920937332e-01));
+  t2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01 +
+            w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+  hfsq = 0.5 * f * f;
+  return s * (hfsq + t2 + t1) + k * 1.90821492927058770002e-10 - hfsq + f +
+         k * 6.93147180369123816490e-01;
+}
+
+/*
+ * Exponential of each element of x.
+ * fdlibm algorithm: x = k ln2 + r with |r| <= ln2/2, exp(r) by a rational
+ * approximation, then scaling by 2^k with an integer add on the exponent.
+ * Error is less than 1 ulp for |x| < 700.
+ */
+static inline VD
+NTC_K(vExp) (VD x) {
+  VU ki;
+  VD k, hi, lo, r, rr, c;
+
+  /* k = round (x / ln2), its low bits are kept in ki */
+  k = x * 1.44269504088896338700e+00 + 6755399441055744.0;
+  ki = (VU) k;
+  k -= 6755399441055744.0;
+  hi = x - k * 6.93147180369123816490e-01;
+  lo = k * 1.90821492927058770002e-10;
+  r = hi - lo;
+  rr = r * r;
+  c = r - rr * (1.66666666666666019037e-01 + rr * (-2.77777777770155933842e-03 +
+      rr * (6.61375632143793436117e-05 + rr * (-1.65339022054652515390e-06 +
+      rr * 4.13813679705723846039e-08))));
+  r = 1.0 + (r * c / (2.0 - c) - lo + hi);
+  return (VD) ((VU) r + (ki << 52));
+}
+
+/*
+ * Steinhart-Hart temperature (in degree Celsius) for resistances r,
+ * Horner schema unrolled for the degree of the form, the terms that are
+ * null in the form are not evaluated (form is a constant once inlined).
+ */
+static inline __attribute__ ((always_inline)) VD
+NTC_K(vResToTempForm) (VD r, const double a[4], eNtcForm form) {
+  VD x;
+
+  x = NTC_K(vLog) (r);
+  switch (form) {
+    case eNtcFormSimplified:
+      x = a[1] * x + a[0];
+      break;
+    case eNtcFormStandard:
+      x = (a[3] * x * x + a[1]) * x + a[0];
+      break;
+    default:
+      x = ((a[3] * x + a[2]) * x + a[1]) * x + a[0];
+      break;
+  }
+  return 1.0 / x + TABS;
+}
+
+/*
+ * Batch conversion from resistance to temperature with the polynom of a form.
+ * The tail is padded so that every element goes through the same kernel.
+ */
+static inline __attribute__ ((always_inline)) void
+NTC_K(vResToTempLoop) (const double dR[], double dT[], size_t xCount,
+                       const double a[4], eNtcForm form) {
+  VD r;
+  size_t i;
+
+  for (i = 0; i + VLEN <= xCount; i += VLEN) {
+
+    memcpy (&r, &dR[i], sizeof (r));
+    r = NTC_K(vResToTempForm) (r, a, form);
+    memcpy (&dT[i], &r, sizeof (r));
+  }
+  if (i < xCount) {
+    double buf[VLEN];
+    size_t j;
+
+    for (j = 0; j < VLEN; j++) {
+
+      buf[j] = (i + j < xCount) ? dR[i + j] : 1.0;
+    }
+    memcpy (&r, buf, sizeof (r));
+    r = NTC_K(vResToTempForm) (r, a, form);
+    memcpy (&dT[i], &r, (xCount - i) * sizeof (double));
+  }
+}
+
+/*
+ * Batch conversions from resistance to temperature, one for each form.
+ */
+static void
+NTC_K(vResToTempArray) (const double dR[], double dT[], size_t xCount,
+                        const double a[4]) {
+
+  NTC_K(vResToTempLoop) (dR, dT, xCount, a, eNtcFormExtended);
+}
+
+static void
+NTC_K(vResToTempArrayStd) (const double dR[], double dT[], size_t xCount,
+                           const double a[4]) {
+
+  NTC_K(vResToTempLoop) (dR, dT, xCount, a, eNtcFormStandard);
+}
+
+static void
+NTC_K(vResToTempArraySim) (const double dR[], double dT[], size_t xCount,
+                           const double a[4]) {
+
+  NTC_K(vResToTempLoop) (dR, dT, xCount, a, eNtcFormSimplified);
+}
+
+/*
+ * Batch conversion from resistance to temperature, each value with its own
+ * coefficients (structure of arrays a[0..3][i]).
+ */
+static void
+NTC_K(vResToTempArraySoa) (const double dR[], double dT[], size_t xCount,
+                           const double * const a[4]) {
+  VD r, x, a0, a1, a2, a3;
+  size_t i;
+
+  for (i = 0; i + VLEN <= xCount; i += VLEN) {
+
+    memcpy (&r, &dR[i], sizeof (r));
+    memcpy (&a0, &a[0][i], sizeof (a0));
+    memcpy (&a1, &a[1][i], sizeof (a1));
+    memcpy (&a2, &a[2][i], sizeof (a2));
+    memcpy (&a3, &a[3][i], sizeof (a3));
+    x = NTC_K(vLog) (r);
+    x = ((a3 * x + a2) * x + a1) * x + a0;
+    r = 1.0 / x + TABS;
+    memcpy (&dT[i], &r, sizeof (r));
+  }
+  for (; i < xCount; i++) {
+    double c[4] = { a[0][i], a[1][i], a[2][i], a[3][i] };
+
+    NTC_K(vResToTempArray) (&dR[i], &dT[i], 1, c);
+  }
+}
+
+/*
+ * Resistance for temperatures t (in degree Celsius), same algorithm as
+ * lnres() in ntc.c: quadratic seed then Newton steps on the polynom of the
+ * form, ln r solved directly for the simplified form.
+ */
+static inline __attribute__ ((always_inline)) VD
+NTC_K(vTempToRes) (VD t, const xNtcModel * m, eNtcForm form) {
+  VD x, y, u, f, fp;
+  int i;
+
+  y = 1.0 / (t - TABS);
+  if (form == eNtcFormSimplified) {
+
+    return NTC_K(vExp) ((y - m->dA[0]) / m->dA[1]);
+  }
+  u = y - m->dSeedY;
+  x = m->dSeed[0] + u * (m->dSeed[1] + u * m->dSeed[2]);
+  for (i = 0; i < NTC_NEWTON_STEPS; i++) {
+
+    if (form == eNtcFormStandard) {
+
+      f  = (m->dA[3] * x * x + m->dA[1]) * x + m->dA[0] - y;
+      fp = 3.0 * m->dA[3] * x * x + m->dA[1];
+    }
+    else {
+
+      f  = ((m->dA[3] * x + m->dA[2]) * x + m->dA[1]) * x + m->dA[0] - y;
+      fp = (3.0 * m->dA[3] * x + 2.0 * m->dA[2]) * x + m->dA[1];
+    }
+    x -= f / fp;
+  }
+  return NTC_K(vExp) (x);
+}
+
+/*
+ * Batch conversion from temperature to resistance with the polynom of a form.
+ */
+static inline __attribute__ ((always_inline)) void
+NTC_K(vTempToResLoop) (const xNtcModel * m, const double dT[], double dR[],
+                       size_t xCount, eNtcForm form) {
+  VD t;
+  size_t i;
+
+  for (i = 0; i + VLEN <= xCount; i += VLEN) {
+
+    memcpy (&t, &dT[i], sizeof (t));
+    t = NTC_K(vTempToRes) (t, m, form);
+    memcpy (&dR[i], &t, sizeof (t));
+  }
+  if (i < xCount) {
+    double buf[VLEN];
+    size_t j;
+
+    for (j = 0; j < VLEN; j++) {
+
+      buf[j] = (i + j < xCount) ? dT[i + j] : 25.0;
+    }
+    memcpy (&t, buf, sizeof (t));
+    t = NTC_K(vTempToRes) (t, m, form);
+    memcpy (&dR[i], &t, (xCount - i) * sizeof (double));
+  }
+}
+
+/*
+ * Batch conversion from temperature to resistance, the form of the model
+ * selects the loop.
+ */
+static void
+NTC_K(vTempToResArray) (const xNtcModel * m, const double dT[], double dR[],
+                        size_t xCount) {
+
+  switch (m->eForm) {
+    case eNtcFormSimplified:
+      NTC_K(vTempToResLoop) (m, dT, dR, xCount, eNtcFormSimplified);
+      break;
+    case eNtcFormStandard:
+      NTC_K(vTempToResLoop) (m, dT, dR, xCount, eNtcFormStandard);
+      break;
+    default:
+      NTC_K(vTempToResLoop) (m, dT, dR, xCount, eNtcFormExtended);
+      break;
+  }
+}
+
+/*
+ * Single precision natural logarithm of each element of x, same algorithm
+ * as flog() in ntc.c: x = 2^k * (1 + f) with sqrt(2)/2 <= 1 + f < sqrt(2),
+ * log(1 + f) by the Cephes polynom, less than 2 ulp.
+ */
+static inline VF
+NTC_K(vLogf) (VF x) {
+  VI ix, k;
+  VF f, z, y, fk;
+
+  ix = (VI) x;
+  ix += 0x3f800000 - 0x3f3504f3;
+  k = (ix >> 23) - 127;
+  ix = (ix & 0x007fffff) + 0x3f3504f3;
+  f = (VF) ix - 1.0f;
+  fk = __builtin_convertvector (k, VF);
+
+  z = f * f;
+  y = 7.0376836292e-2f * f - 1.1514610310e-1f;
+  y = y * f + 1.1676998740e-1f;
+  y = y * f - 1.2420140846e-1f;
+  y = y * f + 1.4249322787e-1f;
+  y = y * f - 1.6668057665e-1f;
+  y = y * f + 2.0000714765e-1f;
+  y = y * f - 2.4999993993e-1f;
+  y = y * f + 3.3333331174e-1f;
+  y = f * z * y + fk * -2.12194440e-4f - 0.5f * z;
+  return f + y + fk * 0.693359375f;
+}
+
+/*
+ * Single precision exponential of each element of x, same algorithm as
+ * fexp() in ntc.c: x = k ln2 + r with |r| <= ln2/2, exp(r) by the Cephes
+ * polynom, then scaling by 2^k on the exponent, less than 2 ulp for
+ * |x| < 87.
+ */
+static inline VF
+NTC_K(vExpf) (VF x) {
+  VI ki;
+  VF k, r, z, y;
+
+  /* k = round (x / ln2), its low bits are kept in ki */
+  k = x * 1.44269504088896341f + 12582912.0f;
+  ki = (VI) k;
+  k -= 12582912.0f;
+  r = x - k * 0.693359375f - k * -2.12194440e-4f;
+  z = r * r;
+  y = 1.9875691500e-4f * r + 1.3981999507e-3f;
+  y = y * r + 8.3334519073e-3f;
+  y = y * r + 4.1665795894e-2f;
+  y = y * r + 1.6666665459e-1f;
+  y = y * r + 5.0000001201e-1f;
+  y = y * z + r + 1.0f;
+  return (VF) ((VI) y + (ki << 23));
+}
+
+/*
+ * Single precision Steinhart-Hart temperature for resistances r.
+ */
+static inline VF
+NTC_K(vResToTempf) (VF r, const float a[4]) {
+  VF x;
+
+  x = NTC_K(vLogf) (r);
+  x = ((a[3] * x + a[2]) * x + a[1]) * x + a[0];
+  return 1.0f / x + (float) TABS;
+}
+
+/*
+ * Batch conversion from resistance to temperature in single precision.
+ */
+static void
+NTC_K(vResToTempArrayf) (const float fR[], float fT[], size_t xCount,
+                         const double dCoeff[4]) {
+  const float a[4] = {
+    (float) dCoeff[0], (float) dCoeff[1], (float) dCoeff[2], (float) dCoeff[3]
+  };
+  VF r;
+  size_t i;
+
+  for (i = 0; i + VFLEN <= xCount; i += VFLEN) {
+
+    memcpy (&r, &fR[i], sizeof (r));
+    r = NTC_K(vResToTempf) (r, a);
+    memcpy (&fT[i], &r, sizeof (r));
+  }
+  if (i < xCount) {
+    float buf[VFLEN];
+    size_t j;
+
+    for (j = 0; j < VFLEN; j++) {
+
+      buf[j] = (i + j < xCount) ? fR[i + j] : 1.0f;
+    }
+    memcpy (&r, buf, sizeof (r));
+    r = NTC_K(vResToTempf) (r, a);
+    memcpy (&fT[i], &r, (xCount - i) * sizeof (float));
+  }
+}
+
+/*
+ * Single precision resistance for temperatures t, same algorithm as
+ * vTempToRes() with the terms of the model rounded to float.
+ */
+static inline VF
+NTC_K(vTempToResf) (VF t, const float a[4], const float s[4]) {
+  VF x, y, u, f, fp;
+  int i;
+
+  y = 1.0f / (t - (float) TABS);
+  u = y - s[3];
+  x = s[0] + u * (s[1] + u * s[2]);
+  for (i = 0; i < NTC_NEWTON_STEPS; i++) {
+
+    f  = ((a[3] * x + a[2]) * x + a[1]) * x + a[0] - y;
+    fp = (3.0f * a[3] * x + 2.0f * a[2]) * x + a[1];
+    x -= f / fp;
+  }
+  return NTC_K(vExpf) (x);
+}
+
+/*
+ * Batch conversion from temperature to resistance in single precision.
+ */
+static void
+NTC_K(vTempToResArrayf) (const xNtcModel * m, const float fT[], float fR[],
+                         size_t xCount) {
+  const float a[4] = {
+    (float) m->dA[0], (float) m->dA[1], (float) m->dA[2], (float) m->dA[3]
+  };
+  const float s[4] = {
+    (float) m->dSeed[0], (float) m->dSeed[1], (float) m->dSeed[2],
+    (float) m->dSeedY
+  };
+  VF t;
+  size_t i;
+
+  for (i = 0; i + VFLEN <= xCount; i += VFLEN) {
+
+    memcpy (&t, &fT[i], sizeof (t));
+    t = NTC_K(vTempToResf) (t, a, s);
+    memcpy (&fR[i], &t, sizeof (t));
+  }
+  if (i < xCount) {
+    float buf[VFLEN];
+    size_t j;
+
+    for (j = 0; j < VFLEN; j++) {
+
+      buf[j] = (i + j < xCount) ? fT[i + j] : 25.0f;
+    }
+    memcpy (&t, buf, sizeof (t));
+    t = NTC_K(vTempToResf) (t, a, s);
+    memcpy (&fR[i], &t, (xCount - i) * sizeof (float));
+  }
+}
+
+/* ========================================================================== */
+#undef VFLEN
+#undef VLEN
+#undef VI
+#undef VF
+#undef VU
+#undef VD
+#undef NTC_K
+#undef NTC_KCAT
+#undef NTC_KCAT2
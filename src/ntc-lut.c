@@ -0,0 +1,280 @@
+/**
+ * @file ntc-lut.c
+ * @brief NTC thermistor library (ADC lookup tables, implementation)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#include <stdlib.h>
+#include <math.h>
+#include "ntc-lut.h"
+
+/* structures =============================================================== */
+struct xNtcLut {
+  xNtcAdcConfig xConfig;
+  double dCoeff[4];
+  unsigned uMask;
+  double * dTable;    /* double table or NULL */
+  int16_t * iTable;   /* fixed point table or NULL */
+};
+
+/* private functions ======================================================== */
+/*
+ * Rounds a temperature to fixed point with saturation.
+ */
+static int16_t
+fixed (double t) {
+
+  if (isnan (t)) {
+    return NTC_LUT_INVALID;
+  }
+  t = floor (t * NTC_LUT_FIXED_SCALE + 0.5);
+  if (t > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (t < INT16_MIN + 1) {
+    return INT16_MIN + 1;
+  }
+  return (int16_t) t;
+}
+
+/* internal public functions ================================================ */
+// -----------------------------------------------------------------------------
+double
+dNtcAdcCodeToRes (const xNtcAdcConfig * xConfig, double dCode) {
+  double k, vs;
+
+  vs = (xConfig->dVsupply > 0.0) ? xConfig->dVsupply : xConfig->dVref;
+  k = (dCode + 0.5) / (double) (1UL << xConfig->iBits) * xConfig->dVref / vs;
+  if ( (k <= 0.0) || (k >= 1.0)) {
+
+    return NAN;
+  }
+  if (xConfig->eDivider == eNtcPullUp) {
+
+    return xConfig->dSeries * k / (1.0 - k);
+  }
+  return xConfig->dSeries * (1.0 - k) / k;
+}
+
+// -----------------------------------------------------------------------------
+xNtcLut *
+xNtcLutNew (const xNtcAdcConfig * xConfig, const double dCoeff[4],
+            int bFixed) {
+  xNtcLut * xLut;
+  double * t;
+  unsigned i, n;
+
+  if ( (xConfig->iBits < 1) || (xConfig->iBits > 16) ||
+       (xConfig->dSeries <= 0.0) || (xConfig->dVref <= 0.0)) {
+
+    return NULL;
+  }
+  n = 1U << xConfig->iBits;
+  xLut = calloc (1, sizeof (xNtcLut));
+  t = malloc (n * sizeof (double));
+  if ( (xLut == NULL) || (t == NULL)) {
+
+    goto error;
+  }
+  xLut->xConfig = *xConfig;
+  xLut->uMask = n - 1;
+  for (i = 0; i < 4; i++) {
+
+    xLut->dCoeff[i] = dCoeff[i];
+  }
+
+  for (i = 0; i < n; i++) {
+
+    t[i] = dNtcAdcCodeToRes (xConfig, i);
+  }
+  vNtcResToTempArray (t, t, n, dCoeff);
+  for (i = 0; i < n; i++) {
+
+    if (isnan (dNtcAdcCodeToRes (xConfig, i))) {
+      t[i] = NAN;
+    }
+  }
+
+  if (bFixed) {
+
+    xLut->iTable = malloc (n * sizeof (int16_t));
+    if (xLut->iTable == NULL) {
+
+      goto error;
+    }
+    for (i = 0; i < n; i++) {
+
+      xLut->iTable[i] = fixed (t[i]);
+    }
+    free (t);
+  }
+  else {
+
+    xLut->dTable = t;
+  }
+  return xLut;
+
+error:
+  free (t);
+  free (xLut);
+  return NULL;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcLutDelete (xNtcLut * xLut) {
+
+  if (xLut) {
+
+    free (xLut->dTable);
+    free (xLut->iTable);
+    free (xLut);
+  }
+}
+
+// -----------------------------------------------------------------------------
+unsigned
+uNtcLutSize (const xNtcLut * xLut) {
+
+  return xLut->uMask + 1;
+}
+
+// -----------------------------------------------------------------------------
+double
+dNtcLutCodeToTemp (const xNtcLut * xLut, unsigned uCode) {
+
+  if (xLut->dTable) {
+
+    return xLut->dTable[uCode & xLut->uMask];
+  }
+  else {
+    int16_t t = xLut->iTable[uCode & xLut->uMask];
+
+    return (t == NTC_LUT_INVALID) ? NAN : (double) t / NTC_LUT_FIXED_SCALE;
+  }
+}
+
+// -----------------------------------------------------------------------------
+int16_t
+iNtcLutCodeToTempFixed (const xNtcLut * xLut, unsigned uCode) {
+
+  if (xLut->iTable) {
+
+    return xLut->iTable[uCode & xLut->uMask];
+  }
+  return fixed (xLut->dTable[uCode & xLut->uMask]);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcLutCodeToTempArray (const xNtcLut * xLut, const uint16_t uCode[],
+                        double dT[], size_t xCount) {
+  const unsigned mask = xLut->uMask;
+  size_t i;
+
+  if (xLut->dTable) {
+    const double * table = xLut->dTable;
+
+    for (i = 0; i < xCount; i++) {
+
+      dT[i] = table[uCode[i] & mask];
+    }
+  }
+  else {
+
+    for (i = 0; i < xCount; i++) {
+
+      dT[i] = dNtcLutCodeToTemp (xLut, uCode[i]);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcLutCodeToTempFixedArray (const xNtcLut * xLut, const uint16_t uCode[],
+                             int16_t iT[], size_t xCount) {
+  const unsigned mask = xLut->uMask;
+  size_t i;
+
+  if (xLut->iTable) {
+    const int16_t * table = xLut->iTable;
+
+    for (i = 0; i < xCount; i++) {
+
+      iT[i] = table[uCode[i] & mask];
+    }
+  }
+  else {
+
+    for (i = 0; i < xCount; i++) {
+
+      iT[i] = iNtcLutCodeToTempFixed (xLut, uCode[i]);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcLutError (const xNtcLut * xLut, double dTmin, double dTmax,
+              xNtcLutError * xError) {
+  double t, r, e, err, sum = 0.0;
+  unsigned c, j;
+
+  xError->dMaxError = 0.0;
+  xError->dMeanError = 0.0;
+  xError->uMaxCode = 0;
+  xError->uCodes = 0;
+  for (c = 0; c <= xLut->uMask; c++) {
+
+    t = dNtcLutCodeToTemp (xLut, c);
+    if (isnan (t) || (t < dTmin) || (t > dTmax)) {
+      continue;
+    }
+    /* edges of the quantization step of code c */
+    err = 0.0;
+    for (j = 0; j < 2; j++) {
+
+      r = dNtcAdcCodeToRes (&xLut->xConfig, c - 0.5 + j);
+      if (isnan (r)) {
+        continue;
+      }
+      e = fabs (t - dNtcResToTemp (r, (double *) xLut->dCoeff));
+      if (e > err) {
+        err = e;
+      }
+    }
+    if (err > xError->dMaxError) {
+
+      xError->dMaxError = err;
+      xError->uMaxCode = c;
+    }
+    sum += err;
+    xError->uCodes++;
+  }
+  if (xError->uCodes == 0) {
+
+    return -1;
+  }
+  xError->dMeanError = sum / xError->uCodes;
+  return 0;
+}
+
+/* ========================================================================== */
@@ -0,0 +1,170 @@
+/**
+ * @file ntc-lut.h
+ * @brief NTC thermistor library (ADC lookup tables)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#ifndef _NTC_LUT_H_
+#define _NTC_LUT_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ========================================================================== */
+#include <stdint.h>
+#include "ntc.h"
+
+/* constants ================================================================ */
+/** Fixed point temperature for codes without valid resistance */
+#define NTC_LUT_INVALID INT16_MIN
+
+/** Number of fixed point temperature units in one degree Celsius */
+#define NTC_LUT_FIXED_SCALE 100
+
+/**
+ * Position of the series resistor of the voltage divider
+ */
+typedef enum {
+  eNtcPullUp = 0,   /**< series resistor to supply, thermistor to ground */
+  eNtcPullDown = 1  /**< thermistor to supply, series resistor to ground */
+} eNtcDivider;
+
+/* structures =============================================================== */
+/**
+ * Voltage divider and ADC measuring the thermistor
+ */
+typedef struct xNtcAdcConfig {
+  double dSeries;         /**< series resistor (in Ohm) */
+  double dVref;           /**< ADC reference voltage (full scale) */
+  double dVsupply;        /**< divider supply voltage, 0 if equal to dVref */
+  int iBits;              /**< ADC resolution in bits, 1 to 16 */
+  eNtcDivider eDivider;   /**< position of the series resistor */
+} xNtcAdcConfig;
+
+/**
+ * Error of a lookup table relative to the Steinhart-Hart polynom
+ */
+typedef struct xNtcLutError {
+  double dMaxError;   /**< maximal error (in degree Celsius) */
+  double dMeanError;  /**< mean error (in degree Celsius) */
+  unsigned uMaxCode;  /**< code where dMaxError is reached */
+  unsigned uCodes;    /**< number of codes checked */
+} xNtcLutError;
+
+/**
+ * ADC lookup table (opaque)
+ */
+typedef struct xNtcLut xNtcLut;
+
+/* internal public functions ================================================ */
+/**
+ * Resistance of the thermistor for an ADC code
+ * The code is taken at the center of its quantization step.
+ * @param xConfig divider and ADC configuration
+ * @param dCode ADC code, may be fractional
+ * @return resistance (in Ohm), NaN if the code is outside the divider range
+ */
+double dNtcAdcCodeToRes (const xNtcAdcConfig * xConfig, double dCode);
+
+/**
+ * Create a lookup table holding one temperature per ADC code
+ * The temperatures are computed with vNtcResToTempArray(). A fixed point
+ * table holds int16_t in 1/NTC_LUT_FIXED_SCALE degree Celsius (saturated)
+ * and takes a quarter of the memory of a double table.
+ * @param xConfig divider and ADC configuration
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @param bFixed true for a fixed point table, false for a double table
+ * @return the table, NULL on error. Must be released with vNtcLutDelete()
+ */
+xNtcLut * xNtcLutNew (const xNtcAdcConfig * xConfig, const double dCoeff[4],
+                      int bFixed);
+
+/**
+ * Release a lookup table
+ * @param xLut table to release, may be NULL
+ */
+void vNtcLutDelete (xNtcLut * xLut);
+
+/**
+ * Number of entries of a lookup table (2^iBits)
+ * @param xLut lookup table
+ * @return number of codes
+ */
+unsigned uNtcLutSize (const xNtcLut * xLut);
+
+/**
+ * Conversion from ADC code to temperature
+ * Bits of uCode above the ADC resolution are ignored.
+ * @param xLut lookup table
+ * @param uCode ADC code
+ * @return temperature (in degree Celsius), NaN for an invalid code
+ */
+double dNtcLutCodeToTemp (const xNtcLut * xLut, unsigned uCode);
+
+/**
+ * Conversion from ADC code to fixed point temperature
+ * Bits of uCode above the ADC resolution are ignored.
+ * @param xLut lookup table
+ * @param uCode ADC code
+ * @return temperature (in 1/NTC_LUT_FIXED_SCALE degree Celsius),
+ * NTC_LUT_INVALID for an invalid code
+ */
+int16_t iNtcLutCodeToTempFixed (const xNtcLut * xLut, unsigned uCode);
+
+/**
+ * Conversion from ADC codes to temperatures of an array
+ * @param xLut lookup table
+ * @param uCode ADC codes
+ * @param dT corresponding temperatures (in degree Celsius)
+ * @param xCount number of values to convert
+ */
+void vNtcLutCodeToTempArray (const xNtcLut * xLut, const uint16_t uCode[],
+                             double dT[], size_t xCount);
+
+/**
+ * Conversion from ADC codes to fixed point temperatures of an array
+ * @param xLut lookup table
+ * @param uCode ADC codes
+ * @param iT corresponding temperatures (in 1/NTC_LUT_FIXED_SCALE degree Celsius)
+ * @param xCount number of values to convert
+ */
+void vNtcLutCodeToTempFixedArray (const xNtcLut * xLut, const uint16_t uCode[],
+                                  int16_t iT[], size_t xCount);
+
+/**
+ * Error of a lookup table relative to the Steinhart-Hart polynom
+ * For each code whose temperature lies in [dTmin, dTmax], the table value is
+ * compared with the exact temperature at both edges of the quantization
+ * step, so the result includes the quantization of the ADC and, for a fixed
+ * point table, the rounding of the temperature.
+ * @param xLut lookup table
+ * @param dTmin minimal temperature of interest (in degree Celsius)
+ * @param dTmax maximal temperature of interest (in degree Celsius)
+ * @param xError error report
+ * @return 0, -1 if no code lies in the range
+ */
+int iNtcLutError (const xNtcLut * xLut, double dTmin, double dTmax,
+                  xNtcLutError * xError);
+
+/* ========================================================================== */
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NTC_LUT_H_ defined */
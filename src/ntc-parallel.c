@@ -0,0 +1,376 @@
+/**
+ * @file ntc-parallel.c
+ * @brief NTC thermistor library (parallel batch conversions)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include "ntc-parallel.h"
+
+/* constants ================================================================ */
+/* Minimal number of values converted by a thread */
+#define MIN_CHUNK 65536
+/* Chunks are multiple of this number of values (cache line of floats) */
+#define ALIGN 64
+/* Maximal number of threads */
+#define MAX_THREADS 256
+
+/* structures =============================================================== */
+typedef enum {
+  eResToTemp,
+  eResToTempf,
+  eTempToRes,
+  eTouch
+} eJob;
+
+typedef struct xJob {
+  eJob eKind;
+  const void * pvIn;
+  void * pvOut;
+  size_t xCount;
+  size_t xSize;           /* size of an element */
+  const double * dCoeff;
+  const xNtcModel * xModel;
+  int iThreads;
+} xJob;
+
+/*
+ * Persistent workers: worker i (1 to iWorkers) converts the chunk i of
+ * each job whose number of threads is above i, the calling thread the
+ * chunk 0. A job is started by incrementing uGeneration. The job is
+ * copied in the pool so that a worker woken late never reads the stack of
+ * a returned caller. The pool is not inherited by a forked child, which
+ * starts its own workers.
+ */
+typedef struct xPool {
+  pthread_mutex_t xRun;   /* held by the thread running a job */
+  pthread_mutex_t xLock;  /* protects the fields below */
+  pthread_cond_t xStart;
+  pthread_cond_t xDone;
+  xJob xJob;              /* current job */
+  unsigned uGeneration;
+  int iPending;           /* workers converting the current job */
+  int iWorkers;           /* workers started */
+  unsigned uBorn[MAX_THREADS]; /* generation when each worker was started */
+} xPool;
+
+/* private variables ======================================================== */
+/* Number of threads set by the user, 0 for the number of processors */
+static int iCount;
+
+static xPool xThePool = {
+  PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+  PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, { 0 }, 0, 0, 0, { 0 }
+};
+
+/* private functions ======================================================== */
+/*
+ * Number of threads of a job of xCount values.
+ */
+static int
+threads (size_t xCount) {
+  size_t n;
+
+  n = (size_t) __atomic_load_n (&iCount, __ATOMIC_RELAXED);
+  n = (n > 0) ? n : (size_t) sysconf (_SC_NPROCESSORS_ONLN);
+  if (n > xCount / MIN_CHUNK) {
+    n = xCount / MIN_CHUNK;
+  }
+  if (n > MAX_THREADS) {
+    n = MAX_THREADS;
+  }
+  return (n < 1) ? 1 : (int) n;
+}
+
+/*
+ * Converts the chunk i of a job.
+ */
+static void
+work (const xJob * j, int i) {
+  size_t lo, hi, chunk;
+
+  chunk = (j->xCount + j->iThreads - 1) / j->iThreads;
+  chunk = (chunk + ALIGN - 1) / ALIGN * ALIGN;
+  lo = chunk * i;
+  hi = lo + chunk;
+  hi = (hi > j->xCount) ? j->xCount : hi;
+  if (lo >= hi) {
+    return;
+  }
+
+  switch (j->eKind) {
+    case eResToTemp:
+      vNtcResToTempArray ( (const double *) j->pvIn + lo,
+                           (double *) j->pvOut + lo, hi - lo, j->dCoeff);
+      break;
+    case eResToTempf:
+      vNtcResToTempArrayf ( (const float *) j->pvIn + lo,
+                            (float *) j->pvOut + lo, hi - lo, j->dCoeff);
+      break;
+    case eTempToRes:
+      vNtcModelTempToResArray (j->xModel, (const double *) j->pvIn + lo,
+                               (double *) j->pvOut + lo, hi - lo);
+      break;
+    case eTouch:
+      memset ( (char *) j->pvOut + lo * j->xSize, 0, (hi - lo) * j->xSize);
+      break;
+  }
+}
+
+/*
+ * Loop of a worker, waits for the jobs and converts its chunk.
+ */
+static void *
+worker (void * arg) {
+  int i = (int) (intptr_t) arg;
+  xPool * p = &xThePool;
+  unsigned gen;
+  xJob j;
+
+  pthread_mutex_lock (&p->xLock);
+  gen = p->uBorn[i];
+  for (;;) {
+
+    while (p->uGeneration == gen) {
+
+      pthread_cond_wait (&p->xStart, &p->xLock);
+    }
+    gen = p->uGeneration;
+    j = p->xJob;
+    if (i < j.iThreads) {
+
+      pthread_mutex_unlock (&p->xLock);
+      work (&j, i);
+      pthread_mutex_lock (&p->xLock);
+      if (--p->iPending == 0) {
+
+        pthread_cond_signal (&p->xDone);
+      }
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Prepares a fork: waits for the current job, so that the pool is idle.
+ */
+static void
+prefork (void) {
+
+  pthread_mutex_lock (&xThePool.xRun);
+}
+
+/*
+ * Releases the pool in the parent after a fork.
+ */
+static void
+parent (void) {
+
+  pthread_mutex_unlock (&xThePool.xRun);
+}
+
+/*
+ * Resets the pool in a forked child: the workers were not copied, the
+ * next job starts new ones.
+ */
+static void
+child (void) {
+  xPool * p = &xThePool;
+
+  pthread_mutex_init (&p->xRun, NULL);
+  pthread_mutex_init (&p->xLock, NULL);
+  pthread_cond_init (&p->xStart, NULL);
+  pthread_cond_init (&p->xDone, NULL);
+  p->iPending = 0;
+  p->iWorkers = 0;
+}
+
+/*
+ * Registers the fork handlers, once.
+ */
+static void
+atfork (void) {
+
+  pthread_atfork (prefork, parent, child);
+}
+
+/*
+ * Starts workers up to iThreads - 1, each one pinned to a processor of
+ * the process so that the pages it touches first stay on its node.
+ * Called with xRun held.
+ * @return number of workers started.
+ */
+static int
+grow (int iThreads) {
+  xPool * p = &xThePool;
+  pthread_attr_t attr;
+  pthread_t tid;
+  cpu_set_t cpus, one;
+  int i, k, n, ncpu;
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+  if (p->iWorkers >= iThreads - 1) {
+
+    return p->iWorkers;
+  }
+  pthread_once (&once, atfork);
+  ncpu = (sched_getaffinity (0, sizeof (cpus), &cpus) == 0) ?
+         CPU_COUNT (&cpus) : 0;
+  pthread_attr_init (&attr);
+  pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+  for (i = p->iWorkers + 1; i < iThreads; i++) {
+
+    /* worker i on the i-th processor, the caller is not pinned */
+    CPU_ZERO (&one);
+    for (k = 0, n = 0; (ncpu > 0) && (k < CPU_SETSIZE); k++) {
+
+      if (CPU_ISSET (k, &cpus) && (n++ == i % ncpu)) {
+
+        CPU_SET (k, &one);
+        break;
+      }
+    }
+    if ( (ncpu >= iThreads) && CPU_COUNT (&one)) {
+
+      pthread_attr_setaffinity_np (&attr, sizeof (one), &one);
+    }
+    p->uBorn[i] = p->uGeneration;
+    if (pthread_create (&tid, &attr, worker, (void *) (intptr_t) i) != 0) {
+
+      break;
+    }
+    pthread_mutex_lock (&p->xLock);
+    p->iWorkers = i;
+    pthread_mutex_unlock (&p->xLock);
+  }
+  pthread_attr_destroy (&attr);
+  return p->iWorkers;
+}
+
+/*
+ * Runs a job with the workers, the calling thread converts the first
+ * chunk. A job started while another one runs is converted by the calling
+ * thread alone.
+ */
+static void
+run (xJob * j) {
+  xPool * p = &xThePool;
+  int n;
+
+  j->iThreads = threads (j->xCount);
+  if ( (j->iThreads == 1) || (pthread_mutex_trylock (&p->xRun) != 0)) {
+
+    j->iThreads = 1;
+    work (j, 0);
+    return;
+  }
+  n = grow (j->iThreads) + 1;
+  j->iThreads = (j->iThreads > n) ? n : j->iThreads;
+
+  pthread_mutex_lock (&p->xLock);
+  p->xJob = *j;
+  p->iPending = j->iThreads - 1;
+  p->uGeneration++;
+  pthread_cond_broadcast (&p->xStart);
+  pthread_mutex_unlock (&p->xLock);
+
+  work (j, 0);
+
+  pthread_mutex_lock (&p->xLock);
+  while (p->iPending > 0) {
+
+    pthread_cond_wait (&p->xDone, &p->xLock);
+  }
+  pthread_mutex_unlock (&p->xLock);
+  pthread_mutex_unlock (&p->xRun);
+}
+
+/* internal public functions ================================================ */
+// -----------------------------------------------------------------------------
+int
+iNtcParallelSetThreads (int iThreads) {
+
+  if (iThreads < 0) {
+
+    return -1;
+  }
+  __atomic_store_n (&iCount, iThreads, __ATOMIC_RELAXED);
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcParallelThreads (void) {
+
+  return threads ( (size_t) -1);
+}
+
+// -----------------------------------------------------------------------------
+void *
+pvNtcParallelAlloc (size_t xCount, size_t xSize) {
+  xJob j = { eTouch, NULL, NULL, xCount, xSize, NULL, NULL, 0 };
+
+  if ( (xSize != 0) && (xCount > (size_t) -1 / xSize)) {
+
+    return NULL;
+  }
+  if (posix_memalign (&j.pvOut, 4096, xCount * xSize) != 0) {
+
+    return NULL;
+  }
+  run (&j);
+  return j.pvOut;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcParallelResToTempArray (const double dR[], double dT[], size_t xCount,
+                            const double dCoeff[4]) {
+  xJob j = { eResToTemp, dR, dT, xCount, sizeof (double), dCoeff, NULL, 0 };
+
+  run (&j);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcParallelResToTempArrayf (const float fR[], float fT[], size_t xCount,
+                             const double dCoeff[4]) {
+  xJob j = { eResToTempf, fR, fT, xCount, sizeof (float), dCoeff, NULL, 0 };
+
+  run (&j);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcParallelTempToResArray (const xNtcModel * xModel, const double dT[],
+                            double dR[], size_t xCount) {
+  xJob j = { eTempToRes, dT, dR, xCount, sizeof (double), NULL, xModel, 0 };
+
+  run (&j);
+}
+
+/* ========================================================================== */
@@ -0,0 +1,107 @@
+/**
+ * @file ntc-parallel.h
+ * @brief NTC thermistor library (parallel batch conversions)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#ifndef _NTC_PARALLEL_H_
+#define _NTC_PARALLEL_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ========================================================================== */
+#include "ntc.h"
+
+/* internal public functions ================================================ */
+/**
+ * Set the number of threads of the parallel conversions
+ * @param iThreads number of threads, 0 for the number of online processors
+ * (default)
+ * @return 0, -1 if iThreads is negative
+ */
+int iNtcParallelSetThreads (int iThreads);
+
+/**
+ * Number of threads of the parallel conversions
+ * @return number of threads used by a large conversion
+ */
+int iNtcParallelThreads (void);
+
+/**
+ * Allocate an array for the parallel conversions
+ * The array is split between the threads as the conversions do and each
+ * thread writes its part first, so that on a NUMA system the pages are
+ * placed on the node of the thread that converts them (first touch). This
+ * holds as long as the workers are pinned, see vNtcParallelResToTempArray().
+ * @param xCount number of elements
+ * @param xSize size of an element
+ * @return array initialized to zero, NULL on error. Must be released with
+ * free()
+ */
+void * pvNtcParallelAlloc (size_t xCount, size_t xSize);
+
+/**
+ * Parallel conversion from resistance to temperature of an array
+ * The array is split into one contiguous chunk per thread (static
+ * chunking), each chunk is converted by vNtcResToTempArray() with the
+ * kernel selected for the host. Small arrays use less threads.
+ * The chunks are converted by a pool of workers started by the first
+ * conversion and kept for the next ones, the calling thread converts the
+ * first chunk. When the process may run on enough processors, each worker
+ * is pinned to its own processor. A conversion started while another one
+ * runs is done by the calling thread alone. The workers are not inherited
+ * by a forked child: fork() waits for the current conversion and the
+ * child starts new workers at its first conversion.
+ * @param dR resistances (in Ohm), must be positive normal numbers
+ * @param dT corresponding temperatures (in degree Celsius), may be dR
+ * @param xCount number of values to convert
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ */
+void vNtcParallelResToTempArray (const double dR[], double dT[],
+                                 size_t xCount, const double dCoeff[4]);
+
+/**
+ * Parallel single precision conversion from resistance to temperature
+ * Same as vNtcParallelResToTempArray() with vNtcResToTempArrayf().
+ * @param fR resistances (in Ohm), must be positive normal numbers
+ * @param fT corresponding temperatures (in degree Celsius), may be fR
+ * @param xCount number of values to convert
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ */
+void vNtcParallelResToTempArrayf (const float fR[], float fT[],
+                                  size_t xCount, const double dCoeff[4]);
+
+/**
+ * Parallel conversion from temperature to resistance with a model
+ * Same as vNtcParallelResToTempArray() with vNtcModelTempToResArray().
+ * @param xModel thermistor model
+ * @param dT temperatures (in degree Celsius), above absolute zero
+ * @param dR corresponding resistances (in Ohm), may be dT
+ * @param xCount number of values to convert
+ */
+void vNtcParallelTempToResArray (const xNtcModel * xModel, const double dT[],
+                                 double dR[], size_t xCount);
+
+/* ========================================================================== */
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NTC_PARALLEL_H_ defined */
@@ -0,0 +1,461 @@
+/**
+ * @file ntc-spline.c
+ * @brief NTC thermistor library (piecewise polynomials, implementation)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "ntc-spline.h"
+
+/* constants ================================================================ */
+/* Number of points where the error of a segment is checked when building */
+#define BUILD_POINTS 128
+/* Number of points per segment of the final verification */
+#define VERIFY_POINTS 1024
+/* Golden section steps on each local maximum of the final verification */
+#define VERIFY_STEPS 40
+/* Part of the requested error used when building */
+#define BUILD_MARGIN 0.98
+/* Bisection steps on the end of a segment */
+#define BISECTION_STEPS 48
+/* Maximal number of cells of the segment index */
+#define GRID_MAX 4096
+
+/* structures =============================================================== */
+struct xNtcSpline {
+  eNtcSplineVar eVar;
+  unsigned uCount;    /* number of segments */
+  double dUmin;       /* range of the variable */
+  double dUmax;
+  double dMaxError;   /* verified error */
+  double * dLeft;     /* left end of each segment, +inf after the last */
+  double * dPoly;     /* 3 coefficients per segment, in (u - left) */
+  uint16_t * uGrid;   /* first candidate segment for each cell of the range */
+  double dGridScale;  /* cells per unit of the variable */
+  unsigned uSteps;    /* forward steps from the candidate segment */
+  double dCoeff[4];
+};
+
+/* private functions ======================================================== */
+/*
+ * Variable of the segments for a resistance.
+ * For eNtcSplineLog2, r = 2^e * m with 1 <= m < 2 gives e + m - 1.
+ */
+static inline double
+var (eNtcSplineVar v, double r) {
+
+  if (v == eNtcSplineLog2) {
+    uint64_t i;
+    double m;
+
+    memcpy (&i, &r, sizeof (i));
+    r = (double) ( (int) (i >> 52) - 1023);
+    i = (i & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+    memcpy (&m, &i, sizeof (m));
+    return r + m - 1.0;
+  }
+  return r;
+}
+
+/*
+ * Resistance for a value of the variable, inverse of var().
+ */
+static double
+res (eNtcSplineVar v, double u) {
+
+  if (v == eNtcSplineLog2) {
+    double e = floor (u);
+
+    return ldexp (1.0 + u - e, (int) e);
+  }
+  return u;
+}
+
+/*
+ * Exact temperature for a value of the variable.
+ */
+static double
+temp (const xNtcSpline * s, double u) {
+
+  return dNtcResToTemp (res (s->eVar, u), (double *) s->dCoeff);
+}
+
+/*
+ * Polynom of degree iDegree interpolating the temperature at the Chebyshev
+ * nodes of [u0, u1], coefficients in (u - u0).
+ */
+static void
+fit (const xNtcSpline * s, int iDegree, double u0, double u1, double p[3]) {
+  double mid = 0.5 * (u0 + u1), half = 0.5 * (u1 - u0);
+  double x[3] = { 0 }, t[3] = { 0 }, d01, d12, d012;
+  int i;
+
+  for (i = 0; i <= iDegree; i++) {
+
+    x[i] = mid + half * cos ( (2 * i + 1) * M_PI / (2 * (iDegree + 1)));
+    t[i] = temp (s, x[i]);
+  }
+  d01 = (t[1] - t[0]) / (x[1] - x[0]);
+  if (iDegree == 1) {
+
+    p[2] = 0.0;
+    p[1] = d01;
+    p[0] = t[0] + d01 * (u0 - x[0]);
+    return;
+  }
+  d12 = (t[2] - t[1]) / (x[2] - x[1]);
+  d012 = (d12 - d01) / (x[2] - x[0]);
+  /* Newton form expanded around u0 */
+  x[0] -= u0;
+  x[1] -= u0;
+  p[2] = d012;
+  p[1] = d01 - (x[0] + x[1]) * d012;
+  p[0] = t[0] - x[0] * d01 + x[0] * x[1] * d012;
+}
+
+/*
+ * Error of a polynom at u0 + d.
+ */
+static inline double
+deviation (const xNtcSpline * s, double u0, const double p[3], double d) {
+
+  return fabs (p[0] + d * (p[1] + d * p[2]) - temp (s, u0 + d));
+}
+
+/*
+ * Maximal error of a polynom over [u0, u1] checked on n points.
+ */
+static double
+error (const xNtcSpline * s, double u0, double u1, const double p[3], int n) {
+  double e, err = 0.0;
+  int i;
+
+  for (i = 0; i <= n; i++) {
+
+    e = deviation (s, u0, p, (u1 - u0) * i / n);
+    if (e > err) {
+      err = e;
+    }
+  }
+  return err;
+}
+
+/*
+ * Maximal error of a polynom over [u0, u1]: each local maximum of the
+ * error on n points is refined by golden section search between its
+ * neighbours, so that the maxima between the points are not missed.
+ */
+static double
+maxerror (const xNtcSpline * s, double u0, double u1, const double p[3],
+          int n) {
+  const double g = 0.5 * (sqrt (5.0) - 1.0);
+  double h = (u1 - u0) / n, e0 = 0.0, e1 = 0.0, e2, err = 0.0;
+  double a, b, c, d, ec, ed;
+  int i, j;
+
+  for (i = 0; i <= n; i++) {
+
+    e2 = deviation (s, u0, p, h * i);
+    err = (e2 > err) ? e2 : err;
+    if ( (i >= 2) && (e1 >= e0) && (e1 >= e2)) {
+
+      a = h * (i - 2);
+      b = h * i;
+      c = b - g * (b - a);
+      d = a + g * (b - a);
+      ec = deviation (s, u0, p, c);
+      ed = deviation (s, u0, p, d);
+      for (j = 0; j < VERIFY_STEPS; j++) {
+
+        if (ec > ed) {
+          b = d;
+          d = c;
+          ed = ec;
+          c = b - g * (b - a);
+          ec = deviation (s, u0, p, c);
+        }
+        else {
+          a = c;
+          c = d;
+          ec = ed;
+          d = a + g * (b - a);
+          ed = deviation (s, u0, p, d);
+        }
+      }
+      err = (ec > err) ? ec : err;
+      err = (ed > err) ? ed : err;
+    }
+    e0 = e1;
+    e1 = e2;
+  }
+  return err;
+}
+
+/*
+ * Resizes an array of double, the array is left untouched on error.
+ */
+static int
+grow (double ** a, size_t n) {
+  double * p = realloc (*a, n * sizeof (double));
+
+  if (p == NULL) {
+
+    return -1;
+  }
+  *a = p;
+  return 0;
+}
+
+/*
+ * Builds the segment index: the range is divided in cells of equal width,
+ * each cell gives a candidate segment which is at most uSteps segments
+ * before the right one. The candidate is taken one segment early so that
+ * rounding of the cell number can never skip the right segment.
+ */
+static int
+buildindex (xNtcSpline * s) {
+  double w = s->dUmax - s->dUmin, wmin = w, edge;
+  unsigned g, c, j, k, n = s->uCount, steps;
+
+  for (k = 0; k < n; k++) {
+
+    edge = ( (k + 1 < n) ? s->dLeft[k + 1] : s->dUmax) - s->dLeft[k];
+    wmin = (edge < wmin) ? edge : wmin;
+  }
+  for (g = 1; (g < GRID_MAX) && (g * wmin < w); g *= 2)
+    ;
+  s->uGrid = malloc ( (g + 1) * sizeof (uint16_t));
+  if (s->uGrid == NULL) {
+
+    return -1;
+  }
+  s->dGridScale = g / w;
+  s->uSteps = 0;
+  for (c = 0, k = 0; c <= g; c++) {
+
+    edge = s->dUmin + c / s->dGridScale;
+    while ( (k + 1 < n) && (s->dLeft[k + 1] <= edge)) {
+      k++;
+    }
+    s->uGrid[c] = (k > 0) ? k - 1 : 0;
+    /* segments starting inside the cell */
+    edge = s->dUmin + (c + 1) / s->dGridScale;
+    for (j = k, steps = k - s->uGrid[c]; (j + 1 < n) && (s->dLeft[j + 1] < edge); j++) {
+      steps++;
+    }
+    s->uSteps = (steps > s->uSteps) ? steps : s->uSteps;
+  }
+  return 0;
+}
+
+/*
+ * Index of the segment of u, cell lookup followed by a fixed number of
+ * branchless forward steps.
+ */
+static inline unsigned
+segment (const xNtcSpline * s, double u) {
+  const double * left = s->dLeft;
+  unsigned k, i;
+
+  k = s->uGrid[(unsigned) ( (u - s->dUmin) * s->dGridScale)];
+  for (i = 0; i < s->uSteps; i++) {
+
+    k += (left[k + 1] <= u);
+  }
+  return k;
+}
+
+/*
+ * Temperature for a resistance, clamped to the range. A NaN is looked up
+ * as the minimum, so that the cell index stays in the grid, and gives NaN.
+ */
+static inline double
+eval (const xNtcSpline * s, double r) {
+  const double * p;
+  unsigned k;
+  double u;
+
+  u = var (s->eVar, r);
+  u = ! (u >= s->dUmin) ? s->dUmin : u;
+  u = (u > s->dUmax) ? s->dUmax : u;
+  k = segment (s, u);
+  p = &s->dPoly[3 * k];
+  u -= s->dLeft[k];
+  return isnan (r) ? r : p[0] + u * (p[1] + u * p[2]);
+}
+
+/* internal public functions ================================================ */
+// -----------------------------------------------------------------------------
+xNtcSpline *
+xNtcSplineNew (const double dCoeff[4], double dRmin, double dRmax,
+               double dMaxError, eNtcSplineVar eVar, int iDegree) {
+  xNtcSpline * s;
+  double u0, u1, lo, hi, p[3], target, err;
+  unsigned size = 64;
+  int i;
+
+  if ( (dRmin <= 0.0) || (dRmax <= dRmin) || (dMaxError <= 0.0) ||
+       (iDegree < 1) || (iDegree > 2)) {
+
+    return NULL;
+  }
+  s = calloc (1, sizeof (xNtcSpline));
+  if (s == NULL) {
+
+    return NULL;
+  }
+  s->eVar = eVar;
+  for (i = 0; i < 4; i++) {
+
+    s->dCoeff[i] = dCoeff[i];
+  }
+  s->dUmin = var (eVar, dRmin);
+  s->dUmax = var (eVar, dRmax);
+  s->dLeft = malloc (size * sizeof (double));
+  s->dPoly = malloc (size * 3 * sizeof (double));
+  if ( (s->dLeft == NULL) || (s->dPoly == NULL)) {
+
+    goto error;
+  }
+
+  target = dMaxError * BUILD_MARGIN;
+  for (u0 = s->dUmin; u0 < s->dUmax; u0 = u1) {
+
+    /* longest segment whose error is within target */
+    u1 = s->dUmax;
+    fit (s, iDegree, u0, u1, p);
+    if (error (s, u0, u1, p, BUILD_POINTS) > target) {
+
+      lo = u0;
+      hi = u1;
+      for (i = 0; i < BISECTION_STEPS; i++) {
+
+        u1 = 0.5 * (lo + hi);
+        fit (s, iDegree, u0, u1, p);
+        if (error (s, u0, u1, p, BUILD_POINTS) > target) {
+          hi = u1;
+        }
+        else {
+          lo = u1;
+        }
+      }
+      u1 = lo;
+      if (u1 <= u0) {
+
+        goto error;
+      }
+      fit (s, iDegree, u0, u1, p);
+    }
+
+    if (s->uCount == size) {
+
+      if (size == NTC_SPLINE_MAX_SEGMENTS) {
+
+        goto error;
+      }
+      size *= 2;
+      if ( (grow (&s->dLeft, size) != 0) || (grow (&s->dPoly, 3 * size) != 0)) {
+
+        goto error;
+      }
+    }
+    s->dLeft[s->uCount] = u0;
+    memcpy (&s->dPoly[3 * s->uCount], p, sizeof (p));
+    s->uCount++;
+  }
+
+  if ( (grow (&s->dLeft, s->uCount + 1) != 0) || (buildindex (s) != 0)) {
+
+    goto error;
+  }
+  s->dLeft[s->uCount] = INFINITY;
+
+  /* verification */
+  for (i = 0; i < (int) s->uCount; i++) {
+
+    u0 = s->dLeft[i];
+    u1 = (i + 1 < (int) s->uCount) ? s->dLeft[i + 1] : s->dUmax;
+    err = maxerror (s, u0, u1, &s->dPoly[3 * i], VERIFY_POINTS);
+    if (err > s->dMaxError) {
+      s->dMaxError = err;
+    }
+  }
+  if (s->dMaxError > dMaxError) {
+
+    goto error;
+  }
+  return s;
+
+error:
+  vNtcSplineDelete (s);
+  return NULL;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcSplineDelete (xNtcSpline * xSpline) {
+
+  if (xSpline) {
+
+    free (xSpline->dLeft);
+    free (xSpline->dPoly);
+    free (xSpline->uGrid);
+    free (xSpline);
+  }
+}
+
+// -----------------------------------------------------------------------------
+unsigned
+uNtcSplineSegments (const xNtcSpline * xSpline) {
+
+  return xSpline->uCount;
+}
+
+// -----------------------------------------------------------------------------
+double
+dNtcSplineMaxError (const xNtcSpline * xSpline) {
+
+  return xSpline->dMaxError;
+}
+
+// -----------------------------------------------------------------------------
+double
+dNtcSplineResToTemp (const xNtcSpline * xSpline, double dR) {
+
+  return eval (xSpline, dR);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcSplineResToTempArray (const xNtcSpline * xSpline, const double dR[],
+                          double dT[], size_t xCount) {
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    dT[i] = eval (xSpline, dR[i]);
+  }
+}
+
+/* ========================================================================== */
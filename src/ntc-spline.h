@@ -0,0 +1,125 @@
+/**
+ * @file ntc-spline.h
+ * @brief NTC thermistor library (piecewise polynomials)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#ifndef _NTC_SPLINE_H_
+#define _NTC_SPLINE_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ========================================================================== */
+#include "ntc.h"
+
+/* constants ================================================================ */
+/** Maximal number of segments of a piecewise polynom */
+#define NTC_SPLINE_MAX_SEGMENTS 65536
+
+/**
+ * Variable of the segments
+ */
+typedef enum {
+  eNtcSplineRes = 0,  /**< resistance (in Ohm) */
+  eNtcSplineLog2 = 1  /**< approximate log2(r), exponent + mantissa - 1 of
+                           the double, obtained without any transcendental
+                           function */
+} eNtcSplineVar;
+
+/* structures =============================================================== */
+/**
+ * Piecewise polynom approximating the Steinhart-Hart polynom (opaque)
+ */
+typedef struct xNtcSpline xNtcSpline;
+
+/* internal public functions ================================================ */
+/**
+ * Build a piecewise polynom approximating a thermistor
+ * Segments are built from the low resistance end, each one being extended
+ * as far as its error stays within dMaxError. The polynom of a segment
+ * interpolates the Steinhart-Hart polynom at the Chebyshev nodes, which is
+ * close to the minimax polynom, and its error is checked on 128 points
+ * against 98% of dMaxError. The whole result is then verified on 1024 points
+ * per segment, each local maximum of the error being refined between its
+ * neighbours, see dNtcSplineMaxError().
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @param dRmin minimal resistance (in Ohm)
+ * @param dRmax maximal resistance (in Ohm)
+ * @param dMaxError maximal temperature error (in degree Celsius)
+ * @param eVar variable of the segments
+ * @param iDegree degree of the segments, 1 (linear) or 2 (quadratic)
+ * @return the piecewise polynom, NULL on error or if more than
+ * NTC_SPLINE_MAX_SEGMENTS segments are needed. Must be released with
+ * vNtcSplineDelete()
+ */
+xNtcSpline * xNtcSplineNew (const double dCoeff[4], double dRmin, double dRmax,
+                            double dMaxError, eNtcSplineVar eVar, int iDegree);
+
+/**
+ * Release a piecewise polynom
+ * @param xSpline piecewise polynom to release, may be NULL
+ */
+void vNtcSplineDelete (xNtcSpline * xSpline);
+
+/**
+ * Number of segments of a piecewise polynom
+ * @param xSpline piecewise polynom
+ * @return number of segments
+ */
+unsigned uNtcSplineSegments (const xNtcSpline * xSpline);
+
+/**
+ * Verified maximal error of a piecewise polynom
+ * @param xSpline piecewise polynom
+ * @return maximal temperature error (in degree Celsius) at the maxima of
+ * the error of each segment, located from 1024 points per segment then
+ * refined, at most the requested error
+ */
+double dNtcSplineMaxError (const xNtcSpline * xSpline);
+
+/**
+ * Conversion from resistance to temperature with a piecewise polynom
+ * The segment is found from a small index of cells of equal width followed
+ * by a few branchless forward steps, then the polynom is evaluated: no
+ * logarithm, no division. Resistances outside the range are
+ * clamped to it, NaN gives NaN.
+ * @param xSpline piecewise polynom
+ * @param dR resistance (in Ohm)
+ * @return corresponding temperature (in degree Celsius)
+ */
+double dNtcSplineResToTemp (const xNtcSpline * xSpline, double dR);
+
+/**
+ * Conversion from resistance to temperature of an array with a piecewise
+ * polynom
+ * @param xSpline piecewise polynom
+ * @param dR resistances (in Ohm)
+ * @param dT corresponding temperatures (in degree Celsius), may be dR
+ * @param xCount number of values to convert
+ */
+void vNtcSplineResToTempArray (const xNtcSpline * xSpline, const double dR[],
+                               double dT[], size_t xCount);
+
+/* ========================================================================== */
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NTC_SPLINE_H_ defined */
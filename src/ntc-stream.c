@@ -0,0 +1,600 @@
+/**
+ * @file ntc-stream.c
+ * @brief NTC thermistor library (stream conversions)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <unistd.h>
+#include "ntc-stream.h"
+
+/* constants ================================================================ */
+/* Size of the input and output buffers */
+#define BUFFER_SIZE (1 << 20)
+/* Number of values converted together */
+#define BATCH 4096
+/* Maximal length of a formatted value */
+#define VALUE_MAX NTC_STREAM_VALUE_MAX
+/* Maximal length of a text token, a formatted value can be read back */
+#define TOKEN_MAX VALUE_MAX
+
+/* structures =============================================================== */
+typedef struct xStream {
+  int iIn, iOut;
+  const xNtcStreamConfig * xConfig;
+  const double * dCoeff;      /* resistance to temperature */
+  const xNtcModel * xModel;   /* temperature to resistance */
+  char * sIn;                 /* input buffer */
+  size_t xInLen;
+  char * sOut;                /* output buffer */
+  size_t xOutLen;
+  double dValue[BATCH];       /* batch of values to convert */
+  double dResult[BATCH];      /* converted values */
+  size_t xValues;
+  long long llCount;
+  int bSkip;                  /* rest of a too long token to skip */
+} xStream;
+
+/* private variables ======================================================== */
+static const double dPow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* private functions ======================================================== */
+/*
+ * Writes the whole buffer, restarts on interruption.
+ */
+static int
+put (int fd, const char * p, size_t n) {
+  ssize_t w;
+
+  while (n > 0) {
+
+    w = write (fd, p, n);
+    if (w < 0) {
+
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    p += w;
+    n -= (size_t) w;
+  }
+  return 0;
+}
+
+/*
+ * Reads at most n bytes, restarts on interruption.
+ * Returns the number of bytes read, 0 at end of file, -1 on error.
+ */
+static ssize_t
+get (int fd, char * p, size_t n) {
+  ssize_t r;
+
+  do {
+    r = read (fd, p, n);
+  } while ( (r < 0) && (errno == EINTR));
+  return r;
+}
+
+/*
+ * Parses a decimal number [s, e).
+ * Mantissas of less than 19 digits with an exponent in [-22, 22] are exact
+ * (both are exact doubles, one rounding), other numbers go to strtod().
+ * Returns 0, -1 if the token is not a number.
+ */
+static int
+parse (const char * s, const char * e, double * v) {
+  char tmp[TOKEN_MAX];
+  const char * p = s;
+  uint64_t m = 0;
+  int neg = 0, digits = 0, exp10 = 0, x = 0, xneg = 0, exact = 1;
+  char * end;
+
+  if ( (p < e) && ( (*p == '-') || (*p == '+'))) {
+
+    neg = (*p++ == '-');
+  }
+  for (; (p < e) && (*p >= '0') && (*p <= '9'); p++, digits++) {
+
+    if (m < 100000000000000000ULL) {
+      m = m * 10 + (*p - '0');
+    }
+    else {
+      exp10++;
+      exact = 0;
+    }
+  }
+  if ( (p < e) && (*p == '.')) {
+
+    for (p++; (p < e) && (*p >= '0') && (*p <= '9'); p++, digits++) {
+
+      if (m < 100000000000000000ULL) {
+        m = m * 10 + (*p - '0');
+        exp10--;
+      }
+      else {
+        exact = 0;
+      }
+    }
+  }
+  if ( (digits > 0) && (p < e) && ( (*p == 'e') || (*p == 'E'))) {
+
+    p++;
+    if ( (p < e) && ( (*p == '-') || (*p == '+'))) {
+
+      xneg = (*p++ == '-');
+    }
+    if ( (p == e) || (*p < '0') || (*p > '9')) {
+      exact = 0;
+    }
+    for (; (p < e) && (*p >= '0') && (*p <= '9'); p++) {
+
+      x = (x < 10000) ? x * 10 + (*p - '0') : x;
+    }
+    exp10 += xneg ? -x : x;
+  }
+
+  if (exact && (digits > 0) && (p == e) && (m < (1ULL << 53)) &&
+      (exp10 >= -22) && (exp10 <= 22)) {
+
+    *v = (exp10 < 0) ? (double) m / dPow10[-exp10] : (double) m * dPow10[exp10];
+    *v = neg ? -*v : *v;
+    return 0;
+  }
+  /* other numbers, nan, inf... */
+  if ( (size_t) (e - s) >= sizeof (tmp)) {
+
+    return -1;
+  }
+  memcpy (tmp, s, e - s);
+  tmp[e - s] = 0;
+  *v = strtod (tmp, &end);
+  return (*end == 0) && (end != tmp) ? 0 : -1;
+}
+
+/*
+ * Formats v with d decimals as printf ("%.*f\n"), returns the length.
+ * Values below 2^52 once scaled are printed from a 64 bits integer, others
+ * by snprintf(). The integer is rounded from the exact product |v| 10^d,
+ * that is the rounded product p plus its error e (fma), half to even as
+ * printf: below 2^52, p - floor(p) - 0.5 is a multiple of the ulp of p
+ * larger than |e| unless zero, so it gives the direction, e breaking ties.
+ */
+static size_t
+format (double v, int d, char * out) {
+  char tmp[24];
+  uint64_t x, scale;
+  double a, p, e, t;
+  size_t n = 0;
+  int i;
+
+  a = fabs (v);
+  if (! (a * dPow10[d] < 4503599627370496.0)) {
+
+    return (size_t) snprintf (out, VALUE_MAX, "%.*f\n", d, v);
+  }
+  p = a * dPow10[d];
+  e = fma (a, dPow10[d], -p);
+  x = (uint64_t) p;
+  t = (p - (double) x) - 0.5;
+  if ( (t > 0.0) || ( (t == 0.0) && ( (e > 0.0) || ( (e == 0.0) && (x & 1))))) {
+    x++;
+  }
+  scale = (uint64_t) dPow10[d];
+  if (signbit (v)) {
+    out[n++] = '-';
+  }
+  /* integer part */
+  i = 0;
+  do {
+    tmp[i++] = '0' + (char) (x / scale % 10);
+    scale *= 10;
+  } while (x >= scale);
+  while (i > 0) {
+    out[n++] = tmp[--i];
+  }
+  /* decimals */
+  if (d > 0) {
+
+    out[n++] = '.';
+    for (scale = (uint64_t) dPow10[d - 1]; d > 0; d--, scale /= 10) {
+
+      out[n++] = '0' + (char) (x / scale % 10);
+    }
+  }
+  out[n++] = '\n';
+  return n;
+}
+
+/*
+ * Converts the batch of values then writes them.
+ */
+static int
+flush (xStream * s) {
+  double * v = s->dResult;
+  size_t i;
+
+  /* the kernels do not handle values out of the domain, they give NaN */
+  if (s->xModel) {
+
+    vNtcModelTempToResArray (s->xModel, s->dValue, v, s->xValues);
+    for (i = 0; i < s->xValues; i++) {
+
+      v[i] = (s->dValue[i] > -273.15) ? v[i] : NAN;
+    }
+  }
+  else {
+
+    vNtcResToTempArray (s->dValue, v, s->xValues, s->dCoeff);
+    for (i = 0; i < s->xValues; i++) {
+
+      v[i] = (s->dValue[i] > 0.0) && isfinite (s->dValue[i]) ? v[i] : NAN;
+    }
+  }
+
+  for (i = 0; i < s->xValues; i++) {
+
+    if (s->xOutLen + VALUE_MAX > BUFFER_SIZE) {
+
+      if (put (s->iOut, s->sOut, s->xOutLen) != 0) {
+        return -1;
+      }
+      s->xOutLen = 0;
+    }
+    switch (s->xConfig->eOut) {
+      case eNtcStreamText:
+        s->xOutLen += format (v[i], s->xConfig->iDecimals,
+                              &s->sOut[s->xOutLen]);
+        break;
+      case eNtcStreamDouble: {
+        double d = v[i];
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        uint64_t u;
+
+        memcpy (&u, &d, sizeof (u));
+        u = __builtin_bswap64 (u);
+        memcpy (&d, &u, sizeof (u));
+#endif
+        memcpy (&s->sOut[s->xOutLen], &d, sizeof (d));
+        s->xOutLen += sizeof (d);
+      }
+      break;
+      case eNtcStreamFloat: {
+        float f = (float) v[i];
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        uint32_t u;
+
+        memcpy (&u, &f, sizeof (u));
+        u = __builtin_bswap32 (u);
+        memcpy (&f, &u, sizeof (u));
+#endif
+        memcpy (&s->sOut[s->xOutLen], &f, sizeof (f));
+        s->xOutLen += sizeof (f);
+      }
+      break;
+    }
+  }
+  s->llCount += s->xValues;
+  s->xValues = 0;
+  return 0;
+}
+
+/*
+ * Adds a value to the batch.
+ */
+static inline int
+add (xStream * s, double v) {
+
+  s->dValue[s->xValues++] = v;
+  return (s->xValues == BATCH) ? flush (s) : 0;
+}
+
+static inline int
+space (char c) {
+
+  return (c == ' ') || (c == '\n') || (c == '\t') || (c == '\r') ||
+         (c == '\f') || (c == '\v');
+}
+
+/*
+ * Parses the complete tokens of the input buffer, the last token is kept
+ * for the next read unless eof is set. A token of TOKEN_MAX characters or
+ * more at the end of the buffer gives a NaN, its rest is skipped.
+ */
+static int
+text (xStream * s, int eof) {
+  char * p = s->sIn, * e = s->sIn + s->xInLen, * t;
+  double v;
+
+  for (;;) {
+
+    if (s->bSkip) {
+
+      while ( (p < e) && !space (*p)) {
+        p++;
+      }
+      s->bSkip = (p == e);
+    }
+    while ( (p < e) && space (*p)) {
+      p++;
+    }
+    for (t = p; (t < e) && !space (*t); t++)
+      ;
+    if (t == p) {
+      break;
+    }
+    if ( (t == e) && !eof) {
+
+      if (t - p < TOKEN_MAX) {
+        break;
+      }
+      s->bSkip = 1;
+      v = NAN;
+    }
+    else if (parse (p, t, &v) != 0) {
+      v = NAN;
+    }
+    if (add (s, v) != 0) {
+      return -1;
+    }
+    p = t;
+  }
+  s->xInLen = e - p;
+  memmove (s->sIn, p, s->xInLen);
+  return 0;
+}
+
+/*
+ * Converts the complete binary values of the input buffer.
+ */
+static int
+binary (xStream * s) {
+  size_t i, n, size;
+
+  size = (s->xConfig->eIn == eNtcStreamDouble) ? sizeof (double) :
+         sizeof (float);
+  n = s->xInLen / size;
+  for (i = 0; i < n; i++) {
+
+    if (size == sizeof (double)) {
+      double v;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      uint64_t u;
+
+      memcpy (&u, &s->sIn[i * size], sizeof (u));
+      u = __builtin_bswap64 (u);
+      memcpy (&v, &u, sizeof (u));
+#else
+      memcpy (&v, &s->sIn[i * size], sizeof (v));
+#endif
+      if (add (s, v) != 0) {
+        return -1;
+      }
+    }
+    else {
+      float v;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      uint32_t u;
+
+      memcpy (&u, &s->sIn[i * size], sizeof (u));
+      u = __builtin_bswap32 (u);
+      memcpy (&v, &u, sizeof (u));
+#else
+      memcpy (&v, &s->sIn[i * size], sizeof (v));
+#endif
+      if (add (s, v) != 0) {
+        return -1;
+      }
+    }
+  }
+  s->xInLen -= n * size;
+  memmove (s->sIn, &s->sIn[n * size], s->xInLen);
+  return 0;
+}
+
+/*
+ * Stream conversion.
+ */
+static long long
+run (xStream * s) {
+  ssize_t r;
+  int ret = 0;
+
+  s->sIn = malloc (BUFFER_SIZE);
+  s->sOut = malloc (BUFFER_SIZE);
+  if ( (s->sIn == NULL) || (s->sOut == NULL) || (s->xConfig->iDecimals < 0) ||
+       (s->xConfig->iDecimals > 9)) {
+
+    ret = -1;
+  }
+  while (ret == 0) {
+
+    r = get (s->iIn, s->sIn + s->xInLen, BUFFER_SIZE - s->xInLen);
+    if (r < 0) {
+
+      ret = -1;
+      break;
+    }
+    s->xInLen += (size_t) r;
+    if (s->xConfig->eIn == eNtcStreamText) {
+
+      ret = text (s, r == 0);
+    }
+    else {
+
+      ret = binary (s);
+    }
+    if (r == 0) {
+      break;
+    }
+  }
+  if (ret == 0) {
+
+    ret = flush (s);
+  }
+  if (ret == 0) {
+
+    ret = put (s->iOut, s->sOut, s->xOutLen);
+  }
+  free (s->sIn);
+  free (s->sOut);
+  return (ret == 0) ? s->llCount : -1;
+}
+
+/* internal public functions ================================================ */
+// -----------------------------------------------------------------------------
+long long
+llNtcStreamResToTemp (int iIn, int iOut, const xNtcStreamConfig * xConfig,
+                      const double dCoeff[4]) {
+  xStream * s;
+  long long n = -1;
+
+  s = calloc (1, sizeof (xStream));
+  if (s) {
+
+    s->iIn = iIn;
+    s->iOut = iOut;
+    s->xConfig = xConfig;
+    s->dCoeff = dCoeff;
+    n = run (s);
+    free (s);
+  }
+  return n;
+}
+
+// -----------------------------------------------------------------------------
+long long
+llNtcStreamTempToRes (int iIn, int iOut, const xNtcStreamConfig * xConfig,
+                      const xNtcModel * xModel) {
+  xStream * s;
+  long long n = -1;
+
+  s = calloc (1, sizeof (xStream));
+  if (s) {
+
+    s->iIn = iIn;
+    s->iOut = iOut;
+    s->xConfig = xConfig;
+    s->xModel = xModel;
+    n = run (s);
+    free (s);
+  }
+  return n;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcStreamReadModel (const char * sPath, double dCoeff[4]) {
+  char line[256], * p, * end;
+  double v, w[4];
+  int i, n = 0, found = 0;
+  FILE * f;
+
+  f = fopen (sPath, "r");
+  if (f == NULL) {
+
+    return -1;
+  }
+  while (fgets (line, sizeof (line), f)) {
+
+    if (sscanf (line, " a[%d] = %lf", &i, &v) == 2) {
+
+      if ( (i >= 0) && (i < 4)) {
+
+        dCoeff[i] = v;
+        found |= 1 << i;
+      }
+      continue;
+    }
+    /* plain numbers, other lines are ignored */
+    for (p = line; (n >= 0) && (*p != 0); p = end) {
+
+      while ( (*p == ',') || space (*p)) {
+        p++;
+      }
+      v = strtod (p, &end);
+      if (end == p) {
+        break;
+      }
+      n = (n < 4) ? n : -1;
+      if (n >= 0) {
+        w[n++] = v;
+      }
+    }
+  }
+  fclose (f);
+  if (found == 0xf) {
+
+    return 0;
+  }
+  if (n != 4) {
+
+    return -1;
+  }
+  for (i = 0; i < 4; i++) {
+
+    dCoeff[i] = w[i];
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcStreamParseCoeff (const char * sList, double dCoeff[4]) {
+  const char * p = sList;
+  char * end;
+  int i;
+
+  for (i = 0; i < 4; i++) {
+
+    dCoeff[i] = strtod (p, &end);
+    if ( (end == p) || ( (i < 3) && (*end != ','))) {
+
+      return -1;
+    }
+    p = end + 1;
+  }
+  return (*end == 0) ? 0 : -1;
+}
+
+// -----------------------------------------------------------------------------
+size_t
+xNtcStreamFormatNumber (double dValue, int iDecimals, char * sOut) {
+
+  return format (dValue, iDecimals, sOut);
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcStreamParseNumber (const char * sBegin, const char * sEnd, double * dValue) {
+
+  return parse (sBegin, sEnd, dValue);
+}
+
+/* ========================================================================== */
@@ -0,0 +1,139 @@
+/**
+ * @file ntc-stream.h
+ * @brief NTC thermistor library (stream conversions)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#ifndef _NTC_STREAM_H_
+#define _NTC_STREAM_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ========================================================================== */
+#include "ntc.h"
+
+/* constants ================================================================ */
+/**
+ * Maximal length of a value printed in a text stream, new line included
+ * ("%.9f\n" of -DBL_MAX), a longer input token is not a number
+ */
+#define NTC_STREAM_VALUE_MAX 328
+
+/**
+ * Format of the values of a stream
+ */
+typedef enum {
+  eNtcStreamText = 0,   /**< decimal numbers separated by white spaces */
+  eNtcStreamDouble = 1, /**< raw little endian IEEE 754 doubles */
+  eNtcStreamFloat = 2   /**< raw little endian IEEE 754 floats */
+} eNtcStreamFormat;
+
+/* structures =============================================================== */
+/**
+ * Formats of a stream conversion
+ */
+typedef struct xNtcStreamConfig {
+  eNtcStreamFormat eIn;   /**< format of the input */
+  eNtcStreamFormat eOut;  /**< format of the output */
+  int iDecimals;          /**< digits after the decimal point of the text
+                               output, 0 to 9 */
+} xNtcStreamConfig;
+
+/* internal public functions ================================================ */
+/**
+ * Stream conversion from resistance to temperature
+ * Reads the input by large blocks, converts the values by batches with
+ * vNtcResToTempArray() and writes the output by large blocks. Text numbers
+ * are parsed without strtod() when they have less than 19 significant
+ * digits and a small exponent (exact result), and printed as "%.*f"
+ * without printf() (one value per line). A text token that is not a
+ * number gives "nan", so that the output lines match the input tokens.
+ * @param iIn file descriptor of the input, read until end of file
+ * @param iOut file descriptor of the output
+ * @param xConfig formats
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @return number of values converted, -1 on read or write error
+ */
+long long llNtcStreamResToTemp (int iIn, int iOut,
+                                const xNtcStreamConfig * xConfig,
+                                const double dCoeff[4]);
+
+/**
+ * Stream conversion from temperature to resistance
+ * Same as llNtcStreamResToTemp() with vNtcModelTempToResArray().
+ * @param iIn file descriptor of the input, read until end of file
+ * @param iOut file descriptor of the output
+ * @param xConfig formats
+ * @param xModel thermistor model
+ * @return number of values converted, -1 on read or write error
+ */
+long long llNtcStreamTempToRes (int iIn, int iOut,
+                                const xNtcStreamConfig * xConfig,
+                                const xNtcModel * xModel);
+
+/**
+ * Read the coefficients of a model file
+ * The file contains the lines "a[i] = value" printed by ntc-coeff, or
+ * only the four coefficients separated by white spaces or commas.
+ * @param sPath path of the file
+ * @param dCoeff the four coefficients read
+ * @return 0, -1 if the file can not be read or is not valid
+ */
+int iNtcStreamReadModel (const char * sPath, double dCoeff[4]);
+
+/**
+ * Parse coefficients given as a string
+ * @param sList four numbers separated by commas, as "1e-3,2e-4,0,5e-8"
+ * @param dCoeff the four coefficients read
+ * @return 0, -1 if the string is not valid
+ */
+int iNtcStreamParseCoeff (const char * sList, double dCoeff[4]);
+
+/**
+ * Parse a decimal number that is not terminated by a null character
+ * This is the parser of the text streams: exact and without strtod() for
+ * mantissas of less than 19 digits with small exponents.
+ * @param sBegin first character of the number
+ * @param sEnd character after the last one of the number
+ * @param dValue value read
+ * @return 0, -1 if [sBegin, sEnd) is not a number
+ */
+int iNtcStreamParseNumber (const char * sBegin, const char * sEnd,
+                           double * dValue);
+
+/**
+ * Print a number as the text streams do
+ * The output is the one of sprintf (sOut, "%.*f\n", iDecimals, dValue),
+ * rounded half to even on the exact value of dValue, without printf() for
+ * the values below 2<sup>52</sup> once scaled.
+ * @param dValue value to print
+ * @param iDecimals digits after the decimal point, 0 to 9
+ * @param sOut text printed, at least NTC_STREAM_VALUE_MAX characters, may
+ * not be terminated by a null character
+ * @return number of characters printed
+ */
+size_t xNtcStreamFormatNumber (double dValue, int iDecimals, char * sOut);
+
+/* ========================================================================== */
+#ifdef __cplusplus
+}
+#endif
+#endif /* _NTC_STREAM_H_ defined */
@@ -22,12 +22,68 @@
  *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
  *******************************************************************************
  */
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include "ntc.h"
 
 /* constants ================================================================ */
 #define TABS (-273.15)
 
+/* Newton steps of the inverse conversion, the error is below 1 ulp after 3 */
+#define NTC_NEWTON_STEPS 3
+
+/* Newton steps of the seed nodes of a model */
+#define NTC_SEED_STEPS 16
+
+/*
+ * Newton steps from the simplified polynom a0 + a1 ln r, used by the
+ * functions that take the coefficients instead of a model
+ */
+#define NTC_LEGACY_STEPS 5
+
+/* vector kernels =========================================================== */
+#if defined(__GNUC__) && defined(__x86_64__)
+/*
+ * One kernel for each instruction set, the best one supported by the host
+ * is selected at run time (SSE2 is always available on x86_64).
+ */
+#define NTC_HAVE_KERNEL 1
+#define NTC_HAVE_X86_KERNELS 1
+#define NTC_VEC_BYTES 16
+#define NTC_KERNEL_SUFFIX sse2
+#include "ntc-kernel.h"
+#undef NTC_KERNEL_SUFFIX
+#undef NTC_VEC_BYTES
+
+#pragma GCC push_options
+#pragma GCC target ("avx2,fma")
+#define NTC_VEC_BYTES 32
+#define NTC_KERNEL_SUFFIX avx2
+#include "ntc-kernel.h"
+#undef NTC_KERNEL_SUFFIX
+#undef NTC_VEC_BYTES
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target ("avx512f")
+#define NTC_VEC_BYTES 64
+#define NTC_KERNEL_SUFFIX avx512
+#include "ntc-kernel.h"
+#undef NTC_KERNEL_SUFFIX
+#undef NTC_VEC_BYTES
+#pragma GCC pop_options
+
+#elif defined(__GNUC__)
+#define NTC_HAVE_KERNEL 1
+#define NTC_VEC_BYTES 16
+#define NTC_KERNEL_SUFFIX vec
+#include "ntc-kernel.h"
+#undef NTC_KERNEL_SUFFIX
+#undef NTC_VEC_BYTES
+#endif
+
 /* private functions ======================================================== */
 /*
  * Evaluates p(x) for a polynom p.
@@ -38,7 +94,7 @@
  * @return calculated polynom value.
  */
 static double
-poly(double x, int degree, double p[]) {
+poly(double x, int degree, const double p[]) {
   double retval = 0.0;
   int i;
 
@@ -49,23 +105,428 @@ poly(double x, int degree, double p[]) {
   return retval;
 }
 
+/*
+ * Newton iteration on a(x) - y = 0.
+ * @param a Steinhart-Hart coefficients.
+ * @param y reciprocal absolute temperature.
+ * @param x initial value of ln(r).
+ * @param steps number of iterations.
+ * @return refined value of ln(r).
+ */
+static inline double
+newton (const double a[4], double y, double x, int steps) {
+  double f, fp;
+  int i;
+
+  for (i = 0; i < steps; i++) {
+
+    f  = ((a[3] * x + a[2]) * x + a[1]) * x + a[0] - y;
+    fp = (3.0 * a[3] * x + 2.0 * a[2]) * x + a[1];
+    x -= f / fp;
+  }
+  return x;
+}
+
+/*
+ * Evaluates ln(r) for the reciprocal absolute temperature y.
+ * Exact for the simplified form, otherwise quadratic seed followed by
+ * NTC_NEWTON_STEPS Newton steps without branch.
+ */
+static inline double
+lnres (const xNtcModel * m, double y) {
+  double u, x;
+
+  if (m->eForm == eNtcFormSimplified) {
+
+    return (y - m->dA[0]) / m->dA[1];
+  }
+  u = y - m->dSeedY;
+  x = m->dSeed[0] + u * (m->dSeed[1] + u * m->dSeed[2]);
+  return newton (m->dA, y, x, NTC_NEWTON_STEPS);
+}
+
+/*
+ * Single precision natural logarithm, Cephes algorithm (less than 2 ulp
+ * for positive normal x): x = 2^k * (1 + f) with sqrt(2)/2 <= 1 + f <
+ * sqrt(2), then a degree 8 polynom of f.
+ */
+static inline float
+flog (float x) {
+  uint32_t ix;
+  float f, z, y, k;
+
+  memcpy (&ix, &x, sizeof (ix));
+  ix += 0x3f800000 - 0x3f3504f3;
+  k = (float) ((int32_t) (ix >> 23) - 127);
+  ix = (ix & 0x007fffff) + 0x3f3504f3;
+  memcpy (&f, &ix, sizeof (f));
+  f -= 1.0f;
+
+  z = f * f;
+  y = 7.0376836292e-2f * f - 1.1514610310e-1f;
+  y = y * f + 1.1676998740e-1f;
+  y = y * f - 1.2420140846e-1f;
+  y = y * f + 1.4249322787e-1f;
+  y = y * f - 1.6668057665e-1f;
+  y = y * f + 2.0000714765e-1f;
+  y = y * f - 2.4999993993e-1f;
+  y = y * f + 3.3333331174e-1f;
+  y = f * z * y + k * -2.12194440e-4f - 0.5f * z;
+  return f + y + k * 0.693359375f;
+}
+
+/*
+ * Single precision exponential, Cephes algorithm (less than 2 ulp for
+ * |x| < 87): x = k ln2 + r with |r| <= ln2/2, a degree 5 polynom of r,
+ * then scaling by 2^k with an integer add on the exponent.
+ */
+static inline float
+fexp (float x) {
+  uint32_t ki, iy;
+  float k, r, z, y;
+
+  k = x * 1.44269504088896341f + 12582912.0f;
+  memcpy (&ki, &k, sizeof (ki));
+  k -= 12582912.0f;
+  r = x - k * 0.693359375f - k * -2.12194440e-4f;
+  z = r * r;
+  y = 1.9875691500e-4f * r + 1.3981999507e-3f;
+  y = y * r + 8.3334519073e-3f;
+  y = y * r + 4.1665795894e-2f;
+  y = y * r + 1.6666665459e-1f;
+  y = y * r + 5.0000001201e-1f;
+  y = y * z + r + 1.0f;
+  memcpy (&iy, &y, sizeof (iy));
+  iy += ki << 23;
+  memcpy (&y, &iy, sizeof (y));
+  return y;
+}
+
+/*
+ * 1/T for x = ln r with the polynom of a form.
+ */
+static inline double
+form (double x, const double a[4], eNtcForm eForm) {
+
+  switch (eForm) {
+    case eNtcFormSimplified:
+      return a[1] * x + a[0];
+    case eNtcFormStandard:
+      return (a[3] * x * x + a[1]) * x + a[0];
+    default:
+      return poly (x, 3, a);
+  }
+}
+
+/*
+ * Scalar kernels, used when no vector kernel is available or when
+ * eNtcIsaScalar is forced.
+ */
+static void
+vResToTempArray_scalar (const double dR[], double dT[], size_t xCount,
+                        const double dCoeff[4]) {
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    dT[i] = 1.0 / poly (log (dR[i]), 3, dCoeff) + TABS;
+  }
+}
+
+static void
+vResToTempArrayStd_scalar (const double dR[], double dT[], size_t xCount,
+                           const double dCoeff[4]) {
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    dT[i] = 1.0 / form (log (dR[i]), dCoeff, eNtcFormStandard) + TABS;
+  }
+}
+
+static void
+vResToTempArraySim_scalar (const double dR[], double dT[], size_t xCount,
+                           const double dCoeff[4]) {
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    dT[i] = 1.0 / form (log (dR[i]), dCoeff, eNtcFormSimplified) + TABS;
+  }
+}
+
+static void
+vTempToResArray_scalar (const xNtcModel * m, const double dT[], double dR[],
+                        size_t xCount) {
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    dR[i] = exp (lnres (m, 1.0 / (dT[i] - TABS)));
+  }
+}
+
+static void
+vResToTempArraySoa_scalar (const double dR[], double dT[], size_t xCount,
+                           const double * const a[4]) {
+  double x;
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    x = log (dR[i]);
+    dT[i] = 1.0 / (((a[3][i] * x + a[2][i]) * x + a[1][i]) * x + a[0][i]) +
+            TABS;
+  }
+}
+
+static void
+vResToTempArrayf_scalar (const float fR[], float fT[], size_t xCount,
+                         const double dCoeff[4]) {
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    fT[i] = fNtcResToTemp (fR[i], dCoeff);
+  }
+}
+
+static void
+vTempToResArrayf_scalar (const xNtcModel * m, const float fT[], float fR[],
+                         size_t xCount) {
+  size_t i;
+
+  for (i = 0; i < xCount; i++) {
+
+    fR[i] = fNtcModelTempToRes (m, fT[i]);
+  }
+}
+
+/*
+ * Batch kernels of an instruction set.
+ */
+typedef struct xKernel {
+  eNtcIsa eIsa;
+  /* indexed by eNtcForm */
+  void (*vResToTemp[3]) (const double *, double *, size_t, const double *);
+  void (*vTempToRes) (const xNtcModel *, const double *, double *, size_t);
+  void (*vResToTempf) (const float *, float *, size_t, const double *);
+  void (*vTempToResf) (const xNtcModel *, const float *, float *, size_t);
+  void (*vResToTempSoa) (const double *, double *, size_t,
+                         const double * const [4]);
+} xKernel;
+
+#define KERNEL(isa, suffix) { isa, { vResToTempArraySim_##suffix, \
+    vResToTempArrayStd_##suffix, vResToTempArray_##suffix }, \
+    vTempToResArray_##suffix, vResToTempArrayf_##suffix, \
+    vTempToResArrayf_##suffix, vResToTempArraySoa_##suffix }
+
+/* Kernels in increasing order of preference */
+static const xKernel xKernels[] = {
+  KERNEL (eNtcIsaScalar, scalar),
+#if defined(NTC_HAVE_X86_KERNELS)
+  KERNEL (eNtcIsaSse2, sse2),
+  KERNEL (eNtcIsaAvx2, avx2),
+  KERNEL (eNtcIsaAvx512, avx512),
+#elif defined(NTC_HAVE_KERNEL)
+  KERNEL (eNtcIsaVector, vec),
+#endif
+};
+
+#define KERNELS (sizeof (xKernels) / sizeof (xKernels[0]))
+
+/*
+ * Selected kernel, resolved at the first batch conversion. Concurrent
+ * resolutions store the same pointer. It is only accessed by the __atomic
+ * builtins so that threads may convert while another one resolves or
+ * selects the kernel.
+ */
+static const xKernel * xCurrent;
+
+/*
+ * Kernel of an instruction set, NULL if the library or the host does not
+ * support it.
+ */
+static const xKernel *
+find (eNtcIsa eIsa) {
+  size_t i;
+
+  for (i = 0; i < KERNELS; i++) {
+
+    if (xKernels[i].eIsa == eIsa) {
+#if defined(NTC_HAVE_X86_KERNELS)
+      __builtin_cpu_init();
+      if ( ( (eIsa == eNtcIsaAvx2) && !(__builtin_cpu_supports ("avx2") &&
+                                         __builtin_cpu_supports ("fma"))) ||
+           ( (eIsa == eNtcIsaAvx512) && !__builtin_cpu_supports ("avx512f"))) {
+
+        return NULL;
+      }
+#endif
+      return &xKernels[i];
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Best kernel supported by the host.
+ */
+static const xKernel *
+best (void) {
+  const xKernel * k = NULL;
+  size_t i;
+
+  for (i = KERNELS; (k == NULL) && (i > 0); i--) {
+
+    k = find (xKernels[i - 1].eIsa);
+  }
+  return k;
+}
+
+static inline const xKernel *
+kernel (void) {
+
+  const xKernel * k = __atomic_load_n (&xCurrent, __ATOMIC_RELAXED);
+
+  if (k == NULL) {
+
+    k = best();
+    __atomic_store_n (&xCurrent, k, __ATOMIC_RELAXED);
+  }
+  return k;
+}
+
+/*
+ * Initializes a model whose seed nodes are solved with steps Newton steps.
+ */
+static int
+init (xNtcModel * xModel, const double dCoeff[4], int steps) {
+  static const double t[3] = { -50.0, 50.0, 150.0 };
+  double x[3], y[3], d10, dd;
+  int i;
+
+  if (dCoeff[1] == 0.0) {
+
+    return -1;
+  }
+  for (i = 0; i < 4; i++) {
+
+    xModel->dA[i] = dCoeff[i];
+  }
+  xModel->eForm = eNtcFormOf (dCoeff);
+  /*
+   * Seed: quadratic interpolation of ln(r) over 1/T through three nodes,
+   * each node is solved from the simplified polynom a0 + a1 ln r then
+   * refined until convergence.
+   */
+  for (i = 0; i < 3; i++) {
+
+    y[i] = 1.0 / (t[i] - TABS);
+    x[i] = newton (dCoeff, y[i], (y[i] - dCoeff[0]) / dCoeff[1], steps);
+  }
+  d10 = (x[0] - x[1]) / (y[0] - y[1]);
+  dd  = ((x[2] - x[1]) / (y[2] - y[1]) - d10) / (y[2] - y[0]);
+  xModel->dSeedY = y[1];
+  xModel->dSeed[0] = x[1];
+  xModel->dSeed[1] = d10 + (y[1] - y[0]) * dd;
+  xModel->dSeed[2] = dd;
+  return 0;
+}
+
 /* internal public functions ================================================ */
+// -----------------------------------------------------------------------------
+int
+iNtcModelInit (xNtcModel * xModel, const double dCoeff[4]) {
+
+  return init (xModel, dCoeff, NTC_SEED_STEPS);
+}
+
+// -----------------------------------------------------------------------------
+eNtcForm
+eNtcFormOf (const double dCoeff[4]) {
+
+  if (dCoeff[2] != 0.0) {
+
+    return eNtcFormExtended;
+  }
+  return (dCoeff[3] == 0.0) ? eNtcFormSimplified : eNtcFormStandard;
+}
+
+// -----------------------------------------------------------------------------
+const char *
+sNtcFormName (eNtcForm eForm) {
+  static const char * name[] = { "simplified", "standard", "extended" };
+
+  return ( (unsigned) eForm < 3) ? name[eForm] : "unknown";
+}
+
+// -----------------------------------------------------------------------------
+xNtcModel *
+xNtcModelNew (const double dCoeff[4]) {
+  xNtcModel * xModel = malloc (sizeof (xNtcModel));
+
+  if (xModel) {
+
+    if (iNtcModelInit (xModel, dCoeff) != 0) {
+
+      free (xModel);
+      return NULL;
+    }
+  }
+  return xModel;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcModelDelete (xNtcModel * xModel) {
+
+  free (xModel);
+}
+
+// -----------------------------------------------------------------------------
+double
+dNtcModelTempToRes (const xNtcModel * xModel, double dT) {
+
+  return exp (lnres (xModel, 1.0 / (dT - TABS)));
+}
+
+// -----------------------------------------------------------------------------
+double
+dNtcModelResToTemp (const xNtcModel * xModel, double dR) {
+
+  return 1.0 / form (log (dR), xModel->dA, xModel->eForm) + TABS;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcModelResToTempArray (const xNtcModel * xModel, const double dR[],
+                         double dT[], size_t xCount) {
+
+  kernel()->vResToTemp[xModel->eForm] (dR, dT, xCount, xModel->dA);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcModelTempToResArray (const xNtcModel * xModel, const double dT[],
+                         double dR[], size_t xCount) {
+
+  kernel()->vTempToRes (xModel, dT, dR, xCount);
+}
+
 // -----------------------------------------------------------------------------
 double
 dNtcTempToRes (double dT, double dCoeff[]) {
-  double r;
-  double u, v, p, q, b, c, d;
+  double y;
 
-  dT = dT - TABS;
-  d = (dCoeff[0] - 1.0 / dT) / dCoeff[3];
-  c = dCoeff[1] / dCoeff[3];
-  b = dCoeff[2] / dCoeff[3];
-  q = 2.0 / 27.0 * b * b * b - 1.0 / 3.0 * b * c + d;
-  p = c - 1.0 / 3.0 * b * b;
-  v = - pow(q / 2.0 + sqrt(q * q / 4.0 + p * p * p / 27.0), 1.0 / 3.0);
-  u =   pow(-q / 2.0 + sqrt(q * q / 4.0 + p * p * p / 27.0), 1.0 / 3.0);
-  r  = exp(u + v - b / 3.0);
-  return r;
+  if (dCoeff[1] == 0.0) {
+
+    return NAN;
+  }
+  /* no model to seed from, starts from the simplified polynom */
+  y = 1.0 / (dT - TABS);
+  return exp (newton (dCoeff, y, (y - dCoeff[0]) / dCoeff[1],
+                      NTC_LEGACY_STEPS));
 }
 
 // -----------------------------------------------------------------------------
@@ -79,4 +540,195 @@ dNtcResToTemp(double dR, double dCoeff[])
   return ti;
 }
 
+// -----------------------------------------------------------------------------
+void
+vNtcResToTempArray (const double dR[], double dT[], size_t xCount,
+                    const double dCoeff[]) {
+
+  kernel()->vResToTemp[eNtcFormOf (dCoeff)] (dR, dT, xCount, dCoeff);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcResToTempArraySoa (const double dR[], double dT[], size_t xCount,
+                       const double * const dCoeff[4]) {
+
+  kernel()->vResToTempSoa (dR, dT, xCount, dCoeff);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcTempToResArray (const double dT[], double dR[], size_t xCount,
+                    const double dCoeff[]) {
+  xNtcModel xModel;
+  size_t i;
+
+  if (init (&xModel, dCoeff, NTC_LEGACY_STEPS) != 0) {
+
+    for (i = 0; i < xCount; i++) {
+
+      dR[i] = NAN;
+    }
+    return;
+  }
+  vNtcModelTempToResArray (&xModel, dT, dR, xCount);
+}
+
+// -----------------------------------------------------------------------------
+float
+fNtcModelTempToRes (const xNtcModel * xModel, float fT) {
+  float a[4], x, y, u, f, fp;
+  int i;
+
+  for (i = 0; i < 4; i++) {
+
+    a[i] = (float) xModel->dA[i];
+  }
+  y = 1.0f / (fT - (float) TABS);
+  u = y - (float) xModel->dSeedY;
+  x = (float) xModel->dSeed[0] + u * ( (float) xModel->dSeed[1] +
+                                       u * (float) xModel->dSeed[2]);
+  for (i = 0; i < NTC_NEWTON_STEPS; i++) {
+
+    f  = ((a[3] * x + a[2]) * x + a[1]) * x + a[0] - y;
+    fp = (3.0f * a[3] * x + 2.0f * a[2]) * x + a[1];
+    x -= f / fp;
+  }
+  return fexp (x);
+}
+
+// -----------------------------------------------------------------------------
+float
+fNtcModelResToTemp (const xNtcModel * xModel, float fR) {
+
+  return fNtcResToTemp (fR, xModel->dA);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcModelResToTempArrayf (const xNtcModel * xModel, const float fR[],
+                          float fT[], size_t xCount) {
+
+  kernel()->vResToTempf (fR, fT, xCount, xModel->dA);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcModelTempToResArrayf (const xNtcModel * xModel, const float fT[],
+                          float fR[], size_t xCount) {
+
+  kernel()->vTempToResf (xModel, fT, fR, xCount);
+}
+
+// -----------------------------------------------------------------------------
+float
+fNtcTempToRes (float fT, const double dCoeff[4]) {
+  float a[4], x, y, f, fp;
+  int i;
+
+  if (dCoeff[1] == 0.0) {
+
+    return NAN;
+  }
+  for (i = 0; i < 4; i++) {
+
+    a[i] = (float) dCoeff[i];
+  }
+  y = 1.0f / (fT - (float) TABS);
+  x = (y - a[0]) / a[1];
+  for (i = 0; i < NTC_LEGACY_STEPS; i++) {
+
+    f  = ((a[3] * x + a[2]) * x + a[1]) * x + a[0] - y;
+    fp = (3.0f * a[3] * x + 2.0f * a[2]) * x + a[1];
+    x -= f / fp;
+  }
+  return fexp (x);
+}
+
+// -----------------------------------------------------------------------------
+float
+fNtcResToTemp (float fR, const double dCoeff[4]) {
+  float x;
+
+  x = flog (fR);
+  x = (((float) dCoeff[3] * x + (float) dCoeff[2]) * x +
+       (float) dCoeff[1]) * x + (float) dCoeff[0];
+  return 1.0f / x + (float) TABS;
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcResToTempArrayf (const float fR[], float fT[], size_t xCount,
+                     const double dCoeff[4]) {
+
+  kernel()->vResToTempf (fR, fT, xCount, dCoeff);
+}
+
+// -----------------------------------------------------------------------------
+void
+vNtcTempToResArrayf (const float fT[], float fR[], size_t xCount,
+                     const double dCoeff[4]) {
+  xNtcModel xModel;
+  size_t i;
+
+  if (init (&xModel, dCoeff, NTC_LEGACY_STEPS) != 0) {
+
+    for (i = 0; i < xCount; i++) {
+
+      fR[i] = NAN;
+    }
+    return;
+  }
+  vNtcModelTempToResArrayf (&xModel, fT, fR, xCount);
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcIsaSet (eNtcIsa eIsa) {
+  const xKernel * k;
+
+  k = (eIsa == eNtcIsaAuto) ? best() : find (eIsa);
+  if (k == NULL) {
+
+    return -1;
+  }
+  __atomic_store_n (&xCurrent, k, __ATOMIC_RELAXED);
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+eNtcIsa
+eNtcIsaGet (void) {
+
+  return kernel()->eIsa;
+}
+
+// -----------------------------------------------------------------------------
+int
+iNtcIsaSupported (eNtcIsa eIsa) {
+
+  return find (eIsa) != NULL;
+}
+
+// -----------------------------------------------------------------------------
+const char *
+sNtcIsaName (eNtcIsa eIsa) {
+
+  switch (eIsa) {
+    case eNtcIsaAuto:
+      return "auto";
+    case eNtcIsaScalar:
+      return "scalar";
+    case eNtcIsaVector:
+      return "vector";
+    case eNtcIsaSse2:
+      return "sse2";
+    case eNtcIsaAvx2:
+      return "avx2";
+    case eNtcIsaAvx512:
+      return "avx512";
+  }
+  return "unknown";
+}
+
 /* ========================================================================== */
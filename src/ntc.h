@@ -28,11 +28,133 @@
 extern "C" {
 #endif
 /* ========================================================================== */
+#include <stddef.h>
+
+/* constants ================================================================ */
+/**
+ * Instruction sets of the batch conversion kernels
+ */
+typedef enum eNtcIsa {
+  eNtcIsaAuto = -1, /**< best instruction set supported by the host */
+  eNtcIsaScalar = 0,/**< scalar loops with libm, always supported */
+  eNtcIsaVector,    /**< GCC generic vectors, targets other than x86_64 */
+  eNtcIsaSse2,      /**< SSE2, 2 doubles or 4 floats per vector */
+  eNtcIsaAvx2,      /**< AVX2 and FMA, 4 doubles or 8 floats per vector */
+  eNtcIsaAvx512     /**< AVX-512F, 8 doubles or 16 floats per vector */
+} eNtcIsa;
+
+/**
+ * Forms of the Steinhart-Hart polynom
+ * The conversions evaluate only the terms of the form of the coefficients
+ * (see eNtcFormOf()).
+ */
+typedef enum eNtcForm {
+  eNtcFormSimplified = 0, /**< 1/T = a0 + a1 ln r (beta equation) */
+  eNtcFormStandard,       /**< 1/T = a0 + a1 ln r + a3 (ln r)^3 */
+  eNtcFormExtended        /**< 1/T = a0 + a1 ln r + a2 (ln r)^2 + a3 (ln r)^3 */
+} eNtcForm;
+
+/* structures =============================================================== */
+/**
+ * Thermistor model
+ * Holds the Steinhart-Hart coefficients together with the terms that the
+ * conversions derive from them, so that they are computed once by
+ * iNtcModelInit() instead of at each conversion. The fields are private,
+ * the structure is declared here only to allow static or automatic
+ * allocation and must be used through the xNtcModel functions.
+ */
+typedef struct xNtcModel {
+  double dA[4];       /**< Steinhart-Hart coefficients a0..a3 */
+  double dSeed[3];    /**< quadratic approximation of ln(r) over 1/T */
+  double dSeedY;      /**< center of dSeed (1/T at 50 degree Celsius) */
+  eNtcForm eForm;     /**< form of dA, selects the conversion kernels */
+} xNtcModel;
 
 /* internal public functions ================================================ */
+/**
+ * Initialize a thermistor model
+ * @param xModel model to initialize
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @return 0, -1 if the coefficients can not be inverted (a1 is null)
+ */
+int iNtcModelInit (xNtcModel * xModel, const double dCoeff[4]);
+
+/**
+ * Form of Steinhart-Hart coefficients
+ * @param dCoeff Steinhart-Hart coefficients
+ * @return eNtcFormSimplified if a2 and a3 are null, eNtcFormStandard if
+ *         only a2 is null, eNtcFormExtended otherwise
+ */
+eNtcForm eNtcFormOf (const double dCoeff[4]);
+
+/**
+ * Name of a form
+ * @param eForm form
+ * @return "simplified", "standard" or "extended"
+ */
+const char * sNtcFormName (eNtcForm eForm);
+
+/**
+ * Create a thermistor model
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @return the model, NULL on error. Must be released with vNtcModelDelete()
+ */
+xNtcModel * xNtcModelNew (const double dCoeff[4]);
+
+/**
+ * Release a model created by xNtcModelNew()
+ * @param xModel model to release, may be NULL
+ */
+void vNtcModelDelete (xNtcModel * xModel);
+
+/**
+ * Conversion from temperature to resistance with a model
+ * ln(r) is seeded with a quadratic approximation stored in the model then
+ * refined by Newton iterations on the Steinhart-Hart polynom, the code path
+ * is the same for all values (no cube roots, no branches). The result
+ * matches the Cardano formula to a few ulps.
+ * @param xModel thermistor model
+ * @param dT temperature (in degree Celsius)
+ * @return corresponding resistance
+ */
+double dNtcModelTempToRes (const xNtcModel * xModel, double dT);
+
+/**
+ * Conversion from resistance to temperature with a model
+ * @param xModel thermistor model
+ * @param dR resistance (in Ohm)
+ * @return corresponding temperature
+ */
+double dNtcModelResToTemp (const xNtcModel * xModel, double dR);
+
+/**
+ * Conversion from resistance to temperature of an array with a model
+ * Same as vNtcResToTempArray()
+ * @param xModel thermistor model
+ * @param dR resistances (in Ohm), must be positive normal numbers
+ * @param dT corresponding temperatures (in degree Celsius), may be dR
+ * @param xCount number of values to convert
+ */
+void vNtcModelResToTempArray (const xNtcModel * xModel, const double dR[],
+                              double dT[], size_t xCount);
+
+/**
+ * Conversion from temperature to resistance of an array with a model
+ * Vectorized version of dNtcModelTempToRes(), the exponential is evaluated
+ * with SIMD instructions (fdlibm algorithm, less than 1 ulp).
+ * @param xModel thermistor model
+ * @param dT temperatures (in degree Celsius), above absolute zero
+ * @param dR corresponding resistances (in Ohm), may be dT
+ * @param xCount number of values to convert
+ */
+void vNtcModelTempToResArray (const xNtcModel * xModel, const double dT[],
+                              double dR[], size_t xCount);
+
 /**
  * Conversion from temperature to resistance
- * Calculates and returns resistance for given temperature
+ * Calculates and returns resistance for given temperature.
+ * Newton iterations start from the simplified polynom a0 + a1 ln r, no
+ * model is built; dNtcModelTempToRes() needs fewer iterations.
  * @param dT temperature (in degree Celsius)
  * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
  * @return corresponding resistance
@@ -48,6 +170,178 @@ double dNtcTempToRes (double dT, double dCoeff[]);
  */
 double dNtcResToTemp(double dR, double dCoeff[]);
 
+/**
+ * Conversion from resistance to temperature of an array
+ * Calculates temperature for each resistance of dR and stores it in dT.
+ * The logarithm and the polynom are evaluated several values at once with
+ * SIMD instructions, the instruction set is selected at run time (see
+ * iNtcIsaSet()). The maximum difference with
+ * dNtcResToTemp() is less than 1e-12 degree Celsius over the range of the
+ * tables of ntc-data (a few ulps on 1/T).
+ * @param dR resistances (in Ohm), must be positive normal numbers
+ * @param dT corresponding temperatures (in degree Celsius), may be dR
+ * @param xCount number of values to convert
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ */
+void vNtcResToTempArray (const double dR[], double dT[], size_t xCount,
+                         const double dCoeff[]);
+
+/**
+ * Conversion from resistance to temperature of an array, each value with
+ * its own coefficients
+ * Same kernel as vNtcResToTempArray() with the coefficients loaded per
+ * lane from a structure of arrays: dCoeff[k][i] is the coefficient a<sub>k</sub>
+ * of dR[i]. Used by the sensor banks (ntc-bank.h).
+ * @param dR resistances (in Ohm), must be positive normal numbers
+ * @param dT corresponding temperatures (in degree Celsius), may be dR
+ * @param xCount number of values to convert
+ * @param dCoeff four arrays of xCount coefficients
+ */
+void vNtcResToTempArraySoa (const double dR[], double dT[], size_t xCount,
+                            const double * const dCoeff[4]);
+
+/**
+ * Conversion from temperature to resistance of an array
+ * Builds a model with a cheaper seed than iNtcModelInit() and calls
+ * vNtcModelTempToResArray().
+ * @param dT temperatures (in degree Celsius), above absolute zero
+ * @param dR corresponding resistances (in Ohm), may be dT
+ * @param xCount number of values to convert
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ */
+void vNtcTempToResArray (const double dT[], double dR[], size_t xCount,
+                         const double dCoeff[]);
+
+/**
+ * Single precision conversion from temperature to resistance with a model
+ * Same algorithm as dNtcModelTempToRes() in float, the exponential is
+ * a Cephes polynom (less than 2 ulp) instead of libm. See fNtcResToTemp()
+ * for the accuracy.
+ * @param xModel thermistor model
+ * @param fT temperature (in degree Celsius)
+ * @return corresponding resistance
+ */
+float fNtcModelTempToRes (const xNtcModel * xModel, float fT);
+
+/**
+ * Single precision conversion from resistance to temperature with a model
+ * @param xModel thermistor model
+ * @param fR resistance (in Ohm), must be a positive normal number
+ * @return corresponding temperature
+ */
+float fNtcModelResToTemp (const xNtcModel * xModel, float fR);
+
+/**
+ * Single precision conversion from resistance to temperature of an array
+ * with a model
+ * Same as vNtcResToTempArrayf()
+ * @param xModel thermistor model
+ * @param fR resistances (in Ohm), must be positive normal numbers
+ * @param fT corresponding temperatures (in degree Celsius), may be fR
+ * @param xCount number of values to convert
+ */
+void vNtcModelResToTempArrayf (const xNtcModel * xModel, const float fR[],
+                               float fT[], size_t xCount);
+
+/**
+ * Single precision conversion from temperature to resistance of an array
+ * with a model
+ * Vectorized version of fNtcModelTempToRes().
+ * @param xModel thermistor model
+ * @param fT temperatures (in degree Celsius), above absolute zero
+ * @param fR corresponding resistances (in Ohm), may be fT
+ * @param xCount number of values to convert
+ */
+void vNtcModelTempToResArrayf (const xNtcModel * xModel, const float fT[],
+                               float fR[], size_t xCount);
+
+/**
+ * Single precision conversion from temperature to resistance
+ * Same algorithm as dNtcTempToRes() in float, see fNtcModelTempToRes().
+ * @param fT temperature (in degree Celsius)
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @return corresponding resistance
+ */
+float fNtcTempToRes (float fT, const double dCoeff[4]);
+
+/**
+ * Single precision conversion from resistance to temperature
+ * The logarithm is a Cephes polynom (less than 2 ulp) instead of libm and
+ * the coefficients are rounded to float. The error is dominated by the
+ * rounding of 1/T around 300 K, the worst case against dNtcResToTemp()
+ * over the range of the tables of ntc-data is:
+ * |       table           | range (degree) | dT max.  | R rel. max. |
+ * |-----------------------|----------------|----------|-------------|
+ * | avx-k3630             | -55..150       | 6.8e-5   | 3.4e-6      |
+ * | avx-ma3960            | -55..150       | 6.4e-5   | 4.1e-6      |
+ * | ms-1k2a1              | -40..125       | 7.5e-5   | 3.3e-6      |
+ * | murata-nxft15-10k     | -40..125       | 7.1e-5   | 3.5e-6      |
+ * .
+ * The columns give the temperature error (in degree Celsius) of
+ * fNtcResToTemp() and the relative resistance error of fNtcTempToRes(),
+ * the batch versions give the same results.
+ * @param fR resistance (in Ohm), must be a positive normal number
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ * @return corresponding temperature
+ */
+float fNtcResToTemp (float fR, const double dCoeff[4]);
+
+/**
+ * Single precision conversion from resistance to temperature of an array
+ * The kernel handles twice as many values per SIMD instruction as
+ * vNtcResToTempArray().
+ * @param fR resistances (in Ohm), must be positive normal numbers
+ * @param fT corresponding temperatures (in degree Celsius), may be fR
+ * @param xCount number of values to convert
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ */
+void vNtcResToTempArrayf (const float fR[], float fT[], size_t xCount,
+                          const double dCoeff[4]);
+
+/**
+ * Single precision conversion from temperature to resistance of an array
+ * Builds a model with a cheaper seed than iNtcModelInit() and calls
+ * vNtcModelTempToResArrayf().
+ * @param fT temperatures (in degree Celsius), above absolute zero
+ * @param fR corresponding resistances (in Ohm), may be fT
+ * @param xCount number of values to convert
+ * @param dCoeff Steinhart-Hart coefficients, calculates with ntc-coeff utility
+ */
+void vNtcTempToResArrayf (const float fT[], float fR[], size_t xCount,
+                          const double dCoeff[4]);
+
+/**
+ * Select the instruction set of the batch conversions
+ * On x86_64, the library contains SSE2, AVX2 and AVX-512 kernels whatever
+ * the compiler flags, the best one supported by the host is used by
+ * default. Forcing a level is intended for tests and benchmarks. AVX2 and
+ * AVX-512 kernels use fused multiply-add, their results may differ from the
+ * other levels by a few ulps.
+ * @param eIsa instruction set, eNtcIsaAuto to restore the default
+ * @return 0, -1 if the library or the host does not support eIsa
+ */
+int iNtcIsaSet (eNtcIsa eIsa);
+
+/**
+ * Instruction set of the batch conversions
+ * @return instruction set currently used
+ */
+eNtcIsa eNtcIsaGet (void);
+
+/**
+ * Test if an instruction set can be used on this host
+ * @param eIsa instruction set
+ * @return true if iNtcIsaSet() would accept eIsa
+ */
+int iNtcIsaSupported (eNtcIsa eIsa);
+
+/**
+ * Name of an instruction set
+ * @param eIsa instruction set
+ * @return static string, as "avx2"
+ */
+const char * sNtcIsaName (eNtcIsa eIsa);
+
 /* ========================================================================== */
 #ifdef __cplusplus
 }
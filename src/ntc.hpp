@@ -0,0 +1,339 @@
+/**
+ * @file ntc.hpp
+ * @brief NTC thermistor library (C++ compile-time models)
+ * @version 1.0
+ * @copyright GNU Lesser General Public License version 3
+ *            <http://www.gnu.org/licenses/lgpl.html>
+ * Copyright (c) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *******************************************************************************
+ * This program is free software: you can redistribute it and/or modif         *
+ *    it under the terms of the GNU Lesser General Public License as published *
+ *    by the Free Software Foundation, either version 3 of the License, or     *
+ *    (at your option) any later version.                                      *
+ *                                                                             *
+ *    This program is distributed in the hope that it will be useful,          *
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *    GNU Lesser General Public License for more details.                      *
+ *                                                                             *
+ *    You should have received a copy of the GNU Lesser General Public License *
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *******************************************************************************
+ */
+#ifndef _NTC_HPP_
+#define _NTC_HPP_
+/* ========================================================================== */
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "ntc.h"
+#include "ntc-lut.h"
+
+/**
+ * Compile-time thermistor models (C++17)
+ *
+ * The coefficients are given by a traits type, so that the model, its
+ * Horner schema and its lookup tables are resolved at compile time:
+ *
+ * @code
+ * struct Ma3960 {
+ *   static constexpr double a[] = {
+ *     1.384458976342609e-03, 2.393452650459891e-04,
+ *     4.184121390081160e-07, 5.134115012343303e-08
+ *   };
+ * };
+ * using Sensor = ntc::Model<Ma3960>;
+ *
+ * struct Divider {
+ *   static constexpr double series = 3000.0;
+ *   static constexpr double vref = 3.3;
+ *   static constexpr double vsupply = 0.0;
+ *   static constexpr int bits = 12;
+ *   static constexpr bool pullUp = true;
+ * };
+ * // 4096 temperatures in .rodata, nothing is computed at startup
+ * static constexpr auto table = ntc::adcTable<Sensor, Divider> ();
+ * @endcode
+ *
+ * Conversions are constexpr. When evaluated at run time and if the compiler
+ * tells it (__builtin_is_constant_evaluated, GCC 9 and clang 9), they use
+ * std::log and std::exp, otherwise they use the constexpr logarithm and
+ * exponential of this header (less than 2 ulps).
+ */
+namespace ntc {
+
+/** Absolute zero (in degree Celsius) */
+constexpr double tabs = -273.15;
+
+namespace detail {
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define NTC_HAS_CONSTANT_EVALUATED 1
+#endif
+#endif
+
+/* true at compile time, false at run time if the compiler can tell */
+constexpr bool
+constant () {
+#ifdef NTC_HAS_CONSTANT_EVALUATED
+  return __builtin_is_constant_evaluated ();
+#else
+  return true;
+#endif
+}
+
+/* Natural logarithm of a positive finite x */
+constexpr double
+ln (double x) {
+  constexpr double ln2 = 6.93147180559945309417e-01;
+  constexpr double sqrt2 = 1.41421356237309504880;
+  double s = 0.0, s2 = 0.0, term = 0.0, sum = 0.0;
+  int k = 0;
+
+  /* x = 2^k * m with sqrt(2)/2 <= m < sqrt(2) */
+  while (x >= sqrt2) {
+    x *= 0.5;
+    k++;
+  }
+  while (x < sqrt2 / 2.0) {
+    x *= 2.0;
+    k--;
+  }
+  /* ln(m) = 2 atanh(s), s = (m - 1)/(m + 1), |s| < 0.172 */
+  s = (x - 1.0) / (x + 1.0);
+  s2 = s * s;
+  term = s;
+  for (int n = 1; n < 40; n += 2) {
+    sum += term / n;
+    term *= s2;
+  }
+  return 2.0 * sum + k * ln2;
+}
+
+/* Exponential of x, |x| < 700 */
+constexpr double
+exp (double x) {
+  constexpr double ln2 = 6.93147180559945309417e-01;
+  double r = 0.0, term = 1.0, sum = 1.0;
+  int k = 0;
+
+  /* x = k ln2 + r with |r| <= ln2/2 */
+  k = static_cast<int> (x / ln2 + (x < 0 ? -0.5 : 0.5));
+  r = x - k * ln2;
+  for (int n = 1; n < 24; n++) {
+    term *= r / n;
+    sum += term;
+  }
+  for (; k > 0; k--) {
+    sum *= 2.0;
+  }
+  for (; k < 0; k++) {
+    sum *= 0.5;
+  }
+  return sum;
+}
+
+/*
+ * Temperature rounded to fixed point with saturation, floor(t * scale +
+ * 0.5) as the C tables (ntc-lut.c)
+ */
+constexpr int16_t
+fixed (double t) {
+  const double u = t * NTC_LUT_FIXED_SCALE + 0.5;
+  int32_t i = 0;
+
+  if (u != u) {
+    return NTC_LUT_INVALID;
+  }
+  if (u >= INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (u < INT16_MIN + 1) {
+    return INT16_MIN + 1;
+  }
+  i = static_cast<int32_t> (u);
+  return static_cast<int16_t> (i > u ? i - 1 : i);
+}
+
+/* Horner schema unrolled at compile time: a[N-1] x^(N-1) + ... + a[0] */
+template <class Coeff, std::size_t... I>
+constexpr double
+horner (double x, std::index_sequence<I...>) {
+  double r = 0.0;
+
+  ( (r = r * x + Coeff::a[sizeof... (I) - 1 - I]), ...);
+  return r;
+}
+
+/* Derivative of the polynom, unrolled */
+template <class Coeff, std::size_t... I>
+constexpr double
+derivative (double x, std::index_sequence<I...>) {
+  double r = 0.0;
+
+  ( (r = r * x + (sizeof... (I) - I) * Coeff::a[sizeof... (I) - I]), ...);
+  return r;
+}
+
+} // namespace detail
+
+/**
+ * Thermistor model
+ * @tparam Coeff traits type with a static constexpr double a[] array of
+ * Steinhart-Hart coefficients, a[0] first
+ * @tparam Degree degree of the polynom, 1 to 3, only a[0]..a[Degree] are used
+ */
+template <class Coeff, int Degree = 3>
+struct Model {
+  static_assert (Degree >= 1 && Degree <= 3, "degree must be 1, 2 or 3");
+  static_assert (sizeof (Coeff::a) / sizeof (Coeff::a[0]) > Degree,
+                 "not enough coefficients for the degree");
+
+  /** Degree of the polynom */
+  static constexpr int degree = Degree;
+
+  /**
+   * 1/T polynom in ln(r)
+   * @param x ln(r)
+   * @return reciprocal absolute temperature
+   */
+  static constexpr double
+  poly (double x) {
+    return detail::horner<Coeff> (x, std::make_index_sequence<Degree + 1> ());
+  }
+
+  /**
+   * Conversion from resistance to temperature
+   * @param r resistance (in Ohm)
+   * @return corresponding temperature (in degree Celsius)
+   */
+  static constexpr double
+  resToTemp (double r) {
+    return 1.0 / poly (detail::constant () ? detail::ln (r) : std::log (r)) + tabs;
+  }
+
+  /**
+   * Conversion from temperature to resistance
+   * Newton iterations from the simplified polynom a0 + a1 ln(r).
+   * @param t temperature (in degree Celsius)
+   * @return corresponding resistance (in Ohm)
+   */
+  static constexpr double
+  tempToRes (double t) {
+    const double y = 1.0 / (t - tabs);
+    double x = (y - Coeff::a[0]) / Coeff::a[1];
+
+    for (int i = 0; i < (Degree > 1 ? 6 : 0); i++) {
+      x -= (poly (x) - y) /
+           detail::derivative<Coeff> (x, std::make_index_sequence<Degree> ());
+    }
+    return detail::constant () ? detail::exp (x) : std::exp (x);
+  }
+
+  /**
+   * Coefficients padded with zeros to 4 terms, as used by the C functions
+   * @return Steinhart-Hart coefficients
+   */
+  static constexpr std::array<double, 4>
+  coefficients () {
+    std::array<double, 4> c{};
+
+    for (int i = 0; i <= Degree; i++) {
+      c[i] = Coeff::a[i];
+    }
+    return c;
+  }
+
+  /**
+   * Initialize a C model
+   * @param m model to initialize
+   * @return 0, -1 on error
+   */
+  static int
+  init (xNtcModel & m) {
+    const auto c = coefficients ();
+    return iNtcModelInit (&m, c.data ());
+  }
+};
+
+/**
+ * Resistance of the thermistor for an ADC code, see dNtcAdcCodeToRes()
+ * @tparam Adc traits type with static constexpr members series (Ohm),
+ * vref, vsupply (0 if equal to vref), bits and pullUp (bool)
+ * @param code ADC code
+ * @return resistance (in Ohm), 0 if the code is outside the divider range
+ */
+template <class Adc>
+constexpr double
+adcCodeToRes (double code) {
+  const double vs = Adc::vsupply > 0.0 ? Adc::vsupply : Adc::vref;
+  const double k = (code + 0.5) / static_cast<double> (1UL << Adc::bits) *
+                   Adc::vref / vs;
+
+  if (k <= 0.0 || k >= 1.0) {
+    return 0.0;
+  }
+  return Adc::pullUp ? Adc::series * k / (1.0 - k) :
+         Adc::series * (1.0 - k) / k;
+}
+
+/**
+ * Lookup table of the temperature for each ADC code
+ * With T = int16_t, the temperatures are in 1/NTC_LUT_FIXED_SCALE degree
+ * Celsius (saturated). Codes outside the divider range give NTC_LUT_INVALID
+ * for int16_t and NaN for floating-point T.
+ * @tparam M thermistor model
+ * @tparam Adc divider and ADC traits, see adcCodeToRes()
+ * @tparam T type of the entries, double, float or int16_t
+ * @return the table, indexed by code
+ */
+template <class M, class Adc, class T = double>
+constexpr std::array<T, (1UL << Adc::bits)>
+adcTable () {
+  static_assert (Adc::bits >= 1 && Adc::bits <= 16, "1 to 16 bits");
+  std::array<T, (1UL << Adc::bits)> table{};
+
+  for (std::size_t c = 0; c < table.size (); c++) {
+    const double r = adcCodeToRes<Adc> (static_cast<double> (c));
+
+    if constexpr (std::is_integral<T>::value) {
+      table[c] = r <= 0.0 ? NTC_LUT_INVALID :
+                 static_cast<T> (detail::fixed (M::resToTemp (r)));
+    }
+    else {
+      table[c] = r <= 0.0 ? static_cast<T> (NAN) :
+                 static_cast<T> (M::resToTemp (r));
+    }
+  }
+  return table;
+}
+
+/**
+ * Table of resistances for equally spaced temperatures
+ * @tparam M thermistor model
+ * @tparam N number of entries
+ * @param tmin first temperature (in degree Celsius)
+ * @param tstep temperature step (in degree Celsius)
+ * @return resistances (in Ohm) for tmin, tmin + tstep, ...
+ */
+template <class M, std::size_t N>
+constexpr std::array<double, N>
+resTable (double tmin, double tstep) {
+  std::array<double, N> table{};
+
+  for (std::size_t i = 0; i < N; i++) {
+    table[i] = M::tempToRes (tmin + i * tstep);
+  }
+  return table;
+}
+
+} // namespace ntc
+
+/* ========================================================================== */
+#endif /* _NTC_HPP_ defined */
@@ -0,0 +1,1184 @@
+/*
+ * NTC thermistor library
+ * Version 1.0
+ * Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307
+ * USA
+ */
+
+/** @file bench.c
+ * Microbenchmarks and accuracy regression harness of the conversions and
+ * of the fit.
+ * For each T-R table, the coefficients are fitted, then random
+ * temperatures over the range of the table and their resistances are
+ * converted by the scalar, batch (for each instruction set supported),
+ * single precision, lookup table, spline and fixed point paths, and round
+ * trip from resistance to temperature and back. Alarms on resistances and
+ * on ADC codes (of the same resistances) scan them, their setpoints are
+ * just beyond the range of the table so that the rows give the rate of the
+ * readings that change nothing. The fit of the table and
+ * of synthetic tables of 100 to 10^5 pairs is measured with each method.
+ * Each time is the minimum of several runs.
+ *
+ * The accuracy of each conversion is measured against the Steinhart-Hart
+ * polynom in long double over all the values: the error in degree Celsius
+ * (of the temperature of the resistance found for the inverse
+ * conversions) and in ULPs of the output, the ULP of the absolute
+ * temperature or of the resistance for floating point outputs, the unit of
+ * the output for fixed point ones. The splines are approximations, their
+ * ULP columns are "-" (null in JSON). The error of a fit is over the pairs of
+ * its table.
+ *
+ * The results are written as CSV (default) or JSON, one row per
+ * measurement: bench, table, isa, count, ns_per_value, mvalues_per_s,
+ * max_error, mean_error, max_ulp, mean_ulp. With a baseline (a previous
+ * CSV output, test/bench/baseline.csv for make regress), a row (same
+ * bench, table, isa and count) with a value whose error is not finite,
+ * whose maximal error or ULP exceeds its baseline by more than the accuracy
+ * tolerance, or whose time exceeds its baseline by more than the speed
+ * tolerance (after 3 more tries), is reported on stderr and the exit
+ * status is 1. With a baseline too,
+ * t2r-scalar (dNtcTempToRes()) must not be slower than t2r-cardano, the
+ * Cardano formula of the version 1.0 measured on the same values.
+ *
+ * Usage: bench [-n values] [-r runs] [-p pairs] [-f csv|json] [-o file]
+ *              [-b baseline] [-a tolerance] [-s tolerance] [table ...]
+ *
+ * The default is 2^18 values, 5 runs, fits up to 10^5 pairs, accuracy
+ * tolerance 0.1 (10 %, and at least 1e-9 degree and 1 ULP), speed
+ * tolerance 1 (twice the baseline time, and at least 1 ns more) and the
+ * tables of ntc-data.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <glob.h>
+#include <unistd.h>
+#include <ntc.h>
+#include <ntc-lut.h>
+#include <ntc-spline.h>
+#include <ntc-fixed.h>
+#include <ntc-fit.h>
+#include <ntc-alarm.h>
+
+/** Default number of values converted. */
+#define BENCH_VALUES (1 << 18)
+
+/** Default number of runs of each measurement. */
+#define BENCH_RUNS 5
+
+/** Default number of pairs of the largest table fitted. */
+#define FIT_PAIRS 100000
+
+/** Resolution of the ADC of the lookup tables. */
+#define LUT_BITS 12
+
+/** Maximal error of the splines (in degree Celsius). */
+#define SPLINE_ERROR 0.01
+
+/** Distance of the setpoints of the alarms to the range of the table. */
+#define ALARM_MARGIN 5.0
+
+/** Default tolerances of the accuracy and of the speed, relative. */
+#define ACCURACY_TOLERANCE 0.1
+#define SPEED_TOLERANCE 1.0
+
+/** Absolute tolerances of the accuracy (in degree Celsius and ULP). */
+#define ERROR_FLOOR 1e-9
+#define ULP_FLOOR 1.0
+
+/** Absolute tolerance of the speed (in ns per value). */
+#define SPEED_FLOOR 1.0
+
+/** Tries of a measurement slower than its baseline. */
+#define SPEED_RETRIES 3
+
+/** Absolute zero. */
+#define TABS (-273.15L)
+
+/**
+ * Accuracy measured, by the output of the conversion
+ */
+typedef enum eKind {
+  eR2t = 0,     /**< dR to dOut */
+  eR2tFloat,    /**< fR to fOut */
+  eT2r,         /**< dT to dOut */
+  eT2rFloat,    /**< fT to fOut */
+  eLut,         /**< uCode to dOut */
+  eLutFixed,    /**< uCode to iOut16 */
+  eFixR2t,      /**< uR to iOut */
+  eFixT2r,      /**< iT to uOut */
+  eRoundTrip,   /**< dR to dOut through the temperature */
+  eSpline,      /**< dR to dOut, approximation without ULP */
+  eFit,         /**< xFit of the table sPath */
+  eAlarm        /**< no output, no accuracy */
+} eKind;
+
+/**
+ * Inputs and models of the conversions of a table
+ */
+typedef struct xCase {
+  size_t xCount;
+  double dCoeff[4];
+  double dRange[2];       /**< temperatures of the table */
+  xNtcModel xModel;
+  xNtcAdcConfig xCfg;
+  xNtcLut * xLut;
+  xNtcLut * xLutFixed;
+  xNtcSpline * xSpline;
+  xNtcFixModel xFix;
+  double * dR;
+  double * dT;
+  float * fR;
+  float * fT;
+  uint16_t * uCode;
+  uint16_t * uAdc;        /**< codes of dR */
+  uint32_t * uR;
+  int32_t * iT;
+  double * dOut;          /**< outputs, the inputs are not modified */
+  double * dTmp;
+  float * fOut;
+  int16_t * iOut16;
+  uint32_t * uOut;
+  int32_t * iOut;
+  const char * sPath;     /**< table fitted */
+  xNtcFitOptions xOptions;
+  xNtcFitResult xFit;
+  xNtcAlarm * xAlarmRes;
+  xNtcAlarm * xAlarmCode;
+} xCase;
+
+/**
+ * Measured function
+ */
+typedef void (*vRun) (xCase * c);
+
+/**
+ * Conversion benchmark
+ */
+typedef struct xBench {
+  const char * sName;
+  vRun vFunc;
+  eKind eKind;
+  int bIsa;               /**< measured for each instruction set */
+  const char * sRef;      /**< benchmark measured before, not faster */
+} xBench;
+
+/**
+ * Measurement
+ */
+typedef struct xMeasure {
+  double dTime;           /**< time of the values (in seconds) */
+  double dMaxError;       /**< in degree Celsius */
+  double dMeanError;
+  double dMaxUlp;
+  double dMeanUlp;
+  long long llCount;      /**< values of the accuracy */
+  long long llNonFinite;  /**< values whose error is not finite */
+} xMeasure;
+
+/**
+ * Row of a baseline
+ */
+typedef struct xBase {
+  char sKey[160];         /**< bench,table,isa,count */
+  double dNs;
+  double dMaxError;
+  double dMaxUlp;
+  int bSeen;
+} xBase;
+
+/** Output of the results. */
+static FILE * xOut;
+
+/** True for JSON. */
+static int bJson;
+
+/** Number of rows written. */
+static int iRows;
+
+/** Number of runs of each measurement. */
+static int iRuns = BENCH_RUNS;
+
+/** Baseline. */
+static xBase * xBases;
+static size_t xBaseCount;
+
+/** Tolerances of the comparison with the baseline. */
+static double dAccuracyTol = ACCURACY_TOLERANCE;
+static double dSpeedTol = SPEED_TOLERANCE;
+
+/** Rows worse than the baseline. */
+static int iRegressions;
+
+/** Row of the version 1.0, gate of the scalar inverse conversion. */
+#define CARDANO_BENCH "t2r-cardano"
+
+/**
+ * Monotonic time.
+ * @return time in seconds.
+ */
+static double
+dNow (void) {
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* references =============================================================== */
+/**
+ * Temperature of a resistance in long double.
+ * @param a coefficients.
+ * @param r resistance.
+ * @return temperature (in degree Celsius).
+ */
+static long double
+ldResToTemp (const double a[4], long double r) {
+  long double x = logl (r);
+
+  return 1.0L / ( ( (a[3] * x + a[2]) * x + a[1]) * x + a[0]) + TABS;
+}
+
+/**
+ * Resistance of a temperature in long double, Newton iterations from the
+ * root of the linear terms.
+ * @param a coefficients.
+ * @param t temperature (in degree Celsius).
+ * @return resistance.
+ */
+static long double
+ldTempToRes (const double a[4], long double t) {
+  long double y = 1.0L / (t - TABS), x = (y - a[0]) / a[1], p;
+  int i;
+
+  for (i = 0; i < 12; i++) {
+
+    p = ( ( (a[3] * x + a[2]) * x + a[1]) * x + a[0]) - y;
+    x -= p / ( (3.0L * a[3] * x + 2.0L * a[2]) * x + a[1]);
+  }
+  return expl (x);
+}
+
+/**
+ * ULP of a floating point number.
+ * @param x number.
+ * @param bits bits of the mantissa, 52 (double) or 23 (float).
+ * @return ULP of x.
+ */
+static long double
+ldUlp (long double x, int bits) {
+
+  return ldexpl (1.0L, ilogbl (x) - bits);
+}
+
+/**
+ * Adds an error to a measurement.
+ * @param m measurement.
+ * @param e error (in degree Celsius).
+ * @param u error (in ULP).
+ */
+static void
+vAdd (xMeasure * m, long double e, long double u) {
+
+  e = fabsl (e);
+  u = fabsl (u);
+  m->llNonFinite += !isfinite (e);
+  m->dMaxError = (e > m->dMaxError) ? e : m->dMaxError;
+  m->dMaxUlp = (u > m->dMaxUlp) ? u : m->dMaxUlp;
+  m->dMeanError += e;
+  m->dMeanUlp += u;
+  m->llCount++;
+}
+
+/**
+ * Adds the error of a pair of a table.
+ * @param pvUser measurement, the coefficients follow it.
+ * @return 0.
+ */
+static int
+iFitError (void * pvUser, double dTemp, double dRes) {
+  xMeasure * m = pvUser;
+
+  vAdd (m, ldResToTemp ( (const double *) (m + 1), dRes) - dTemp, 0.0L);
+  return 0;
+}
+
+/**
+ * Accuracy of the last outputs.
+ * @param c case.
+ * @param k outputs.
+ * @param m measurement.
+ */
+static void
+vAccuracy (const xCase * c, eKind k, xMeasure * m) {
+  struct {
+    xMeasure m;
+    double dCoeff[4];
+  } fit;
+  const double * a = c->dCoeff;
+  long double r, t, ref;
+  size_t i;
+
+  if (k == eFit) {
+
+    memset (&fit, 0, sizeof (fit));
+    memcpy (fit.dCoeff, c->xFit.dCoeff, sizeof (fit.dCoeff));
+    llNtcFitReadTable (c->sPath, iFitError, &fit, NULL);
+    fit.m.dTime = m->dTime;
+    *m = fit.m;
+  }
+  for (i = 0; (k != eFit) && (i < c->xCount); i++) {
+
+    switch (k) {
+
+      case eR2t:
+        ref = ldResToTemp (a, c->dR[i]);
+        vAdd (m, c->dOut[i] - ref, (c->dOut[i] - ref) / ldUlp (ref - TABS, 52));
+        break;
+      case eR2tFloat:
+        ref = ldResToTemp (a, c->fR[i]);
+        vAdd (m, c->fOut[i] - ref, (c->fOut[i] - ref) / ldUlp (ref - TABS, 23));
+        break;
+      case eT2r:
+        ref = ldTempToRes (a, c->dT[i]);
+        vAdd (m, ldResToTemp (a, c->dOut[i]) - c->dT[i],
+              (c->dOut[i] - ref) / ldUlp (ref, 52));
+        break;
+      case eT2rFloat:
+        ref = ldTempToRes (a, c->fT[i]);
+        vAdd (m, ldResToTemp (a, c->fOut[i]) - c->fT[i],
+              (c->fOut[i] - ref) / ldUlp (ref, 23));
+        break;
+      case eLut:
+      case eLutFixed:
+        /* codes of the range of the table only */
+        r = dNtcAdcCodeToRes (&c->xCfg, c->uCode[i]);
+        ref = (r > 0.0L) ? ldResToTemp (a, r) : NAN;
+        if (! (ref >= c->dRange[0]) || ! (ref <= c->dRange[1])) {
+          break;
+        }
+        t = (k == eLut) ? c->dOut[i] :
+            (long double) c->iOut16[i] / NTC_LUT_FIXED_SCALE;
+        vAdd (m, t - ref, (k == eLut) ? (t - ref) / ldUlp (ref - TABS, 52) :
+              (t - ref) * NTC_LUT_FIXED_SCALE);
+        break;
+      case eFixR2t:
+        ref = ldResToTemp (a, ldexpl (c->uR[i], -NTC_FIX_RES_SHIFT));
+        t = (long double) c->iOut[i] / NTC_FIX_TEMP_SCALE;
+        vAdd (m, t - ref, (t - ref) * NTC_FIX_TEMP_SCALE);
+        break;
+      case eFixT2r:
+        t = (long double) c->iT[i] / NTC_FIX_TEMP_SCALE;
+        r = ldexpl (c->uOut[i], -NTC_FIX_RES_SHIFT);
+        ref = ldTempToRes (a, t);
+        vAdd (m, ldResToTemp (a, r) - t,
+              ldexpl (r - ref, NTC_FIX_RES_SHIFT));
+        break;
+      case eSpline:
+        ref = ldResToTemp (a, c->dR[i]);
+        vAdd (m, c->dOut[i] - ref, 0.0L);
+        break;
+      case eRoundTrip:
+        vAdd (m, ldResToTemp (a, c->dOut[i]) - ldResToTemp (a, c->dR[i]),
+              (c->dOut[i] - (long double) c->dR[i]) / ldUlp (c->dR[i], 52));
+        break;
+      default:
+        break;
+    }
+  }
+  if (m->llCount) {
+
+    m->dMeanError /= m->llCount;
+    m->dMeanUlp /= m->llCount;
+  }
+  if (k == eSpline) {
+
+    m->dMaxUlp = m->dMeanUlp = NAN;
+  }
+}
+
+/* measurements ============================================================= */
+/**
+ * Minimal time of runs of a function.
+ * @param vFunc function.
+ * @param c case.
+ * @return time (in seconds).
+ */
+static double
+dTime (vRun vFunc, xCase * c) {
+  double t0, t, best = INFINITY;
+  int i;
+
+  vFunc (c);
+  for (i = 0; i < iRuns; i++) {
+
+    t0 = dNow();
+    vFunc (c);
+    t = dNow() - t0;
+    best = (t < best) ? t : best;
+  }
+  return best;
+}
+
+/**
+ * Row of the baseline.
+ * @param sKey bench,table,isa,count.
+ * @return the row, NULL if not in the baseline.
+ */
+static xBase *
+xFindBase (const char * sKey) {
+  size_t i;
+
+  for (i = 0; i < xBaseCount; i++) {
+
+    if (strcmp (xBases[i].sKey, sKey) == 0) {
+
+      return &xBases[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Reads a baseline, a CSV output of the benchmark.
+ * @param sPath file.
+ * @return 0, -1 on error.
+ */
+static int
+iReadBase (const char * sPath) {
+  char line[512], * p;
+  FILE * f;
+  xBase * b;
+  int i;
+
+  f = fopen (sPath, "r");
+  if ( (f == NULL) || (fgets (line, sizeof (line), f) == NULL)) {
+
+    return -1;
+  }
+  while (fgets (line, sizeof (line), f)) {
+
+    b = realloc (xBases, (xBaseCount + 1) * sizeof (xBase));
+    if (b == NULL) {
+
+      fclose (f);
+      return -1;
+    }
+    xBases = b;
+    b = &xBases[xBaseCount];
+    memset (b, 0, sizeof (xBase));
+    /* key: the first four fields */
+    for (p = line, i = 0; *p && (i < 4); p++) {
+      i += (*p == ',');
+    }
+    if ( (i < 4) || ( (size_t) (p - line) > sizeof (b->sKey))) {
+      continue;
+    }
+    memcpy (b->sKey, line, p - line - 1);
+    /* "-" for a conversion without ULP */
+    b->dMaxUlp = NAN;
+    if (sscanf (p, "%lf,%*[^,],%lf,%*[^,],%lf", &b->dNs,
+                &b->dMaxError, &b->dMaxUlp) >= 2) {
+      xBaseCount++;
+    }
+  }
+  fclose (f);
+  return 0;
+}
+
+/**
+ * Measures, compares with the baseline and writes a result.
+ * @param sName benchmark.
+ * @param sTable table.
+ * @param sIsa instruction set, "-" if not applicable.
+ * @param vFunc function measured.
+ * @param k outputs of the function.
+ * @param c case.
+ * @param xCount number of values of a run.
+ * @return time (in ns per value).
+ */
+static double
+dMeasure (const char * sName, const char * sTable, const char * sIsa,
+          vRun vFunc, eKind k, xCase * c, size_t xCount) {
+  char key[160];
+  xMeasure m;
+  xBase * b;
+  double ns, t;
+  int i;
+
+  memset (&m, 0, sizeof (m));
+  m.dTime = dTime (vFunc, c);
+  vAccuracy (c, k, &m);
+  ns = m.dTime / xCount * 1e9;
+
+  snprintf (key, sizeof (key), "%s,%s,%s,%zu", sName, sTable, sIsa,
+            xCount);
+  b = xFindBase (key);
+  if (b) {
+
+    b->bSeen = 1;
+    for (i = 0; (i < SPEED_RETRIES) &&
+         (ns > b->dNs * (1.0 + dSpeedTol) + SPEED_FLOOR); i++) {
+
+      t = dTime (vFunc, c) / xCount * 1e9;
+      ns = (t < ns) ? t : ns;
+    }
+    if (ns > b->dNs * (1.0 + dSpeedTol) + SPEED_FLOOR) {
+
+      fprintf (stderr, "%s: %.4f ns per value, baseline %.4f\n", key, ns,
+               b->dNs);
+      iRegressions++;
+    }
+    if (m.llNonFinite) {
+
+      fprintf (stderr, "%s: %lld values of %lld not finite\n", key,
+               m.llNonFinite, m.llCount);
+      iRegressions++;
+    }
+    else if ( (m.dMaxError > b->dMaxError * (1.0 + dAccuracyTol) +
+               ERROR_FLOOR) ||
+              (m.dMaxUlp > b->dMaxUlp * (1.0 + dAccuracyTol) + ULP_FLOOR)) {
+
+      fprintf (stderr, "%s: max. error %.3e (%.1f ULP), baseline %.3e "
+               "(%.1f ULP)\n", key, m.dMaxError, m.dMaxUlp, b->dMaxError,
+               b->dMaxUlp);
+      iRegressions++;
+    }
+  }
+
+  if (bJson) {
+
+    fprintf (xOut, "%s  { \"bench\": \"%s\", \"table\": \"%s\", "
+             "\"isa\": \"%s\", \"count\": %zu, \"ns_per_value\": %.4f, "
+             "\"mvalues_per_s\": %.3f, \"max_error\": %.3e, "
+             "\"mean_error\": %.3e, ",
+             iRows ? ",\n" : "", sName, sTable, sIsa, xCount, ns, 1e3 / ns,
+             m.dMaxError, m.dMeanError);
+    if (isnan (m.dMaxUlp)) {
+
+      fprintf (xOut, "\"max_ulp\": null, \"mean_ulp\": null }");
+    }
+    else {
+
+      fprintf (xOut, "\"max_ulp\": %.1f, \"mean_ulp\": %.3f }", m.dMaxUlp,
+               m.dMeanUlp);
+    }
+  }
+  else {
+
+    fprintf (xOut, "%s,%.4f,%.3f,%.3e,%.3e,", key, ns, 1e3 / ns,
+             m.dMaxError, m.dMeanError);
+    if (isnan (m.dMaxUlp)) {
+
+      fprintf (xOut, "-,-\n");
+    }
+    else {
+
+      fprintf (xOut, "%.1f,%.3f\n", m.dMaxUlp, m.dMeanUlp);
+    }
+  }
+  iRows++;
+  return ns;
+}
+
+/**
+ * Compares the time of a row with the one of its reference, measured
+ * before on the same values.
+ * @param sName benchmark.
+ * @param sTable table.
+ * @param vFunc function measured.
+ * @param c case.
+ * @param ns time of the row (in ns per value).
+ * @param sRef reference benchmark.
+ * @param dRef time of the reference (in ns per value).
+ */
+static void
+vCompareRef (const char * sName, const char * sTable, vRun vFunc, xCase * c,
+             double ns, const char * sRef, double dRef) {
+  double t;
+  int i;
+
+  for (i = 0; (i < SPEED_RETRIES) && (ns > dRef + SPEED_FLOOR); i++) {
+
+    t = dTime (vFunc, c) / c->xCount * 1e9;
+    ns = (t < ns) ? t : ns;
+  }
+  if (ns > dRef + SPEED_FLOOR) {
+
+    fprintf (stderr, "%s,%s: %.4f ns per value, %s %.4f\n", sName, sTable,
+             ns, sRef, dRef);
+    iRegressions++;
+  }
+}
+
+/* conversions ============================================================== */
+static void
+vScalarResToTemp (xCase * c) {
+  size_t i;
+
+  for (i = 0; i < c->xCount; i++) {
+
+    c->dOut[i] = dNtcResToTemp (c->dR[i], c->dCoeff);
+  }
+}
+
+static void
+vScalarTempToRes (xCase * c) {
+  size_t i;
+
+  for (i = 0; i < c->xCount; i++) {
+
+    c->dOut[i] = dNtcTempToRes (c->dT[i], c->dCoeff);
+  }
+}
+
+/*
+ * Cardano formula of the version 1.0 of the library, reference of the
+ * cost of dNtcTempToRes().
+ */
+static void
+vCardanoTempToRes (xCase * c) {
+  const double * a = c->dCoeff;
+  double y, u, v, p, q, b, d, e;
+  size_t i;
+
+  for (i = 0; i < c->xCount; i++) {
+
+    y = 1.0 / (c->dT[i] - (double) TABS);
+    d = (a[0] - y) / a[3];
+    e = a[1] / a[3];
+    b = a[2] / a[3];
+    q = 2.0 / 27.0 * b * b * b - 1.0 / 3.0 * b * e + d;
+    p = e - 1.0 / 3.0 * b * b;
+    v = - pow (q / 2.0 + sqrt (q * q / 4.0 + p * p * p / 27.0), 1.0 / 3.0);
+    u =   pow (-q / 2.0 + sqrt (q * q / 4.0 + p * p * p / 27.0), 1.0 / 3.0);
+    c->dOut[i] = exp (u + v - b / 3.0);
+  }
+}
+
+static void
+vModelResToTemp (xCase * c) {
+  size_t i;
+
+  for (i = 0; i < c->xCount; i++) {
+
+    c->dOut[i] = dNtcModelResToTemp (&c->xModel, c->dR[i]);
+  }
+}
+
+static void
+vModelTempToRes (xCase * c) {
+  size_t i;
+
+  for (i = 0; i < c->xCount; i++) {
+
+    c->dOut[i] = dNtcModelTempToRes (&c->xModel, c->dT[i]);
+  }
+}
+
+static void
+vScalarRoundTrip (xCase * c) {
+  size_t i;
+
+  for (i = 0; i < c->xCount; i++) {
+
+    c->dOut[i] = dNtcTempToRes (dNtcResToTemp (c->dR[i], c->dCoeff),
+                                c->dCoeff);
+  }
+}
+
+static void
+vModelRoundTrip (xCase * c) {
+  size_t i;
+
+  for (i = 0; i < c->xCount; i++) {
+
+    c->dOut[i] = dNtcModelTempToRes (&c->xModel,
+                                     dNtcModelResToTemp (&c->xModel, c->dR[i]));
+  }
+}
+
+static void
+vBatchResToTemp (xCase * c) {
+
+  vNtcModelResToTempArray (&c->xModel, c->dR, c->dOut, c->xCount);
+}
+
+static void
+vBatchTempToRes (xCase * c) {
+
+  vNtcModelTempToResArray (&c->xModel, c->dT, c->dOut, c->xCount);
+}
+
+static void
+vBatchRoundTrip (xCase * c) {
+
+  vNtcModelResToTempArray (&c->xModel, c->dR, c->dTmp, c->xCount);
+  vNtcModelTempToResArray (&c->xModel, c->dTmp, c->dOut, c->xCount);
+}
+
+static void
+vBatchResToTempf (xCase * c) {
+
+  vNtcModelResToTempArrayf (&c->xModel, c->fR, c->fOut, c->xCount);
+}
+
+static void
+vBatchTempToResf (xCase * c) {
+
+  vNtcModelTempToResArrayf (&c->xModel, c->fT, c->fOut, c->xCount);
+}
+
+static void
+vLutCodeToTemp (xCase * c) {
+
+  vNtcLutCodeToTempArray (c->xLut, c->uCode, c->dOut, c->xCount);
+}
+
+static void
+vLutCodeToTempFixed (xCase * c) {
+
+  vNtcLutCodeToTempFixedArray (c->xLutFixed, c->uCode, c->iOut16,
+                               c->xCount);
+}
+
+static void
+vSplineResToTemp (xCase * c) {
+
+  vNtcSplineResToTempArray (c->xSpline, c->dR, c->dOut, c->xCount);
+}
+
+static void
+vFixResToTemp (xCase * c) {
+
+  vNtcFixResToTempArray (&c->xFix, c->uR, c->iOut, c->xCount);
+}
+
+static void
+vFixTempToRes (xCase * c) {
+
+  vNtcFixTempToResArray (&c->xFix, c->iT, c->uOut, c->xCount);
+}
+
+static void
+vAlarmRes (xCase * c) {
+  xNtcAlarmEvent ev[2];
+  size_t i, n;
+
+  for (i = 0; i < c->xCount;) {
+
+    n = 2;
+    i += xNtcAlarmRes (c->xAlarmRes, &c->dR[i], c->xCount - i, ev, &n);
+  }
+}
+
+static void
+vAlarmCode (xCase * c) {
+  xNtcAlarmEvent ev[2];
+  size_t i, n;
+
+  for (i = 0; i < c->xCount;) {
+
+    n = 2;
+    i += xNtcAlarmCode (c->xAlarmCode, &c->uAdc[i], c->xCount - i, ev, &n);
+  }
+}
+
+static void
+vFit (xCase * c) {
+
+  iNtcFitTable (c->sPath, &c->xOptions, &c->xFit);
+}
+
+/** Conversion benchmarks. */
+static const xBench xBenchs[] = {
+  { "r2t-scalar", vScalarResToTemp, eR2t, 0 },
+  { CARDANO_BENCH, vCardanoTempToRes, eT2r, 0 },
+  { "t2r-scalar", vScalarTempToRes, eT2r, 0, CARDANO_BENCH },
+  { "roundtrip-scalar", vScalarRoundTrip, eRoundTrip, 0 },
+  { "r2t-model", vModelResToTemp, eR2t, 0 },
+  { "t2r-model", vModelTempToRes, eT2r, 0 },
+  { "roundtrip-model", vModelRoundTrip, eRoundTrip, 0 },
+  { "r2t-batch", vBatchResToTemp, eR2t, 1 },
+  { "t2r-batch", vBatchTempToRes, eT2r, 1 },
+  { "roundtrip-batch", vBatchRoundTrip, eRoundTrip, 1 },
+  { "r2t-batch-float", vBatchResToTempf, eR2tFloat, 1 },
+  { "t2r-batch-float", vBatchTempToResf, eT2rFloat, 1 },
+  { "r2t-lut", vLutCodeToTemp, eLut, 0 },
+  { "r2t-lut-fixed", vLutCodeToTempFixed, eLutFixed, 0 },
+  { "r2t-spline", vSplineResToTemp, eSpline, 0 },
+  { "r2t-fixed", vFixResToTemp, eFixR2t, 1 },
+  { "t2r-fixed", vFixTempToRes, eFixT2r, 1 },
+  { "alarm-res", vAlarmRes, eAlarm, 0 },
+  { "alarm-code", vAlarmCode, eAlarm, 0 },
+};
+
+/* tables =================================================================== */
+/**
+ * Range of the temperatures of a table.
+ * @param pvUser minimal and maximal temperatures.
+ * @return 0.
+ */
+static int
+iRange (void * pvUser, double dTemp, double dRes) {
+  double * range = pvUser;
+
+  (void) dRes;
+  range[0] = (dTemp < range[0]) ? dTemp : range[0];
+  range[1] = (dTemp > range[1]) ? dTemp : range[1];
+  return 0;
+}
+
+/**
+ * Random temperatures of the range and their inputs.
+ * @param c case.
+ */
+static void
+vInputs (xCase * c) {
+  double tmin = c->dRange[0], tmax = c->dRange[1], r;
+  unsigned seed = 1;
+  size_t i;
+
+  for (i = 0; i < c->xCount; i++) {
+
+    seed = seed * 1103515245 + 12345;
+    c->dT[i] = tmin + (tmax - tmin) * ( (seed >> 8) / 16777216.0);
+    c->dR[i] = dNtcModelTempToRes (&c->xModel, c->dT[i]);
+    c->fT[i] = c->dT[i];
+    c->fR[i] = c->dR[i];
+    c->uCode[i] = (seed >> 4) & ( (1 << LUT_BITS) - 1);
+    r = c->dR[i] / (c->dR[i] + c->xCfg.dSeries) * (1 << LUT_BITS);
+    c->uAdc[i] = (r < (1 << LUT_BITS) - 1) ? (uint16_t) r : (1 << LUT_BITS) - 1;
+    r = ldexp (c->dR[i], NTC_FIX_RES_SHIFT);
+    c->uR[i] = (r < UINT32_MAX) ? (uint32_t) r : UINT32_MAX;
+    c->iT[i] = (int32_t) lround (c->dT[i] * NTC_FIX_TEMP_SCALE);
+  }
+}
+
+/**
+ * Measures the fit and the conversions of a table.
+ * @param sPath table file.
+ * @param xCount number of values.
+ * @param dCoeff coefficients of the table.
+ * @param range range of the temperatures of the table.
+ * @return 0, -1 on error.
+ */
+static int
+iBenchTable (const char * sPath, size_t xCount, double dCoeff[4],
+             double range[2]) {
+  xNtcAdcConfig cfg = { 0, 3.3, 0, LUT_BITS, eNtcPullUp };
+  const char * name = strrchr (sPath, '/') ? strrchr (sPath, '/') + 1 : sPath;
+  double ns[sizeof (xBenchs) / sizeof (xBenchs[0])];
+  xNtcAlarmSetpoint set[2];
+  xNtcFitResult res;
+  xCase c;
+  size_t i, j;
+  eNtcIsa isa;
+
+  memset (&c, 0, sizeof (c));
+  range[0] = INFINITY;
+  range[1] = -INFINITY;
+  if ( (iNtcFitTable (sPath, NULL, &res) != 0) ||
+       (llNtcFitReadTable (sPath, iRange, range, NULL) < 0)) {
+
+    fprintf (stderr, "Cannot fit %s\n", sPath);
+    return -1;
+  }
+  c.sPath = sPath;
+  dMeasure ("fit-table", name, "-", vFit, eFit, &c, res.xStats.llCount);
+
+  memcpy (dCoeff, res.dCoeff, sizeof (res.dCoeff));
+  memcpy (c.dCoeff, res.dCoeff, sizeof (res.dCoeff));
+  memcpy (c.dRange, range, sizeof (c.dRange));
+  c.xCount = xCount;
+  c.dR = malloc (xCount * sizeof (double));
+  c.dT = malloc (xCount * sizeof (double));
+  c.fR = malloc (xCount * sizeof (float));
+  c.fT = malloc (xCount * sizeof (float));
+  c.uCode = malloc (xCount * sizeof (uint16_t));
+  c.uAdc = malloc (xCount * sizeof (uint16_t));
+  c.uR = malloc (xCount * sizeof (uint32_t));
+  c.iT = malloc (xCount * sizeof (int32_t));
+  c.dOut = malloc (xCount * sizeof (double));
+  c.dTmp = malloc (xCount * sizeof (double));
+  c.fOut = malloc (xCount * sizeof (float));
+  c.iOut16 = malloc (xCount * sizeof (int16_t));
+  c.uOut = malloc (xCount * sizeof (uint32_t));
+  c.iOut = malloc (xCount * sizeof (int32_t));
+  cfg.dSeries = dNtcTempToRes (25.0, c.dCoeff);
+  c.xCfg = cfg;
+  c.xLut = xNtcLutNew (&cfg, c.dCoeff, 0);
+  c.xLutFixed = xNtcLutNew (&cfg, c.dCoeff, 1);
+  c.xSpline = xNtcSplineNew (c.dCoeff, dNtcTempToRes (range[1], c.dCoeff),
+                             dNtcTempToRes (range[0], c.dCoeff),
+                             SPLINE_ERROR, eNtcSplineLog2, 2);
+  set[0].eType = eNtcAlarmOver;
+  set[0].dTemp = range[1] + ALARM_MARGIN;
+  set[0].dHyst = 1.0;
+  set[1].eType = eNtcAlarmUnder;
+  set[1].dTemp = range[0] - ALARM_MARGIN;
+  set[1].dHyst = 1.0;
+  c.xAlarmRes = xNtcAlarmNew (c.dCoeff, set, 2, NULL);
+  c.xAlarmCode = xNtcAlarmNew (c.dCoeff, set, 2, &cfg);
+  if (!c.dR || !c.dT || !c.fR || !c.fT || !c.uCode || !c.uAdc || !c.uR ||
+      !c.iT || !c.dOut || !c.dTmp || !c.fOut || !c.iOut16 || !c.uOut ||
+      !c.iOut || !c.xLut || !c.xLutFixed || !c.xAlarmRes || !c.xAlarmCode ||
+      (iNtcModelInit (&c.xModel, c.dCoeff) != 0) ||
+      (iNtcFixModelInit (&c.xFix, c.dCoeff, range[0], range[1]) != 0)) {
+
+    fprintf (stderr, "Cannot build the models of %s\n", sPath);
+    return -1;
+  }
+  vInputs (&c);
+
+  for (i = 0; i < sizeof (xBenchs) / sizeof (xBenchs[0]); i++) {
+
+    if ( (xBenchs[i].vFunc == vSplineResToTemp) && (c.xSpline == NULL)) {
+      continue;
+    }
+    if (!xBenchs[i].bIsa) {
+
+      ns[i] = dMeasure (xBenchs[i].sName, name, "-", xBenchs[i].vFunc,
+                        xBenchs[i].eKind, &c, xCount);
+      for (j = 0; xBases && xBenchs[i].sRef && (j < i); j++) {
+
+        if (strcmp (xBenchs[j].sName, xBenchs[i].sRef) == 0) {
+
+          vCompareRef (xBenchs[i].sName, name, xBenchs[i].vFunc, &c, ns[i],
+                       xBenchs[j].sName, ns[j]);
+        }
+      }
+      continue;
+    }
+    for (isa = eNtcIsaScalar; isa <= eNtcIsaAvx512; isa++) {
+
+      if (iNtcIsaSet (isa) != 0) {
+        continue;
+      }
+      dMeasure (xBenchs[i].sName, name, sNtcIsaName (isa), xBenchs[i].vFunc,
+                xBenchs[i].eKind, &c, xCount);
+    }
+    iNtcIsaSet (eNtcIsaAuto);
+  }
+  vNtcLutDelete (c.xLut);
+  vNtcLutDelete (c.xLutFixed);
+  vNtcSplineDelete (c.xSpline);
+  vNtcAlarmDelete (c.xAlarmRes);
+  vNtcAlarmDelete (c.xAlarmCode);
+  free (c.dR);
+  free (c.dT);
+  free (c.fR);
+  free (c.fT);
+  free (c.uCode);
+  free (c.uAdc);
+  free (c.uR);
+  free (c.iT);
+  free (c.dOut);
+  free (c.dTmp);
+  free (c.fOut);
+  free (c.iOut16);
+  free (c.uOut);
+  free (c.iOut);
+  return 0;
+}
+
+/* fits ===================================================================== */
+/**
+ * Measures the fits of tables of 100 to xPairs pairs of a model.
+ * @param sTable name of the table of the model.
+ * @param dCoeff coefficients of the model.
+ * @param range range of the temperatures.
+ * @param xPairs maximal number of pairs.
+ * @return 0, -1 on error.
+ */
+static int
+iBenchFit (const char * sTable, double dCoeff[4], const double range[2],
+           size_t xPairs) {
+  static const struct {
+    const char * sName;
+    eNtcFitMethod eMethod;
+  } fit[] = {
+    { "fit-lsq", eNtcFitLeastSquares },
+    { "fit-minimax", eNtcFitMinimax },
+    { "fit-huber", eNtcFitHuber },
+  };
+  char path[] = "/tmp/ntc-bench-XXXXXX";
+  xCase c;
+  double t;
+  size_t i, n;
+  int fd, j;
+  FILE * f;
+
+  for (n = 100; n <= xPairs; n *= 10) {
+
+    strcpy (path + strlen (path) - 6, "XXXXXX");
+    fd = mkstemp (path);
+    f = (fd < 0) ? NULL : fdopen (fd, "w");
+    if (f == NULL) {
+
+      fprintf (stderr, "Cannot create %s\n", path);
+      return -1;
+    }
+    for (i = 0; i < n; i++) {
+
+      t = range[0] + (range[1] - range[0]) * i / (n - 1);
+      fprintf (f, "%.3f,%.6g\n", t, dNtcTempToRes (t, dCoeff));
+    }
+    fclose (f);
+    memset (&c, 0, sizeof (c));
+    c.sPath = path;
+    for (j = 0; j < (int) (sizeof (fit) / sizeof (fit[0])); j++) {
+
+      c.xOptions.eMethod = fit[j].eMethod;
+      dMeasure (fit[j].sName, sTable, "-", vFit, eFit, &c, n);
+    }
+    unlink (path);
+  }
+  return 0;
+}
+
+/**
+ * Main function of the benchmark.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return 0, 1 on error or regression.
+ */
+int main (int argc, char ** argv)
+{
+  size_t i, n = BENCH_VALUES, pairs = FIT_PAIRS;
+  const char * output = NULL, * format = "csv", * name = NULL;
+  const char * baseline = NULL;
+  double coeff[4], range[2], first[6];
+  int c, failed = 0;
+  glob_t g;
+
+  while ( (c = getopt (argc, argv, "n:r:p:f:o:b:a:s:h")) != -1) {
+    switch (c) {
+      case 'n':
+        n = strtoul (optarg, NULL, 0);
+        break;
+      case 'r':
+        iRuns = atoi (optarg);
+        break;
+      case 'p':
+        pairs = strtoul (optarg, NULL, 0);
+        break;
+      case 'f':
+        format = optarg;
+        break;
+      case 'o':
+        output = optarg;
+        break;
+      case 'b':
+        baseline = optarg;
+        break;
+      case 'a':
+        dAccuracyTol = atof (optarg);
+        break;
+      case 's':
+        dSpeedTol = atof (optarg);
+        break;
+      default:
+        fprintf (stderr, "usage : %s [-n values] [-r runs] [-p pairs] "
+                 "[-f csv|json] [-o file]\n"
+                 "        [-b baseline] [-a tolerance] [-s tolerance] "
+                 "[table ...]\n", argv[0]);
+        return 1;
+    }
+  }
+  bJson = (strcmp (format, "json") == 0);
+  if ( (n == 0) || (iRuns < 1) || (!bJson && strcmp (format, "csv")) ||
+       ! (dAccuracyTol >= 0.0) || ! (dSpeedTol >= 0.0)) {
+
+    fprintf (stderr, "Invalid option\n");
+    return 1;
+  }
+  if (baseline && (iReadBase (baseline) != 0)) {
+
+    fprintf (stderr, "Cannot read the baseline %s\n", baseline);
+    return 1;
+  }
+  xOut = output ? fopen (output, "w") : stdout;
+  if (xOut == NULL) {
+
+    perror (output);
+    return 1;
+  }
+  memset (&g, 0, sizeof (g));
+  if (optind >= argc) {
+
+    glob (NTC_DATA_DIR "/*.csv", 0, NULL, &g);
+  }
+  else {
+
+    g.gl_pathc = argc - optind;
+    g.gl_pathv = argv + optind;
+  }
+
+  fprintf (xOut, bJson ? "[\n" :
+           "bench,table,isa,count,ns_per_value,mvalues_per_s,max_error,"
+           "mean_error,max_ulp,mean_ulp\n");
+  for (i = 0; i < g.gl_pathc; i++) {
+
+    if (iBenchTable (g.gl_pathv[i], n, coeff, range) != 0) {
+
+      failed++;
+    }
+    else if (name == NULL) {
+
+      /* the fits are measured with the model of the first table */
+      name = strrchr (g.gl_pathv[i], '/');
+      name = name ? name + 1 : g.gl_pathv[i];
+      memcpy (first, coeff, sizeof (coeff));
+      memcpy (first + 4, range, sizeof (range));
+    }
+  }
+  if (name && (iBenchFit (name, first, first + 4, pairs) != 0)) {
+
+    failed++;
+  }
+  if (bJson) {
+
+    fprintf (xOut, "\n]\n");
+  }
+  if (optind >= argc) {
+
+    globfree (&g);
+  }
+  if (output) {
+
+    fclose (xOut);
+  }
+  for (i = 0; i < xBaseCount; i++) {
+
+    if (!xBases[i].bSeen) {
+
+      fprintf (stderr, "%s: not measured\n", xBases[i].sKey);
+    }
+  }
+  if (baseline) {
+
+    fprintf (stderr, "%d regressions against %s\n", iRegressions, baseline);
+  }
+  free (xBases);
+  return (failed || iRegressions) ? 1 : 0;
+}
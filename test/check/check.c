@@ -0,0 +1,1689 @@
+/*
+ * NTC thermistor library
+ * Version 1.0
+ * Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307
+ * USA
+ */
+
+/** @file check.c
+ * Program checking the conversions of the library against reference
+ * implementations over the temperature range of every T-R table of ntc-data.
+ * Prints the maximal error for each table and exits with a non-zero status
+ * if a tolerance is exceeded.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <ntc.h>
+#include <ntc-lut.h>
+#include <ntc-spline.h>
+#include <ntc-fixed.h>
+#include <ntc-bank.h>
+#include <ntc-parallel.h>
+#include <ntc-stream.h>
+#include <ntc-fit.h>
+#include <ntc-catalog.h>
+#include <ntc-alarm.h>
+#define NTC_PARTS_LUT
+#include <ntc-parts.h>
+
+/***********
+* Typedefs *
+***********/
+/** T-R table of ntc-data with its Steinhart-Hart coefficients. */
+typedef struct xDataset {
+  const char * sName; /**< file name in ntc-data */
+  double dCoeff[4];   /**< coefficients calculated with ntc-coeff */
+} xDataset;
+
+/************
+* Variables *
+************/
+/** Tables of ntc-data. */
+static const xDataset xDatasets[] = {
+  { "avx-k3630.csv", {
+      1.399855319931945e-03, 2.671556584008120e-04,
+      -2.149755300622226e-06, 2.947705171319694e-07
+    }
+  },
+  { "avx-ma3960.csv", {
+      1.384458976342609e-03, 2.393452650459891e-04,
+      4.184121390081160e-07, 5.134115012343303e-08
+    }
+  },
+  { "ms-1k2a1.csv", {
+      1.373110928814400e-03, 2.773130397145077e-04,
+      -1.908047580351405e-08, 2.008566064674431e-07
+    }
+  },
+  { "murata-nxft15-10k.csv", {
+      9.310296797541951e-04, 2.308343095769287e-04,
+      3.001370069362199e-06, 5.407975166655454e-08
+    }
+  },
+};
+
+/** Maximal relative error of the inverse conversion. */
+#define INVERSE_TOLERANCE 1e-12
+
+/** Maximal error of the batch conversion (in degree Celsius). */
+#define BATCH_TOLERANCE 1e-12
+
+/** Maximal error of a lookup table entry (in degree Celsius). */
+#define LUT_TOLERANCE 1e-9
+
+/** Resolution of the ADC of the lookup table checks. */
+#define LUT_BITS 12
+
+/** Error bound requested from the piecewise polynoms (in degree Celsius). */
+#define SPLINE_BOUND 0.01
+
+/** Error bound of the fixed point conversion (in degree Celsius). */
+#define FIXED_TOLERANCE 0.006
+
+/** Maximal relative error of the fixed point inverse conversion. */
+#define FIXED_INVERSE_TOLERANCE 1e-6
+
+/** Error bound of the single precision conversion (in degree Celsius). */
+#define FLOAT_TOLERANCE 1e-4
+
+/** Maximal relative error of the single precision inverse conversion. */
+#define FLOAT_INVERSE_TOLERANCE 1e-5
+
+/** Maximal difference with the coefficients of ntc-coeff version 1.0 and
+    with exact pairs (in degree Celsius). */
+#define FIT_TOLERANCE 1e-9
+
+/** Maximal error of the form selection checks (in degree Celsius). */
+#define FORM_MAX_ERROR 0.05
+
+/** Minimal relative gain of the minimax fit of the simplified form over the
+    least squares fit. */
+#define MINIMAX_GAIN 0.05
+
+/** Noise of the temperatures of the robust fit check (in degree Celsius),
+    uniform, a pair out of ROBUST_PERIOD is a spike of ROBUST_SPIKE. */
+#define ROBUST_NOISE 0.01
+#define ROBUST_PERIOD 97
+#define ROBUST_SPIKE 5.0
+
+/** Maximal error of the robust fits against the exact pairs. */
+#define ROBUST_TOLERANCE 1e-3
+
+/** Forgetting factor of the online fit check. */
+#define ONLINE_LAMBDA 0.995
+
+/** Pairs of each thermistor of the online fit check. */
+#define ONLINE_PAIRS 4000
+
+/** Maximal error of the online fit after the drift (in degree Celsius). */
+#define ONLINE_TOLERANCE 1e-4
+
+/** Number of models published by the online fit check. */
+#define ONLINE_PUBLISH 200000
+
+/** Number of channels of the sensor bank check. */
+#define BANK_CHANNELS 1000
+
+/** Number of readings of the sensor bank stream check. */
+#define BANK_READINGS 100000
+
+/** Number of values of the parallel conversion check. */
+#define PARALLEL_VALUES 1000003
+
+/** Number of threads of the parallel conversion check. */
+#define PARALLEL_THREADS 4
+
+/** Number of values of the stream conversion check. */
+#define STREAM_VALUES 100000
+
+/** Number of readings of the alarm check. */
+#define ALARM_READINGS 200000
+
+/** Number of events of a batch of the alarm check (two setpoints at least). */
+#define ALARM_EVENTS 7
+
+/** Temperature step of the sweeps. */
+#define STEP 0.01
+
+/************
+* Functions *
+************/
+
+/**
+ * Maximum of two errors, NaN as soon as one of them is NaN so that a
+ * conversion or a reference giving NaN never passes a tolerance.
+ * @param max maximal error so far.
+ * @param err error.
+ * @return maximal error.
+ */
+static double
+dMax (double max, double err) {
+
+  return (isnan (max) || (err <= max)) ? max : err;
+}
+
+/**
+ * Reads the temperature range of a T-R table file.
+ * @param name file name in ntc-data.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the file can not be read.
+ */
+static int
+iReadRange (const char * name, double * tmin, double * tmax) {
+  char path[256];
+  double t, r;
+  FILE * f;
+  int n = 0;
+
+  snprintf (path, sizeof (path), "%s/%s", NTC_DATA_DIR, name);
+  f = fopen (path, "r");
+  if (f == NULL) {
+
+    return -1;
+  }
+  while (fscanf (f, "%lf %lf", &t, &r) == 2) {
+
+    if ( (n == 0) || (t < *tmin)) {
+      *tmin = t;
+    }
+    if ( (n == 0) || (t > *tmax)) {
+      *tmax = t;
+    }
+    n++;
+  }
+  fclose (f);
+  return (n > 0) ? 0 : -1;
+}
+
+/**
+ * Conversion from temperature to resistance with the Cardano formula
+ * of the version 1.0 of the library, used as reference.
+ * @param dT temperature (in degree Celsius)
+ * @param a Steinhart-Hart coefficients
+ * @return corresponding resistance
+ */
+static double
+dCardanoTempToRes (double dT, const double a[]) {
+  double u, v, p, q, b, c, d;
+
+  dT = dT + 273.15;
+  d = (a[0] - 1.0 / dT) / a[3];
+  c = a[1] / a[3];
+  b = a[2] / a[3];
+  q = 2.0 / 27.0 * b * b * b - 1.0 / 3.0 * b * c + d;
+  p = c - 1.0 / 3.0 * b * b;
+  v = - pow (q / 2.0 + sqrt (q * q / 4.0 + p * p * p / 27.0), 1.0 / 3.0);
+  u =   pow (-q / 2.0 + sqrt (q * q / 4.0 + p * p * p / 27.0), 1.0 / 3.0);
+  return exp (u + v - b / 3.0);
+}
+
+/**
+ * Checks the batch conversion from resistance to temperature against
+ * dNtcResToTemp().
+ * @param d table.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the tolerance is exceeded.
+ */
+static int
+iCheckBatch (const xDataset * d, double tmin, double tmax) {
+  double * t, * r, err, maxerr = 0.0;
+  size_t i, n;
+
+  n = (size_t) ( (tmax - tmin) / STEP) + 1;
+  if (n < 2) {
+
+    return -1;
+  }
+  t = malloc (n * sizeof (double));
+  r = malloc (n * sizeof (double));
+  for (i = 0; i < n; i++) {
+
+    r[i] = dNtcTempToRes (tmin + i * STEP, (double *) d->dCoeff);
+  }
+  vNtcResToTempArray (r, t, n, d->dCoeff);
+  for (i = 0; i < n; i++) {
+
+    err = fabs (t[i] - dNtcResToTemp (r[i], (double *) d->dCoeff));
+    maxerr = dMax (maxerr, err);
+  }
+  free (t);
+  free (r);
+  printf ("    batch     : max. error %.3e\n", maxerr);
+  return (maxerr <= BATCH_TOLERANCE) ? 0 : -1;
+}
+
+/**
+ * Checks the inverse conversion, scalar and batch, against the Cardano
+ * formula.
+ * @param d table.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the tolerance is exceeded.
+ */
+static int
+iCheckInverse (const xDataset * d, double tmin, double tmax) {
+  xNtcModel m;
+  double * t, * r, ref, err, maxerr = 0.0;
+  size_t i, n;
+
+  n = (size_t) ( (tmax - tmin) / STEP) + 1;
+  if (n < 2) {
+
+    return -1;
+  }
+  t = malloc (n * sizeof (double));
+  r = malloc (n * sizeof (double));
+  for (i = 0; i < n; i++) {
+
+    t[i] = tmin + i * STEP;
+  }
+  iNtcModelInit (&m, d->dCoeff);
+  vNtcModelTempToResArray (&m, t, r, n);
+  for (i = 0; i < n; i++) {
+
+    ref = dCardanoTempToRes (t[i], d->dCoeff);
+    err = fabs (dNtcModelTempToRes (&m, t[i]) - ref) / ref;
+    maxerr = dMax (maxerr, err);
+    err = fabs (dNtcTempToRes (t[i], (double *) d->dCoeff) - ref) / ref;
+    maxerr = dMax (maxerr, err);
+    err = fabs (r[i] - ref) / ref;
+    maxerr = dMax (maxerr, err);
+  }
+  vNtcTempToResArray (t, r, n, d->dCoeff);
+  for (i = 0; i < n; i++) {
+
+    ref = dCardanoTempToRes (t[i], d->dCoeff);
+    err = fabs (r[i] - ref) / ref;
+    maxerr = dMax (maxerr, err);
+  }
+  free (t);
+  free (r);
+  printf ("    inverse   : max. relative error %.3e\n", maxerr);
+  return (maxerr <= INVERSE_TOLERANCE) ? 0 : -1;
+}
+
+/**
+ * Checks the lookup tables, double and fixed point, of a pull-up divider
+ * whose series resistor equals the resistance at 25 degree Celsius.
+ * @param d table.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the tolerance is exceeded.
+ */
+static int
+iCheckLut (const xDataset * d, double tmin, double tmax) {
+  xNtcAdcConfig cfg = { 0, 3.3, 0, LUT_BITS, eNtcPullUp };
+  xNtcLut * lut, * fix;
+  xNtcLutError report;
+  double r, t, err, maxerr = 0.0, maxfix = 0.0;
+  unsigned c;
+
+  cfg.dSeries = dNtcTempToRes (25.0, (double *) d->dCoeff);
+  lut = xNtcLutNew (&cfg, d->dCoeff, 0);
+  fix = xNtcLutNew (&cfg, d->dCoeff, 1);
+  for (c = 0; c < uNtcLutSize (lut); c++) {
+
+    r = dNtcAdcCodeToRes (&cfg, c);
+    t = dNtcResToTemp (r, (double *) d->dCoeff);
+    if ( (t < tmin) || (t > tmax)) {
+      continue;
+    }
+    err = fabs (dNtcLutCodeToTemp (lut, c) - t);
+    maxerr = dMax (maxerr, err);
+    err = fabs (iNtcLutCodeToTempFixed (fix, c) - t * NTC_LUT_FIXED_SCALE);
+    maxfix = dMax (maxfix, err);
+  }
+  iNtcLutError (lut, tmin, tmax, &report);
+  printf ("  lut         : max. error %.3e, quantization max. %.4f mean %.4f\n",
+          maxerr, report.dMaxError, report.dMeanError);
+  vNtcLutDelete (lut);
+  vNtcLutDelete (fix);
+  return ( (maxerr <= LUT_TOLERANCE) && (maxfix <= 0.5)) ? 0 : -1;
+}
+
+/**
+ * Checks that the piecewise polynoms, of each variable and degree, stay
+ * within their error bound, and that NaN gives NaN.
+ * @param d table.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the bound is exceeded.
+ */
+static int
+iCheckSpline (const xDataset * d, double tmin, double tmax) {
+  double rmin, rmax, r, err, maxerr = 0.0;
+  xNtcSpline * s;
+  int v, deg, i, ret = 0;
+
+  rmin = dNtcTempToRes (tmax, (double *) d->dCoeff);
+  rmax = dNtcTempToRes (tmin, (double *) d->dCoeff);
+  printf ("  spline      : segments");
+  for (v = eNtcSplineRes; v <= eNtcSplineLog2; v++) {
+    for (deg = 1; deg <= 2; deg++) {
+
+      s = xNtcSplineNew (d->dCoeff, rmin, rmax, SPLINE_BOUND, v, deg);
+      if (s == NULL) {
+
+        printf (" -");
+        ret = -1;
+        continue;
+      }
+      for (i = 0; i <= 100000; i++) {
+
+        r = rmin * pow (rmax / rmin, i / 100000.0);
+        err = fabs (dNtcSplineResToTemp (s, r) -
+                    dNtcResToTemp (r, (double *) d->dCoeff));
+        maxerr = dMax (maxerr, err);
+      }
+      if (!isnan (dNtcSplineResToTemp (s, NAN))) {
+        ret = -1;
+      }
+      printf (" %u", uNtcSplineSegments (s));
+      vNtcSplineDelete (s);
+    }
+  }
+  printf (", max. error %.5f\n", maxerr);
+  return ( (ret == 0) && (maxerr <= SPLINE_BOUND)) ? 0 : -1;
+}
+
+/**
+ * Checks the fixed point conversions, scalar and batch, against
+ * dNtcResToTemp() and dNtcTempToRes() at every 1/100 degree Celsius.
+ * The resistance is compared up to its quantization to 1/256 Ohm.
+ * @param d table.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the tolerance is exceeded.
+ */
+static int
+iCheckFixed (const xDataset * d, double tmin, double tmax) {
+  xNtcFixModel m;
+  uint32_t * r, * rb;
+  int32_t * t, * tb;
+  /* extreme temperatures, clamped to the ends of the range */
+  const int32_t te[4] = { INT32_MIN, INT32_MIN / 2, INT32_MAX / 2, INT32_MAX };
+  uint32_t re[4];
+  double ref, err, maxerr = 0.0, maxinv = 0.0;
+  size_t i, n;
+  eNtcIsa isa;
+  int ret = 0;
+
+  if (iNtcFixModelInit (&m, d->dCoeff, tmin, tmax) != 0) {
+
+    printf ("  fixed       : -\n");
+    return -1;
+  }
+  n = (size_t) ( (tmax - tmin) / STEP) + 1;
+  if (n < 2) {
+
+    return -1;
+  }
+  r = malloc (n * sizeof (uint32_t));
+  rb = malloc (n * sizeof (uint32_t));
+  t = malloc (n * sizeof (int32_t));
+  tb = malloc (n * sizeof (int32_t));
+  for (i = 0; i < n; i++) {
+
+    t[i] = (int32_t) lround (tmin * NTC_FIX_TEMP_SCALE) + (int32_t) i;
+    ref = dNtcTempToRes ( (double) t[i] / NTC_FIX_TEMP_SCALE,
+                          (double *) d->dCoeff);
+    r[i] = (uint32_t) lround (ref * (1 << NTC_FIX_RES_SHIFT));
+  }
+  for (i = 0; i < n; i++) {
+
+    ref = dNtcResToTemp ( (double) r[i] / (1 << NTC_FIX_RES_SHIFT),
+                          (double *) d->dCoeff) * NTC_FIX_TEMP_SCALE;
+    err = fabs (iNtcFixResToTemp (&m, r[i]) - ref) / NTC_FIX_TEMP_SCALE;
+    maxerr = dMax (maxerr, err);
+
+    ref = dNtcTempToRes ( (double) t[i] / NTC_FIX_TEMP_SCALE,
+                          (double *) d->dCoeff) * (1 << NTC_FIX_RES_SHIFT);
+    err = (fabs (uNtcFixTempToRes (&m, t[i]) - ref) - 1.0) / ref;
+    maxinv = dMax (maxinv, err);
+  }
+  ret |= (uNtcFixTempToRes (&m, te[0]) != uNtcFixTempToRes (&m, te[1]));
+  ret |= (uNtcFixTempToRes (&m, te[3]) != uNtcFixTempToRes (&m, te[2]));
+  /* the array functions of each instruction set give the scalar results */
+  for (isa = eNtcIsaScalar; isa <= eNtcIsaAvx512; isa++) {
+
+    if (iNtcIsaSet (isa) != 0) {
+      continue;
+    }
+    vNtcFixResToTempArray (&m, r, tb, n);
+    vNtcFixTempToResArray (&m, t, rb, n);
+    for (i = 0; i < n; i++) {
+
+      ret |= (tb[i] != iNtcFixResToTemp (&m, r[i]));
+      ret |= (rb[i] != uNtcFixTempToRes (&m, t[i]));
+    }
+    vNtcFixTempToResArray (&m, te, re, 4);
+    for (i = 0; i < 4; i++) {
+
+      ret |= (re[i] != uNtcFixTempToRes (&m, te[i]));
+    }
+  }
+  iNtcIsaSet (eNtcIsaAuto);
+  free (r);
+  free (rb);
+  free (t);
+  free (tb);
+  printf ("  fixed       : degrees %d/%d, max. error %.4f, inverse %.3e%s\n",
+          m.xForward.iDegree, m.xInverse.iDegree, maxerr, maxinv,
+          ret ? ", batch differs" : "");
+  return ( (ret == 0) && (maxerr <= FIXED_TOLERANCE) &&
+           (maxinv <= FIXED_INVERSE_TOLERANCE)) ? 0 : -1;
+}
+
+/**
+ * Checks the fit of the T-R table against the coefficients of the
+ * dataset, then the fit of exact pairs calculated with dNtcTempToRes().
+ * @param d table.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the tolerance is exceeded.
+ */
+static int
+iCheckFit (const xDataset * d, double tmin, double tmax) {
+  char path[256];
+  double a[4], b[4], * t, * r;
+  double err, maxerr = 0.0, maxexact;
+  xNtcFitStats stats;
+  xNtcFit * f;
+  size_t i, n, line;
+  int ret = 0;
+
+  n = (size_t) ( (tmax - tmin) / STEP) + 1;
+  if (n < 2) {
+
+    return -1;
+  }
+  f = xNtcFitNew();
+  snprintf (path, sizeof (path), "%s/%s", NTC_DATA_DIR, d->sName);
+  if ( (llNtcFitAddTable (f, path, &line) < 4) ||
+       (iNtcFitSolve (f, a, &stats) != 0)) {
+
+    printf ("  fit         : -\n");
+    vNtcFitDelete (f);
+    return -1;
+  }
+  t = malloc (n * sizeof (double));
+  r = malloc (n * sizeof (double));
+  for (i = 0; i < n; i++) {
+
+    t[i] = tmin + i * STEP;
+    r[i] = dNtcTempToRes (t[i], (double *) d->dCoeff);
+    err = fabs (dNtcResToTemp (r[i], a) - t[i]);
+    maxerr = dMax (maxerr, err);
+  }
+
+  vNtcFitClear (f);
+  ret |= iNtcFitAddArray (f, t, r, n);
+  ret |= iNtcFitSolve (f, b, NULL);
+  maxexact = dNtcFitMaxError (t, r, n, b, NULL);
+  vNtcFitDelete (f);
+  free (t);
+  free (r);
+  printf ("  fit         : %lld pairs, rms %.2e, max. error %.2e, exact %.2e\n",
+          stats.llCount, stats.dRms, maxerr, maxexact);
+  return ( (ret == 0) && (maxerr <= FIT_TOLERANCE) &&
+           (maxexact <= FIT_TOLERANCE)) ? 0 : -1;
+}
+
+/**
+ * Checks that the minimax fit of each form of pairs calculated with
+ * dNtcTempToRes() has a maximal error below the one of the least squares
+ * fit, and reaches the exact pairs with the extended form.
+ * @param d table.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the minimax fit is worse.
+ */
+static int
+iCheckMinimax (const xDataset * d, double tmin, double tmax) {
+  double a[4], * t, * r, err[3], lsq[3];
+  eNtcForm form;
+  xNtcFit * f;
+  size_t i, n;
+  int ret = 0;
+
+  n = (size_t) ( (tmax - tmin) / STEP) + 1;
+  if (n < 2) {
+
+    return -1;
+  }
+  t = malloc (n * sizeof (double));
+  r = malloc (n * sizeof (double));
+  for (i = 0; i < n; i++) {
+
+    t[i] = tmin + i * STEP;
+    r[i] = dNtcTempToRes (t[i], (double *) d->dCoeff);
+  }
+  f = xNtcFitNew();
+  ret |= iNtcFitAddArray (f, t, r, n);
+  for (form = eNtcFormSimplified; form <= eNtcFormExtended; form++) {
+
+    ret |= iNtcFitSolveForm (f, form, a, NULL);
+    lsq[form] = dNtcFitMaxError (t, r, n, a, NULL);
+    ret |= iNtcFitMinimax (t, r, n, form, a, &err[form]);
+    ret |= (eNtcFormOf (a) != form) ||
+           (err[form] != dNtcFitMaxError (t, r, n, a, NULL));
+  }
+  vNtcFitDelete (f);
+  free (t);
+  free (r);
+  printf ("  minimax     : simplified %.2e (%.2e), standard %.2e (%.2e), "
+          "extended %.2e\n", err[0], lsq[0], err[1], lsq[1], err[2]);
+  return ( (ret == 0) &&
+           (err[0] <= (1.0 - MINIMAX_GAIN) * lsq[0]) &&
+           (err[1] <= lsq[1]) && (err[2] <= FIT_TOLERANCE)) ? 0 : -1;
+}
+
+/**
+ * Checks the conversions with the coefficients of the simplified and
+ * standard forms derived from the table (the null terms are skipped by
+ * the kernels): batch against dNtcResToTemp(), inverse against the direct
+ * conversion, and the fit of exact pairs of each form.
+ * @param d table.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the tolerance is exceeded.
+ */
+static int
+iCheckForms (const xDataset * d, double tmin, double tmax) {
+  double a[4], b[4], * t, * r, * tb, * rb;
+  double err, maxerr = 0.0, maxinv = 0.0, maxfit = 0.0;
+  eNtcForm form;
+  xNtcModel m;
+  xNtcFit * f;
+  size_t i, n;
+  int ret = 0;
+
+  n = (size_t) ( (tmax - tmin) / STEP) + 1;
+  if (n < 2) {
+
+    return -1;
+  }
+  t = malloc (n * sizeof (double));
+  r = malloc (n * sizeof (double));
+  tb = malloc (n * sizeof (double));
+  rb = malloc (n * sizeof (double));
+  f = xNtcFitNew();
+  for (form = eNtcFormSimplified; form < eNtcFormExtended; form++) {
+
+    memcpy (a, d->dCoeff, sizeof (a));
+    a[2] = 0.0;
+    a[3] = (form == eNtcFormStandard) ? a[3] : 0.0;
+    ret |= (eNtcFormOf (a) != form) || (iNtcModelInit (&m, a) != 0);
+    for (i = 0; i < n; i++) {
+
+      t[i] = tmin + i * STEP;
+    }
+    vNtcModelTempToResArray (&m, t, r, n);
+    vNtcResToTempArray (r, tb, n, a);
+    vNtcModelResToTempArray (&m, r, rb, n);
+    for (i = 0; i < n; i++) {
+
+      err = fabs (tb[i] - dNtcResToTemp (r[i], a));
+      err = dMax (err, fabs (tb[i] - rb[i]));
+      maxerr = dMax (maxerr, err);
+      err = fabs (dNtcModelTempToRes (&m, t[i]) - r[i]) / r[i];
+      maxinv = dMax (maxinv, err);
+      err = fabs (dNtcModelResToTemp (&m, r[i]) - t[i]);
+      maxinv = dMax (maxinv, err);
+    }
+    vNtcFitClear (f);
+    ret |= iNtcFitAddArray (f, t, r, n);
+    ret |= iNtcFitSolveForm (f, form, b, NULL);
+    ret |= (eNtcFormOf (b) != form);
+    err = dNtcFitMaxError (t, r, n, b, NULL);
+    maxfit = dMax (maxfit, err);
+  }
+  vNtcFitDelete (f);
+  free (t);
+  free (r);
+  free (tb);
+  free (rb);
+  printf ("    forms     : max. error %.3e, inverse %.3e, fit %.3e\n",
+          maxerr, maxinv, maxfit);
+  return ( (ret == 0) && (maxerr <= BATCH_TOLERANCE) &&
+           (maxinv <= INVERSE_TOLERANCE) && (maxfit <= FIT_TOLERANCE)) ? 0 : -1;
+}
+
+/**
+ * Checks the single precision conversions, scalar and batch, against
+ * dNtcResToTemp() and dNtcTempToRes().
+ * @param d table.
+ * @param tmin minimal temperature.
+ * @param tmax maximal temperature.
+ * @return 0, -1 if the tolerance is exceeded.
+ */
+static int
+iCheckFloat (const xDataset * d, double tmin, double tmax) {
+  xNtcModel m;
+  float * t, * r, * tb, * rb;
+  double ref, err, maxerr = 0.0, maxinv = 0.0;
+  size_t i, n;
+
+  n = (size_t) ( (tmax - tmin) / STEP) + 1;
+  if (n < 2) {
+
+    return -1;
+  }
+  t = malloc (n * sizeof (float));
+  r = malloc (n * sizeof (float));
+  tb = malloc (n * sizeof (float));
+  rb = malloc (n * sizeof (float));
+  iNtcModelInit (&m, d->dCoeff);
+  for (i = 0; i < n; i++) {
+
+    t[i] = (float) (tmin + i * STEP);
+    r[i] = (float) dNtcTempToRes (t[i], (double *) d->dCoeff);
+  }
+  vNtcResToTempArrayf (r, tb, n, d->dCoeff);
+  vNtcModelTempToResArrayf (&m, t, rb, n);
+  for (i = 0; i < n; i++) {
+
+    ref = dNtcResToTemp (r[i], (double *) d->dCoeff);
+    err = fabs (fNtcResToTemp (r[i], d->dCoeff) - ref);
+    maxerr = dMax (maxerr, err);
+    err = fabs (tb[i] - ref);
+    maxerr = dMax (maxerr, err);
+
+    ref = dNtcTempToRes (t[i], (double *) d->dCoeff);
+    err = fabs (fNtcModelTempToRes (&m, t[i]) - ref) / ref;
+    maxinv = dMax (maxinv, err);
+    err = fabs (rb[i] - ref) / ref;
+    maxinv = dMax (maxinv, err);
+  }
+  free (t);
+  free (r);
+  free (tb);
+  free (rb);
+  printf ("    float     : max. error %.2e, inverse %.2e\n", maxerr, maxinv);
+  return ( (maxerr <= FLOAT_TOLERANCE) &&
+           (maxinv <= FLOAT_INVERSE_TOLERANCE)) ? 0 : -1;
+}
+
+/**
+ * Checks a sensor bank whose channels use the tables in turn, the last
+ * channel being left without coefficients.
+ * @return 0, -1 if the tolerance is exceeded.
+ */
+static int
+iCheckBank (void) {
+  const int sets = (int) (sizeof (xDatasets) / sizeof (xDatasets[0]));
+  double * r, * t, * tg, * tb, ref, err, maxerr = 0.0;
+  xNtcBank * b;
+  uint32_t * c;
+  int i, ret = 0;
+
+  b = xNtcBankNew (BANK_CHANNELS);
+  r = malloc (BANK_READINGS * sizeof (double));
+  t = malloc (BANK_READINGS * sizeof (double));
+  tg = malloc (BANK_READINGS * sizeof (double));
+  tb = malloc (BANK_READINGS * sizeof (double));
+  c = malloc (BANK_READINGS * sizeof (uint32_t));
+  for (i = 0; i < BANK_CHANNELS - 1; i++) {
+
+    iNtcBankSetChannel (b, i, xDatasets[i % sets].dCoeff);
+  }
+  srand (1);
+  for (i = 0; i < BANK_READINGS; i++) {
+
+    /* a few readings of unknown channels */
+    c[i] = (uint32_t) (rand() % (BANK_CHANNELS + 10));
+    r[i] = dNtcTempToRes (-40.0 + (rand() % 16500) * 0.01,
+                          (double *) xDatasets[c[i] % sets].dCoeff);
+  }
+  vNtcBankResToTemp (b, r, t);
+  ret |= iNtcBankStreamResToTemp (b, c, r, tg, BANK_READINGS, eNtcBankGather);
+  ret |= iNtcBankStreamResToTemp (b, c, r, tb, BANK_READINGS, eNtcBankGroup);
+  for (i = 0; i < BANK_READINGS; i++) {
+
+    if (i < BANK_CHANNELS - 1) {
+
+      err = fabs (t[i] - dNtcResToTemp (r[i],
+                                        (double *) xDatasets[i % sets].dCoeff));
+      maxerr = dMax (maxerr, err);
+    }
+    if (c[i] < BANK_CHANNELS - 1) {
+
+      ref = dNtcResToTemp (r[i], (double *) xDatasets[c[i] % sets].dCoeff);
+      err = fabs (tg[i] - ref);
+      maxerr = dMax (maxerr, err);
+      err = fabs (tb[i] - ref);
+      maxerr = dMax (maxerr, err);
+    }
+    else {
+
+      ret |= !isnan (tg[i]) || !isnan (tb[i]);
+    }
+  }
+  ret |= !isnan (t[BANK_CHANNELS - 1]);
+  printf ("    bank      : %u models, max. error %.3e%s\n", uNtcBankModels (b),
+          maxerr, ret ? ", unknown channel not NaN" : "");
+  vNtcBankDelete (b);
+  free (r);
+  free (t);
+  free (tg);
+  free (tb);
+  free (c);
+  return ( (ret == 0) && (maxerr <= BATCH_TOLERANCE)) ? 0 : -1;
+}
+
+/**
+ * Checks that the parallel conversions give the same results as the
+ * sequential ones.
+ * @return 0, -1 if a result differs.
+ */
+static int
+iCheckParallel (void) {
+  double * t, * r, * rs, * ts;
+  float * f, * fs;
+  xNtcModel m;
+  size_t i, n = PARALLEL_VALUES;
+  int ret = 0, status = -1;
+  pid_t pid;
+
+  t = pvNtcParallelAlloc (n, sizeof (double));
+  r = pvNtcParallelAlloc (n, sizeof (double));
+  f = pvNtcParallelAlloc (n, sizeof (float));
+  rs = malloc (n * sizeof (double));
+  ts = malloc (n * sizeof (double));
+  fs = malloc (n * sizeof (float));
+  iNtcModelInit (&m, xDatasets[0].dCoeff);
+  for (i = 0; i < n; i++) {
+
+    t[i] = -55.0 + 205.0 * (double) i / (double) n;
+  }
+  iNtcParallelSetThreads (PARALLEL_THREADS);
+  vNtcParallelTempToResArray (&m, t, r, n);
+  vNtcModelTempToResArray (&m, t, rs, n);
+  for (i = 0; i < n; i++) {
+
+    f[i] = (float) r[i];
+  }
+  vNtcParallelResToTempArray (r, t, n, xDatasets[0].dCoeff);
+  vNtcResToTempArray (r, ts, n, xDatasets[0].dCoeff);
+  vNtcResToTempArrayf (f, fs, n, xDatasets[0].dCoeff);
+  vNtcParallelResToTempArrayf (f, f, n, xDatasets[0].dCoeff);
+  for (i = 0; i < n; i++) {
+
+    ret |= (r[i] != rs[i]) || (t[i] != ts[i]) || (f[i] != fs[i]);
+  }
+  /* a forked child starts its own workers */
+  pid = fork ();
+  if (pid == 0) {
+
+    vNtcParallelResToTempArray (r, t, n, xDatasets[0].dCoeff);
+    _exit (memcmp (t, ts, n * sizeof (double)) ? 1 : 0);
+  }
+  if ( (pid < 0) || (waitpid (pid, &status, 0) != pid) ||
+       ! WIFEXITED (status) || (WEXITSTATUS (status) != 0)) {
+
+    ret = 1;
+  }
+  iNtcParallelSetThreads (0);
+  printf ("parallel\n  %d threads : %s%s\n", PARALLEL_THREADS,
+          ret ? "results differ" : "same results",
+          (status != 0) ? ", forked child failed" : "");
+  free (t);
+  free (r);
+  free (f);
+  free (rs);
+  free (ts);
+  free (fs);
+  return ret ? -1 : 0;
+}
+
+/**
+ * Checks that the text stream conversion prints the same as printf with
+ * libm conversions, that a token split by the reads is parsed once, and
+ * that the raw binary output gives the same values as the batch conversion.
+ * @return 0, -1 if a result differs.
+ */
+static int
+iCheckStream (void) {
+  xNtcStreamConfig cfg = { eNtcStreamText, eNtcStreamText, 6 };
+  const double * a = xDatasets[1].dCoeff;
+  /* ties and near ties of the decimal rounding, with their decimals */
+  static const struct {
+    double v;
+    int d;
+  } xTies[] = {
+    { 1.115, 2 }, { 2.675, 2 }, { 0.125, 2 }, { -0.125, 2 }, { 0.375, 2 },
+    { 2.5, 0 }, { 3.5, 0 }, { -0.5, 0 }, { 1635.4950014999999, 6 },
+    { 0.0000005, 6 }, { 4503599627370495.5, 0 }, { 1e16, 0 }, { 1e300, 9 },
+    { -1e-300, 9 }
+  };
+  char line[NTC_STREAM_VALUE_MAX + 1], ref[NTC_STREAM_VALUE_MAX + 1];
+  double r, t, * rv, * tv;
+  FILE * in, * out;
+  int i, d, fd[2], diff = 0;
+  size_t len;
+  long long n;
+  pid_t pid;
+
+  /* printing against printf: ties, random values and halves */
+  for (i = 0; i < (int) (sizeof (xTies) / sizeof (xTies[0])) + 3 * STREAM_VALUES;
+       i++) {
+
+    if (i < (int) (sizeof (xTies) / sizeof (xTies[0]))) {
+
+      r = xTies[i].v;
+      d = xTies[i].d;
+    }
+    else {
+
+      d = rand() % 10;
+      r = (rand() % 2000000000) * 1e-6;
+      r = (i % 3) ? r : (floor (r * pow (10, d)) + 0.5) / pow (10, d);
+      r = (i % 2) ? r : -r;
+    }
+    len = xNtcStreamFormatNumber (r, d, line);
+    snprintf (ref, sizeof (ref), "%.*f\n", d, r);
+    diff += (len != strlen (ref)) || (memcmp (line, ref, len) != 0);
+  }
+
+  in = tmpfile();
+  out = tmpfile();
+  rv = malloc (STREAM_VALUES * sizeof (double));
+  tv = malloc (STREAM_VALUES * sizeof (double));
+  srand (2);
+  for (i = 0; i < STREAM_VALUES; i++) {
+
+    rv[i] = 50.0 + (rand() % 100000000) * 1e-3;
+    fprintf (in, "%.3f%c", rv[i], (i % 3) ? '\n' : ' ');
+  }
+  fprintf (in, "-1\nfoo\n");
+  fflush (in);
+  rewind (in);
+  n = llNtcStreamResToTemp (fileno (in), fileno (out), &cfg, a);
+  rewind (out);
+  for (i = 0; (i < STREAM_VALUES) && fgets (line, sizeof (line), out); i++) {
+
+    snprintf (ref, sizeof (ref), "%f\n", dNtcResToTemp (rv[i], (double *) a));
+    diff += (strcmp (line, ref) != 0);
+  }
+  diff += (i != STREAM_VALUES);
+  for (i = 0; (i < 2) && fgets (line, sizeof (line), out); i++) {
+
+    diff += (strcmp (line, "nan\n") != 0);
+  }
+  diff += (n != STREAM_VALUES + 2);
+
+  /*
+   * tokens split by the reads of a pipe: a printed value of maximal
+   * length is read back, a too long token gives a single nan
+   */
+  fclose (out);
+  out = tmpfile();
+  len = xNtcStreamFormatNumber (1e300, 9, line);
+  memset (ref, 'x', sizeof (ref));
+  n = -1;
+  if (pipe (fd) == 0) {
+
+    pid = fork ();
+    if (pid == 0) {
+
+      close (fd[0]);
+      d = (write (fd[1], line, len / 2) != (ssize_t) (len / 2));
+      usleep (10000);
+      d |= (write (fd[1], line + len / 2, len - len / 2) !=
+            (ssize_t) (len - len / 2));
+      d |= (write (fd[1], "100 ", 4) != 4);
+      d |= (write (fd[1], ref, sizeof (ref)) != sizeof (ref));
+      usleep (10000);
+      d |= (write (fd[1], ref, 100) != 100);
+      d |= (write (fd[1], "\n", 1) != 1);
+      _exit (d);
+    }
+    close (fd[1]);
+    if (pid > 0) {
+
+      n = llNtcStreamResToTemp (fd[0], fileno (out), &cfg, a);
+      diff += (waitpid (pid, &d, 0) != pid) || (d != 0);
+    }
+    close (fd[0]);
+  }
+  rewind (out);
+  snprintf (ref, sizeof (ref), "%f\n", dNtcResToTemp (1e300, (double *) a));
+  diff += !fgets (line, sizeof (line), out) || (strcmp (line, ref) != 0);
+  snprintf (ref, sizeof (ref), "%f\n", dNtcResToTemp (100.0, (double *) a));
+  diff += !fgets (line, sizeof (line), out) || (strcmp (line, ref) != 0);
+  diff += !fgets (line, sizeof (line), out) || (strcmp (line, "nan\n") != 0);
+  diff += (fgets (line, sizeof (line), out) != NULL) || (n != 3);
+
+  /* binary */
+  fclose (in);
+  fclose (out);
+  in = tmpfile();
+  out = tmpfile();
+  fwrite (rv, sizeof (double), STREAM_VALUES, in);
+  fflush (in);
+  rewind (in);
+  cfg.eIn = eNtcStreamDouble;
+  cfg.eOut = eNtcStreamDouble;
+  llNtcStreamResToTemp (fileno (in), fileno (out), &cfg, a);
+  rewind (out);
+  vNtcResToTempArray (rv, tv, STREAM_VALUES, a);
+  for (i = 0; (i < STREAM_VALUES) && (fread (&t, sizeof (t), 1, out) == 1); i++) {
+
+    diff += (t != tv[i]);
+  }
+  diff += (i != STREAM_VALUES) || (fread (&r, sizeof (r), 1, out) != 0);
+  fclose (in);
+  fclose (out);
+  free (rv);
+  free (tv);
+  printf ("stream\n  %d values : %d differences\n", STREAM_VALUES, diff);
+  return diff ? -1 : 0;
+}
+
+/**
+ * Counts the pairs of a table file, stops the reading at a given count.
+ * @param user counter of the pairs, sum of the temperatures and of the
+ * resistances, count of the pair stopping the reading (0 for none).
+ * @param t temperature.
+ * @param r resistance.
+ * @return 0, -1 to stop the reading.
+ */
+static int
+iCountPair (void * user, double t, double r) {
+  double * c = user;
+
+  c[0] += 1.0;
+  c[1] += t;
+  c[2] += r;
+  return (c[0] == c[3]) ? -1 : 0;
+}
+
+/**
+ * Checks the reading of the table files: headers, comments, line endings,
+ * separators and the line and errno of the errors.
+ * @return 0, -1 if a result differs.
+ */
+static int
+iCheckTableFile (void) {
+  static const struct {
+    const char * sText; /* content of the file */
+    int iStop;          /* pair stopping the reading, 0 for none */
+    long long llPairs;  /* pairs read, -1 for an error */
+    size_t xLine;       /* line of the error */
+    int iErrno;         /* errno of the error */
+    double dSum;        /* sum of the temperatures and resistances read */
+  } xCase[] = {
+    /* header, comment, CRLF, separators, extra column, no final newline */
+    { "Temp;Res\r\n# comment\r\n\r\n-10;55000\r\n0,32000,x\r\n"
+      "25\t10000\r\n  50 3600", 0, 4, 0, 0, 100665.0 },
+    { "0 32000\n25 10000\nfoo 1\n", 0, -1, 3, EINVAL, 0.0 },
+    { "0 32000\n25\n", 0, -1, 2, EINVAL, 0.0 },
+    { "0 32000\n# comment\n25 -5\n", 0, -1, 3, ERANGE, 0.0 },
+    { "0 32000\n-300 10000\n", 0, -1, 2, ERANGE, 0.0 },
+    { "0 32000\n25 10000\n50 3600\n", 2, -1, 2, ECANCELED, 0.0 },
+    { "", 0, -1, 0, EINVAL, 0.0 }
+  };
+  char path[] = "/tmp/ntc-check-XXXXXX";
+  double c[4];
+  size_t i, line;
+  long long n;
+  int fd, diff = 0;
+
+  for (i = 0; i < sizeof (xCase) / sizeof (xCase[0]); i++) {
+
+    strcpy (path, "/tmp/ntc-check-XXXXXX");
+    fd = mkstemp (path);
+    if (fd < 0) {
+
+      return -1;
+    }
+    diff += write (fd, xCase[i].sText, strlen (xCase[i].sText)) !=
+            (ssize_t) strlen (xCase[i].sText);
+    close (fd);
+    c[0] = c[1] = c[2] = 0.0;
+    c[3] = xCase[i].iStop;
+    line = (size_t) -1;
+    errno = 0;
+    n = llNtcFitReadTable (path, iCountPair, c, &line);
+    if (n < 0) {
+
+      diff += (n != xCase[i].llPairs) || (line != xCase[i].xLine) ||
+              (errno != xCase[i].iErrno);
+    }
+    else {
+
+      diff += (n != xCase[i].llPairs) || (c[0] != n) ||
+              (c[1] + c[2] != xCase[i].dSum);
+    }
+    unlink (path);
+  }
+  printf ("table files\n  %zu files : %d differences\n", i, diff);
+  return diff ? -1 : 0;
+}
+
+/**
+ * Checks that the parallel fit of all the tables, with a missing file,
+ * gives the results of the fit of each table.
+ * @return 0, -1 if a result differs.
+ */
+static int
+iCheckFitTables (void) {
+  enum { N = sizeof (xDatasets) / sizeof (xDatasets[0]) };
+  char path[N + 1][256];
+  const char * p[N + 1];
+  xNtcFitOptions o = { eNtcFitLeastSquares, FORM_MAX_ERROR };
+  xNtcFitResult r[N + 1], ref;
+  size_t i, failed;
+  int diff = 0;
+
+  for (i = 0; i <= N; i++) {
+
+    snprintf (path[i], sizeof (path[i]), "%s/%s", NTC_DATA_DIR,
+              (i < N) ? xDatasets[i].sName : "missing.csv");
+    p[i] = path[i];
+  }
+  failed = xNtcFitTables (p, r, N + 1, &o, PARALLEL_THREADS);
+  for (i = 0; i < N; i++) {
+
+    iNtcFitTable (p[i], &o, &ref);
+    diff += (memcmp (&ref, &r[i], sizeof (ref)) != 0);
+  }
+  diff += (failed != 1) || (r[N].iError != ENOENT);
+  printf ("fit tables\n  %d threads : %s\n", PARALLEL_THREADS,
+          diff ? "results differ" : "same results");
+  return diff ? -1 : 0;
+}
+
+/**
+ * Counts the spikes reported by a robust fit.
+ * @param user counters of the pairs and of the spikes reported.
+ */
+static void
+vCountOutlier (void * user, long long index, double t, double r, double e,
+               double w) {
+  long long * n = user;
+
+  (void) t;
+  (void) r;
+  (void) e;
+  (void) w;
+  n[0]++;
+  n[1] += (index % ROBUST_PERIOD) == 0;
+}
+
+/**
+ * Checks the robust fits of a noisy table with spikes: the spikes are all
+ * reported, the trimmed fit removes nothing else, and both fits stay close
+ * to the exact pairs unlike the least squares fit.
+ * @return 0, -1 on error.
+ */
+static int
+iCheckRobust (void) {
+  static const char * name[] = { "least squares", "huber", "trimmed" };
+  const double * a = xDatasets[1].dCoeff;
+  char path[] = "/tmp/ntc-check-XXXXXX";
+  double * t, * r, * tn, noise, err[3], e, max;
+  xNtcFitOptions o = { eNtcFitLeastSquares };
+  long long count[3][2];
+  char line[64];
+  unsigned seed = 1;
+  xNtcFitResult res;
+  size_t i, n;
+  int fd, m, ret = 0;
+  FILE * f;
+
+  n = (size_t) (165.0 / STEP) + 1;
+  t = malloc (n * sizeof (double));
+  r = malloc (n * sizeof (double));
+  tn = malloc (n * sizeof (double));
+  fd = mkstemp (path);
+  f = (fd < 0) ? NULL : fdopen (fd, "w");
+  if ( (t == NULL) || (r == NULL) || (tn == NULL) || (f == NULL)) {
+
+    free (t);
+    free (r);
+    free (tn);
+    return -1;
+  }
+  for (i = 0; i < n; i++) {
+
+    t[i] = -40.0 + i * STEP;
+    r[i] = dNtcTempToRes (t[i], (double *) a);
+    seed = seed * 1103515245 + 12345;
+    noise = ROBUST_NOISE * ( (seed >> 8) / 8388608.0 - 1.0);
+    if (i % ROBUST_PERIOD == 0) {
+
+      noise += ROBUST_SPIKE;
+    }
+    snprintf (line, sizeof (line), "%.6f", t[i] + noise);
+    tn[i] = atof (line);
+    fprintf (f, "%s,%.17g\n", line, r[i]);
+  }
+  fclose (f);
+  for (m = 0; m < 3; m++) {
+
+    o.eMethod = (m == 0) ? eNtcFitLeastSquares :
+                (m == 1) ? eNtcFitHuber : eNtcFitTrimmed;
+    o.vOutlier = vCountOutlier;
+    o.pvUser = count[m];
+    count[m][0] = count[m][1] = 0;
+    ret |= iNtcFitTable (path, &o, &res);
+    err[m] = dNtcFitMaxError (t, r, n, res.dCoeff, NULL);
+    ret |= (res.llDownweighted != count[m][0]);
+    /* the errors of the result are the ones of the pairs not removed */
+    for (max = 0.0, i = 0; i < n; i++) {
+
+      e = fabs (dNtcResToTemp (r[i], res.dCoeff) - tn[i]);
+      max = ( (m < 2) || (e < ROBUST_SPIKE / 2.0)) ? dMax (max, e) : max;
+    }
+    ret |= !(fabs (res.dMaxError - max) <= 1e-9);
+    ret |= (m > 0) && (res.dDownweightedError < ROBUST_SPIKE / 2.0);
+    printf ("  %-13s : max. error %.2e, %lld downweighted, %lld spikes\n",
+            name[m], err[m], count[m][0], count[m][1]);
+  }
+  unlink (path);
+  free (t);
+  free (r);
+  free (tn);
+  m = (n + ROBUST_PERIOD - 1) / ROBUST_PERIOD;
+  return ( (ret == 0) && (count[1][1] == m) && (count[2][1] == m) &&
+           (count[2][0] == m) && (err[1] <= ROBUST_TOLERANCE) &&
+           (err[2] <= ROBUST_TOLERANCE)) ? 0 : -1;
+}
+
+/** Models published by the online fit check. */
+static xNtcModel xOnline[2];
+
+/**
+ * Publishes the two models alternately.
+ * @param arg slot.
+ * @return NULL.
+ */
+static void *
+pvPublish (void * arg) {
+  int i;
+
+  for (i = 0; i < ONLINE_PUBLISH; i++) {
+
+    vNtcFitPublish (arg, &xOnline[i & 1]);
+  }
+  return NULL;
+}
+
+/**
+ * Checks that an online fit with a forgetting factor follows a thermistor
+ * replaced by another one, and that the models read while they are
+ * published are never torn.
+ * @return 0, -1 on error.
+ */
+static int
+iCheckOnline (void) {
+  const xDataset * d0 = &xDatasets[0], * d1 = &xDatasets[3];
+  double a[4], t, r, err, maxerr = 0.0;
+  xNtcFitSlot slot = { 0 };
+  xNtcModel m;
+  pthread_t tid;
+  xNtcFit * f;
+  unsigned v, last = 0;
+  int i, torn = 0, ret = 0;
+
+  f = xNtcFitNew();
+  ret |= iNtcFitSetForgetting (f, ONLINE_LAMBDA);
+  for (i = 0; i < 2 * ONLINE_PAIRS; i++) {
+
+    t = -40.0 + (i * 37 % 1650) * 0.1;
+    r = dNtcTempToRes (t, (double *) ( (i < ONLINE_PAIRS) ? d0 : d1)->dCoeff);
+    ret |= iNtcFitAdd (f, t, r);
+    /* updates as a calibration service would do */
+    if ( (i >= 4) && (iNtcFitSolve (f, a, NULL) != 0)) {
+      ret = -1;
+    }
+  }
+  vNtcFitDelete (f);
+  for (t = -40.0; t <= 125.0; t += 1.0) {
+
+    r = dNtcTempToRes (t, (double *) d1->dCoeff);
+    err = fabs (dNtcResToTemp (r, a) - t);
+    maxerr = dMax (maxerr, err);
+  }
+
+  iNtcModelInit (&xOnline[0], d0->dCoeff);
+  iNtcModelInit (&xOnline[1], d1->dCoeff);
+  vNtcFitPublish (&slot, &xOnline[1]);
+  if (pthread_create (&tid, NULL, pvPublish, &slot) != 0) {
+
+    return -1;
+  }
+  do {
+
+    v = uNtcFitGetModel (&slot, &m);
+    torn += (memcmp (&m, &xOnline[0], sizeof (m)) != 0) &&
+            (memcmp (&m, &xOnline[1], sizeof (m)) != 0);
+    ret |= (v < last);
+    last = v;
+  }
+  while (v <= ONLINE_PUBLISH);
+  pthread_join (tid, NULL);
+  ret |= (uNtcFitSlotVersion (&slot) != ONLINE_PUBLISH + 1);
+  printf ("online fit\n  lambda %g : max. error %.2e, %d torn models\n",
+          ONLINE_LAMBDA, maxerr, torn);
+  return ( (ret == 0) && (torn == 0) && (maxerr <= ONLINE_TOLERANCE)) ? 0 : -1;
+}
+
+/**
+ * Checks a catalog of the models of all the tables, the odd ones with a
+ * lookup table: each model is found by its part number with its
+ * coefficients and table, an unknown part is not found, a part given twice
+ * and a damaged file are rejected.
+ * @return 0, -1 on error.
+ */
+static int
+iCheckCatalog (void) {
+  enum { N = sizeof (xDatasets) / sizeof (xDatasets[0]) };
+  xNtcAdcConfig cfg[N], back;
+  xNtcCatalogEntry e[N + 1];
+  const xNtcCatalogModel * m;
+  const int16_t * table;
+  char path[] = "/tmp/ntc-check-XXXXXX";
+  xNtcCatalog * c;
+  xNtcLut * lut;
+  unsigned i, k, n;
+  int fd, diff = 0;
+  struct stat st;
+  mode_t mask;
+  FILE * f;
+
+  fd = mkstemp (path);
+  if (fd < 0) {
+
+    return -1;
+  }
+  close (fd);
+  memset (e, 0, sizeof (e));
+  for (i = 0; i < N; i++) {
+
+    e[i].sPart = xDatasets[i].sName;
+    memcpy (e[i].dCoeff, xDatasets[i].dCoeff, sizeof (e[i].dCoeff));
+    e[i].eForm = eNtcFormExtended;
+    e[i].dTmin = -40.0;
+    e[i].dTmax = 125.0;
+    cfg[i].dSeries = dNtcTempToRes (25.0, (double *) xDatasets[i].dCoeff);
+    cfg[i].dVref = 3.3;
+    cfg[i].dVsupply = 0.0;
+    cfg[i].iBits = LUT_BITS - i;
+    cfg[i].eDivider = (i & 2) ? eNtcPullDown : eNtcPullUp;
+    e[i].xLut = (i & 1) ? &cfg[i] : NULL;
+  }
+  e[N] = e[0];
+  /* the mode of the catalog follows the umask */
+  mask = umask (027);
+  if ( (iNtcCatalogWrite (path, e, N + 1) == 0) || (errno != EEXIST) ||
+       (iNtcCatalogWrite (path, e, N) != 0)) {
+
+    umask (mask);
+    unlink (path);
+    return -1;
+  }
+  umask (mask);
+  diff += (stat (path, &st) != 0) || ( (st.st_mode & 0777) != 0640);
+
+  c = xNtcCatalogOpen (path);
+  if (c == NULL) {
+
+    unlink (path);
+    return -1;
+  }
+  diff += (uNtcCatalogModels (c) != N);
+  for (i = 0; i < N; i++) {
+
+    m = xNtcCatalogFind (c, xDatasets[i].sName);
+    if ( (m == NULL) || (m != xNtcCatalogModelAt (c, i)) ||
+         strcmp (sNtcCatalogPart (c, m), xDatasets[i].sName) ||
+         memcmp (m->dCoeff, xDatasets[i].dCoeff, sizeof (m->dCoeff)) ||
+         (m->dTmax != 125.0)) {
+
+      diff++;
+      continue;
+    }
+    n = uNtcCatalogLut (c, m, &back, &table);
+    if (! (i & 1)) {
+
+      diff += (n != 0);
+      continue;
+    }
+    lut = xNtcLutNew (&cfg[i], xDatasets[i].dCoeff, 1);
+    if ( (lut == NULL) || (n != uNtcLutSize (lut)) ||
+         memcmp (&back, &cfg[i], sizeof (back))) {
+
+      diff++;
+    }
+    for (k = 0; (diff == 0) && (k < n); k++) {
+
+      diff += (table[k] != iNtcLutCodeToTempFixed (lut, k));
+    }
+    vNtcLutDelete (lut);
+  }
+  diff += (xNtcCatalogFind (c, "unknown") != NULL);
+  vNtcCatalogClose (c);
+
+  /* damaged version */
+  f = fopen (path, "r+");
+  if (f) {
+
+    fseek (f, 8, SEEK_SET);
+    fputc (0xff, f);
+    fclose (f);
+  }
+  c = xNtcCatalogOpen (path);
+  diff += (c != NULL) || (errno != EINVAL);
+  vNtcCatalogClose (c);
+  unlink (path);
+  printf ("catalog\n  %d models : %s\n", N,
+          diff ? "models differ" : "same models");
+  return diff ? -1 : 0;
+}
+
+/**
+ * Checks the models and lookup tables of the header generated from the
+ * tables of ntc-data: each model is the one initialized from its
+ * coefficients, each table the one built from its configuration.
+ * @return 0, -1 if a part differs.
+ */
+static int
+iCheckParts (void) {
+  const xNtcPart * p;
+  xNtcModel m;
+  xNtcLut * lut;
+  unsigned c;
+  int i, diff = 0;
+
+  for (i = 0; i < NTC_PARTS; i++) {
+
+    p = &xNtcParts[i];
+    memset (&m, 0, sizeof (m));
+    lut = xNtcLutNew (&p->xLut, p->xModel->dA, 1);
+    if ( (iNtcModelInit (&m, p->xModel->dA) != 0) ||
+         memcmp (&m, p->xModel, sizeof (m)) || (lut == NULL) ||
+         (p->iLut == NULL)) {
+
+      diff++;
+    }
+    for (c = 0; (diff == 0) && (c < uNtcLutSize (lut)); c++) {
+
+      diff += (p->iLut[c] != iNtcLutCodeToTempFixed (lut, c));
+    }
+    vNtcLutDelete (lut);
+  }
+  printf ("parts\n  %d parts : %s\n", NTC_PARTS,
+          diff ? "parts differ" : "same parts");
+  return diff ? -1 : 0;
+}
+
+/**
+ * Transitions of the setpoints of an alarm for a temperature, the
+ * reference of the alarm check.
+ * @param set setpoints.
+ * @param n number of setpoints.
+ * @param t temperature.
+ * @param state state of the setpoints, updated.
+ * @return setpoints whose state changed.
+ */
+static uint32_t
+uAlarmRef (const xNtcAlarmSetpoint set[], unsigned n, double t,
+           uint32_t * state) {
+  uint32_t flip = 0;
+  unsigned i;
+  int on;
+
+  for (i = 0; i < n; i++) {
+
+    on = (*state >> i) & 1;
+    if (set[i].eType == eNtcAlarmOver) {
+
+      flip |= (uint32_t) (on ? (t < set[i].dTemp - set[i].dHyst) :
+                          (t > set[i].dTemp)) << i;
+    }
+    else {
+
+      flip |= (uint32_t) (on ? (t > set[i].dTemp + set[i].dHyst) :
+                          (t < set[i].dTemp)) << i;
+    }
+  }
+  *state ^= flip;
+  return flip;
+}
+
+/**
+ * Checks the transitions of alarms on resistances and on ADC codes (pull-up
+ * and pull-down) of a drifting noisy temperature against the setpoints
+ * compared with the temperatures of the readings, evaluated by small
+ * batches of events.
+ * @return 0, -1 on error.
+ */
+static int
+iCheckAlarm (void) {
+  static const xNtcAlarmSetpoint set[] = {
+    { eNtcAlarmOver, 80.0, 5.0 },
+    { eNtcAlarmUnder, 0.0, 2.0 },
+    { eNtcAlarmOver, 40.0, 0.5 },
+    { eNtcAlarmUnder, -20.0, 0.0 },
+  };
+  static const char * name[] = { "resistance", "pull-up", "pull-down" };
+  enum { N = sizeof (set) / sizeof (set[0]) };
+  const double * a = xDatasets[3].dCoeff;
+  xNtcAdcConfig cfg = { 0, 3.3, 0, LUT_BITS, eNtcPullUp };
+  xNtcAlarmEvent ev[ALARM_EVENTS];
+  double * r, t, rc;
+  uint16_t * code;
+  xNtcAlarm * alarm;
+  uint32_t state, flip;
+  unsigned seed = 1;
+  size_t i, j, done, n, k, count;
+  int m, diff = 0;
+
+  r = malloc (ALARM_READINGS * sizeof (double));
+  code = malloc (ALARM_READINGS * sizeof (uint16_t));
+  if ( (r == NULL) || (code == NULL)) {
+
+    free (r);
+    free (code);
+    return -1;
+  }
+  cfg.dSeries = dNtcTempToRes (25.0, (double *) a);
+  for (m = 0; m < 3; m++) {
+
+    /* readings */
+    cfg.eDivider = (m == 2) ? eNtcPullDown : eNtcPullUp;
+    for (i = 0; i < ALARM_READINGS; i++) {
+
+      seed = seed * 1103515245 + 12345;
+      t = 30.0 + 70.0 * sin (i * 1e-4) + ( (seed >> 8) / 8388608.0 - 1.0);
+      r[i] = dNtcTempToRes (t, (double *) a);
+      /* code of the quantization step of r */
+      for (k = 0, j = 1U << LUT_BITS; k + 1 < j;) {
+
+        n = (k + j) / 2;
+        rc = dNtcAdcCodeToRes (&cfg, n);
+        if ( (cfg.eDivider == eNtcPullUp) ? ! (rc > r[i]) : (rc > r[i])) {
+          k = n;
+        }
+        else {
+          j = n;
+        }
+      }
+      code[i] = k;
+    }
+
+    alarm = xNtcAlarmNew (a, set, N, m ? &cfg : NULL);
+    if (alarm == NULL) {
+
+      diff++;
+      break;
+    }
+    state = 0;
+    count = 0;
+    for (i = 0; i < ALARM_READINGS; i += done) {
+
+      n = ALARM_EVENTS;
+      done = m ? xNtcAlarmCode (alarm, &code[i], ALARM_READINGS - i, ev, &n) :
+             xNtcAlarmRes (alarm, &r[i], ALARM_READINGS - i, ev, &n);
+      for (j = 0, k = 0; j < done; j++) {
+
+        t = m ? dNtcResToTemp (dNtcAdcCodeToRes (&cfg, code[i + j]),
+                               (double *) a) :
+            dNtcResToTemp (r[i + j], (double *) a);
+        flip = uAlarmRef (set, N, t, &state);
+        for (; flip; flip &= flip - 1, k++) {
+
+          diff += (k >= n) || (ev[k].xIndex != j) ||
+                  (ev[k].uSetpoint != (unsigned) __builtin_ctz (flip)) ||
+                  (ev[k].bActive != (int) ( (state >> ev[k].uSetpoint) & 1));
+        }
+      }
+      diff += (k != n) || (done == 0) || (uNtcAlarmState (alarm) != state);
+      count += n;
+      if (diff) {
+        break;
+      }
+    }
+    printf ("  %-10s : %zu transitions, %s\n", name[m], count,
+            diff ? "transitions differ" : "same transitions");
+    vNtcAlarmDelete (alarm);
+  }
+  free (r);
+  free (code);
+  return diff ? -1 : 0;
+}
+
+/**
+ * Main function of the check.
+ * @return 0 if all checks passed.
+ */
+int main (void)
+{
+  double tmin, tmax;
+  int i, failed = 0;
+  eNtcIsa isa;
+
+  for (i = 0; i < (int) (sizeof (xDatasets) / sizeof (xDatasets[0])); i++) {
+
+    if (iReadRange (xDatasets[i].sName, &tmin, &tmax) != 0) {
+
+      fprintf (stderr, "Cannot read %s/%s\n", NTC_DATA_DIR, xDatasets[i].sName);
+      return EXIT_FAILURE;
+    }
+    printf ("%s [%.1f, %.1f]\n", xDatasets[i].sName, tmin, tmax);
+    if ( (iCheckLut (&xDatasets[i], tmin, tmax) != 0) ||
+         (iCheckSpline (&xDatasets[i], tmin, tmax) != 0) ||
+         (iCheckFixed (&xDatasets[i], tmin, tmax) != 0) ||
+         (iCheckFit (&xDatasets[i], tmin, tmax) != 0) ||
+         (iCheckMinimax (&xDatasets[i], tmin, tmax) != 0)) {
+
+      printf ("  FAILED\n");
+      failed++;
+    }
+    for (isa = eNtcIsaScalar; isa <= eNtcIsaAvx512; isa++) {
+
+      if (iNtcIsaSet (isa) != 0) {
+        continue;
+      }
+      printf ("  %s\n", sNtcIsaName (isa));
+      if ( (iCheckBatch (&xDatasets[i], tmin, tmax) != 0) ||
+           (iCheckInverse (&xDatasets[i], tmin, tmax) != 0) ||
+           (iCheckFloat (&xDatasets[i], tmin, tmax) != 0) ||
+           (iCheckForms (&xDatasets[i], tmin, tmax) != 0)) {
+
+        printf ("  FAILED\n");
+        failed++;
+      }
+    }
+    iNtcIsaSet (eNtcIsaAuto);
+  }
+  printf ("sensor bank\n");
+  for (isa = eNtcIsaScalar; isa <= eNtcIsaAvx512; isa++) {
+
+    if (iNtcIsaSet (isa) != 0) {
+      continue;
+    }
+    printf ("  %s\n", sNtcIsaName (isa));
+    if (iCheckBank() != 0) {
+
+      printf ("  FAILED\n");
+      failed++;
+    }
+  }
+  iNtcIsaSet (eNtcIsaAuto);
+  if (iCheckParallel() != 0) {
+
+    printf ("  FAILED\n");
+    failed++;
+  }
+  if (iCheckStream() != 0) {
+
+    printf ("  FAILED\n");
+    failed++;
+  }
+  if (iCheckTableFile() != 0) {
+
+    printf ("  FAILED\n");
+    failed++;
+  }
+  if (iCheckFitTables() != 0) {
+
+    printf ("  FAILED\n");
+    failed++;
+  }
+  printf ("robust fit\n");
+  if (iCheckRobust() != 0) {
+
+    printf ("  FAILED\n");
+    failed++;
+  }
+  if (iCheckOnline() != 0) {
+
+    printf ("  FAILED\n");
+    failed++;
+  }
+  if (iCheckCatalog() != 0) {
+
+    printf ("  FAILED\n");
+    failed++;
+  }
+  if (iCheckParts() != 0) {
+
+    printf ("  FAILED\n");
+    failed++;
+  }
+  printf ("alarm\n");
+  if (iCheckAlarm() != 0) {
+
+    printf ("  FAILED\n");
+    failed++;
+  }
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,315 @@
+/*
+ * NTC thermistor library
+ * Version 1.0
+ * Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307
+ * USA
+ */
+
+/** @file options.c
+ * Options of the conversion programs r2t and t2r.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <ntc-parts.h>
+#include "options.h"
+
+/************
+* Variables *
+************/
+
+/**
+ * Long options, the short ones have the same letter.
+ */
+static const struct option xLongOpts[] = {
+  { "coeff", required_argument, NULL, 'c' },
+  { "model", required_argument, NULL, 'm' },
+  { "part", required_argument, NULL, 'p' },
+  { "stream", no_argument, NULL, 's' },
+  { "input", required_argument, NULL, 'i' },
+  { "output", required_argument, NULL, 'o' },
+  { "in-format", required_argument, NULL, 'f' },
+  { "out-format", required_argument, NULL, 'F' },
+  { "decimals", required_argument, NULL, 'd' },
+  { "help", no_argument, NULL, 'h' },
+  { NULL, 0, NULL, 0 }
+};
+
+/**
+ * Short options.
+ */
+static const char sShortOpts[] = "c:m:p:si:o:f:F:d:h";
+
+/************
+* Functions *
+************/
+
+/**
+ * Prints the usage of the program.
+ * @param me program name.
+ * @param value name of the values.
+ */
+static void
+vUsage (const char * me, const char * value) {
+
+  fprintf (stderr, "usage : %s [ options ] [ %s ... ]\n", me, value);
+  fprintf (stderr,
+           "valid options are :\n"
+           "  -c, --coeff a0,a1,a2,a3 Steinhart-Hart coefficients\n"
+           "  -m, --model file        read the coefficients from a file of ntc-coeff\n"
+           "  -p, --part name         coefficients of a part of ntc-data\n"
+           "  -s, --stream            convert a stream instead of the arguments\n"
+           "  -i, --input file        stream input (default standard input)\n"
+           "  -o, --output file       stream output (default standard output)\n"
+           "  -f, --in-format fmt     stream input format: text, f64 or f32\n"
+           "  -F, --out-format fmt    stream output format: text, f64 or f32\n"
+           "  -d, --decimals n        digits after the decimal point (default 6)\n"
+           "  -h, --help              print this message\n");
+}
+
+/**
+ * Parses a stream format.
+ * @param s text, f64 or f32.
+ * @param f format.
+ * @return 0, -1 if unknown.
+ */
+static int
+iFormat (const char * s, eNtcStreamFormat * f) {
+
+  if (strcmp (s, "text") == 0) {
+    *f = eNtcStreamText;
+  }
+  else if (strcmp (s, "f64") == 0) {
+    *f = eNtcStreamDouble;
+  }
+  else if (strcmp (s, "f32") == 0) {
+    *f = eNtcStreamFloat;
+  }
+  else {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Coefficients of a part of ntc-data.
+ * @param s part number.
+ * @param a coefficients.
+ * @return 0, -1 if unknown.
+ */
+static int
+iPart (const char * s, double a[4]) {
+  int i;
+
+  for (i = 0; i < NTC_PARTS; i++) {
+
+    if (strcmp (s, xNtcParts[i].sPart) == 0) {
+
+      memcpy (a, xNtcParts[i].xModel->dA, 4 * sizeof (double));
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Tests if an argument is a number.
+ * @param s argument.
+ * @return true if the whole argument is a number.
+ */
+static int
+iIsNumber (const char * s) {
+  char * end;
+
+  strtod (s, &end);
+  return (end != s) && (*end == 0);
+}
+
+/**
+ * Separates the values from the options, so that negative values are not
+ * taken for options.
+ * @param argc number of arguments.
+ * @param argv argument list, the values are removed.
+ * @param vals values found, in order.
+ * @param nvals number of values found.
+ * @return new number of arguments.
+ */
+static int
+iSplitArgs (int argc, char * argv[], char * vals[], int * nvals) {
+  int i, j, n = 1, param = 0;
+
+  *nvals = 0;
+  for (i = 1; i < argc; i++) {
+
+    if (!param && iIsNumber (argv[i])) {
+
+      vals[ (*nvals)++] = argv[i];
+      continue;
+    }
+    argv[n++] = argv[i];
+    if (param) {
+
+      param = 0;
+    }
+    else if ( (argv[i][0] == '-') && (argv[i][1] != '-') &&
+              (argv[i][1] != 0) && (argv[i][2] == 0)) {
+
+      param = (strchr (sShortOpts, argv[i][1]) != NULL) &&
+              (strchr (sShortOpts, argv[i][1])[1] == ':');
+    }
+    else if ( (strncmp (argv[i], "--", 2) == 0) &&
+              (strchr (argv[i], '=') == NULL)) {
+
+      for (j = 0; xLongOpts[j].name; j++) {
+
+        if (strcmp (&argv[i][2], xLongOpts[j].name) == 0) {
+          param = (xLongOpts[j].has_arg == required_argument);
+        }
+      }
+    }
+  }
+  argv[n] = NULL;
+  return n;
+}
+
+// -----------------------------------------------------------------------------
+int
+iOptionsParse (int argc, char * argv[], const char * sValue,
+               const double dDefault[4], xOptions * xOpt) {
+  int i, c;
+
+  memset (xOpt, 0, sizeof (xOptions));
+  memcpy (xOpt->dCoeff, dDefault, sizeof (xOpt->dCoeff));
+  xOpt->xCfg.eIn = eNtcStreamText;
+  xOpt->xCfg.eOut = eNtcStreamText;
+  xOpt->xCfg.iDecimals = 6;
+  xOpt->iIn = -1;
+  xOpt->iOut = -1;
+  xOpt->sVals = malloc (argc * sizeof (char *));
+  if (xOpt->sVals == NULL) {
+
+    perror (argv[0]);
+    return -1;
+  }
+  argc = iSplitArgs (argc, argv, xOpt->sVals, &xOpt->iVals);
+  while ( (c = getopt_long (argc, argv, sShortOpts, xLongOpts, NULL)) != -1) {
+
+    switch (c) {
+      case 'c':
+        if (iNtcStreamParseCoeff (optarg, xOpt->dCoeff) != 0) {
+
+          fprintf (stderr, "Invalid coefficients: %s\n", optarg);
+          return -1;
+        }
+        break;
+      case 'm':
+        if (iNtcStreamReadModel (optarg, xOpt->dCoeff) != 0) {
+
+          fprintf (stderr, "Cannot read coefficients from %s\n", optarg);
+          return -1;
+        }
+        break;
+      case 'p':
+        if (iPart (optarg, xOpt->dCoeff) != 0) {
+
+          fprintf (stderr, "Unknown part: %s, valid parts are :\n", optarg);
+          for (i = 0; i < NTC_PARTS; i++) {
+
+            fprintf (stderr, "  %s\n", xNtcParts[i].sPart);
+          }
+          return -1;
+        }
+        break;
+      case 's':
+        xOpt->bStream = 1;
+        break;
+      case 'i':
+        xOpt->sInput = optarg;
+        break;
+      case 'o':
+        xOpt->sOutput = optarg;
+        break;
+      case 'f':
+      case 'F':
+        if (iFormat (optarg, (c == 'f') ? &xOpt->xCfg.eIn :
+                     &xOpt->xCfg.eOut) != 0) {
+
+          fprintf (stderr, "Unknown format: %s\n", optarg);
+          return -1;
+        }
+        break;
+      case 'd':
+        xOpt->xCfg.iDecimals = atoi (optarg);
+        if ( (xOpt->xCfg.iDecimals < 0) || (xOpt->xCfg.iDecimals > 9)) {
+
+          fprintf (stderr, "Decimals must be between 0 and 9\n");
+          return -1;
+        }
+        break;
+      default:
+        vUsage (argv[0], sValue);
+        return (c == 'h') ? 1 : -1;
+    }
+  }
+  if (optind < argc) {
+
+    fprintf (stderr, "Invalid value: %s\n", argv[optind]);
+    return -1;
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+int
+iOptionsOpen (xOptions * xOpt) {
+
+  xOpt->iIn = 0;
+  if (xOpt->sInput && ( (xOpt->iIn = open (xOpt->sInput, O_RDONLY)) < 0)) {
+
+    perror (xOpt->sInput);
+    return -1;
+  }
+  xOpt->iOut = 1;
+  if (xOpt->sOutput && ( (xOpt->iOut = open (xOpt->sOutput,
+                          O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)) {
+
+    perror (xOpt->sOutput);
+    return -1;
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+void
+vOptionsFree (xOptions * xOpt) {
+
+  if (xOpt->sInput && (xOpt->iIn >= 0)) {
+
+    close (xOpt->iIn);
+  }
+  if (xOpt->sOutput && (xOpt->iOut >= 0)) {
+
+    close (xOpt->iOut);
+  }
+  free (xOpt->sVals);
+  xOpt->sVals = NULL;
+}
@@ -0,0 +1,77 @@
+/*
+ * NTC thermistor library
+ * Version 1.0
+ * Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307
+ * USA
+ */
+
+/** @file options.h
+ * Options of the conversion programs r2t and t2r.
+ * Both programs take the same options: coefficients (-c, -m, -p), stream
+ * mode (-s) and its files (-i, -o), formats (-f, -F) and decimals (-d);
+ * only the direction of the conversion differs.
+ */
+#ifndef _OPTIONS_H_
+#define _OPTIONS_H_
+#include <ntc-stream.h>
+
+/**
+ * Options of a conversion program
+ */
+typedef struct xOptions {
+  double dCoeff[4];         /**< Steinhart-Hart coefficients */
+  xNtcStreamConfig xCfg;    /**< formats of the stream */
+  const char * sInput;      /**< stream input, NULL for standard input */
+  const char * sOutput;     /**< stream output, NULL for standard output */
+  int bStream;              /**< convert a stream instead of the values */
+  int iIn;                  /**< stream input file descriptor */
+  int iOut;                 /**< stream output file descriptor */
+  char ** sVals;            /**< values of the command line, in order */
+  int iVals;                /**< number of values */
+} xOptions;
+
+/**
+ * Parses the command line.
+ * Values are separated from the options first, so that negative values are
+ * not taken for options. Errors are reported on stderr.
+ * @param argc number of arguments.
+ * @param argv argument list, the values are removed.
+ * @param sValue name of the values in the usage (resistance, temperature).
+ * @param dDefault default coefficients.
+ * @param xOpt options found, released with vOptionsFree().
+ * @return 0, 1 if the usage was requested (-h), -1 on error.
+ */
+int iOptionsParse (int argc, char * argv[], const char * sValue,
+                   const double dDefault[4], xOptions * xOpt);
+
+/**
+ * Opens the files of the stream, iIn and iOut are the standard input and
+ * output without -i and -o.
+ * @param xOpt options.
+ * @return 0, -1 on error (reported on stderr).
+ */
+int iOptionsOpen (xOptions * xOpt);
+
+/**
+ * Releases the options and closes the files opened by iOptionsOpen().
+ * @param xOpt options.
+ */
+void vOptionsFree (xOptions * xOpt);
+
+#endif /* _OPTIONS_H_ defined */
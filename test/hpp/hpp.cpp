@@ -0,0 +1,117 @@
+/*
+ * NTC thermistor library
+ * Version 1.0
+ * Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307
+ * USA
+ */
+
+/** @file hpp.cpp
+ * Program checking the compile-time models of ntc.hpp: the tables are
+ * generated by the compiler and compared with the C library at run time.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ntc.hpp>
+
+/** AVX NJ28 MA3960 - 3k */
+struct Ma3960 {
+  static constexpr double a[] = {
+    1.384458976342609e-03,
+    2.393452650459891e-04,
+    4.184121390081160e-07,
+    5.134115012343303e-08
+  };
+};
+
+/** Murata NXFT15-10k */
+struct Nxft15 {
+  static constexpr double a[] = {
+    9.310296797541951e-04,
+    2.308343095769287e-04,
+    3.001370069362199e-06,
+    5.407975166655454e-08
+  };
+};
+
+/** 12-bit ADC, 10k pull-up, ratiometric */
+struct Divider {
+  static constexpr double series = 10000.0;
+  static constexpr double vref = 3.3;
+  static constexpr double vsupply = 0.0;
+  static constexpr int bits = 12;
+  static constexpr bool pullUp = true;
+};
+
+using Sensor = ntc::Model<Nxft15>;
+
+/* Tables computed by the compiler */
+static constexpr auto xTable = ntc::adcTable<Sensor, Divider> ();
+static constexpr auto xFixed = ntc::adcTable<Sensor, Divider, int16_t> ();
+static constexpr auto xRes = ntc::resTable<ntc::Model<Ma3960>, 166> (-40.0, 1.0);
+
+/* Middle code: divider at half supply, r = series, that is 25 degree Celsius */
+static_assert (xTable[2047] > 24.9 && xTable[2047] < 25.1, "bad adc table");
+static_assert (xFixed[2047] > 2490 && xFixed[2047] < 2510, "bad fixed table");
+static_assert (Sensor::tempToRes (Sensor::resToTemp (12345.0)) > 12344.999 &&
+               Sensor::tempToRes (Sensor::resToTemp (12345.0)) < 12345.001,
+               "bad round trip");
+
+/**
+ * Main function of the check.
+ * @return 0 if all checks passed.
+ */
+int main ()
+{
+  const auto c = Sensor::coefficients ();
+  const auto cm = ntc::Model<Ma3960>::coefficients ();
+  xNtcAdcConfig cfg = { Divider::series, Divider::vref, Divider::vsupply,
+                        Divider::bits, eNtcPullUp
+                      };
+  xNtcLut * lut = xNtcLutNew (&cfg, c.data (), 0);
+  xNtcLut * fix = xNtcLutNew (&cfg, c.data (), 1);
+  double err, maxerr = 0.0, maxres = 0.0;
+  int fixdiff = 0;
+
+  for (std::size_t i = 0; i < xTable.size (); i++) {
+
+    err = std::fabs (xTable[i] - dNtcLutCodeToTemp (lut, i));
+    if (err > maxerr) {
+      maxerr = err;
+    }
+    if (std::abs (xFixed[i] - iNtcLutCodeToTempFixed (fix, i)) > fixdiff) {
+      fixdiff = std::abs (xFixed[i] - iNtcLutCodeToTempFixed (fix, i));
+    }
+  }
+  for (std::size_t i = 0; i < xRes.size (); i++) {
+
+    err = std::fabs (xRes[i] - dNtcTempToRes (-40.0 + i, (double *) cm.data ()))
+          / xRes[i];
+    if (err > maxres) {
+      maxres = err;
+    }
+  }
+  std::printf ("adc table   : max. error %.3e, fixed point max. difference %d\n",
+               maxerr, fixdiff);
+  std::printf ("res table   : max. relative error %.3e\n", maxres);
+  vNtcLutDelete (lut);
+  vNtcLutDelete (fix);
+  return (maxerr < 1e-9 && fixdiff == 0 && maxres < 1e-12) ? EXIT_SUCCESS :
+         EXIT_FAILURE;
+}
@@ -52,58 +52,85 @@
  *
  * The program calculates the calculates the temperature from a given resistance value of an NTC
  * according to that formula.
+ *
+ * Usage: r2t [ options ] [ resistance ... ]
+ *
+ * Without value, the program asks for one. With the option -s, it converts
+ * a stream instead: newline-delimited text or raw little endian doubles or
+ * floats read from the standard input (or -i file), converted by batches
+ * and written as text or raw binary to the standard output (or -o file).
+ * The coefficients are given by -c a0,a1,a2,a3, read by -m from a file
+ * written by ntc-coeff, or taken by -p from the models of the parts of
+ * ntc-data compiled in (ntc-parts.h, generated by ntc-catalog).
  */
 #include <stdio.h>
-#include <stdlib.h>
-#include <ntc.h>
+#include <ntc-stream.h>
+#include "options.h"
+
+/************
+* Variables *
+************/
+
+/**
+ * Default coefficients of Steinhart-Hart polynom (AVX NJ28 MA3960 - 3k).
+ */
+static const double dDefault[4] = {
+  1.384458976342609e-03,
+  2.393452650459891e-04,
+  4.184121390081160e-07,
+  5.134115012343303e-08
+};
+
+/************
+* Functions *
+************/
 
 /**
  * Main function for conversion from resistance to temperature.
  * Calculates temperature for given resistance and prints result to console.
  * If called without parameters, the user is requested for resistance value,
  * otherwise all arguments are used as resistances, converted to temperature
- * and printed to console.
+ * and printed to console. With the option -s, converts a stream.
  * @param argc number of arguments.
  * @param argv argument list.
- * @return 0 indicating no error.
+ * @return 0, 1 on error.
  */
 int main(int argc, char *argv[])
 {
-  int i;
+  xOptions opt;
+  int i, ret;
   double r;
 
-#if 0
-  /* Coefficients of Steinhart-Hart polynom. */
-  double a[] = {
-    4.524024725919526e-004,
-    3.934722516618191e-004,
-    -7.642331765196044e-006,
-    4.048572707661904e-007,
-  };
-  // Murata NXFT15-10k
-  double a[] = {
-    9.310296797541951e-04,
-    2.308343095769287e-04,
-    3.001370069362199e-06,
-    5.407975166655454e-08
-  };
-#endif
-  // AVX NJ28 MA3960 - 3k
-  double a[] = {
-    1.384458976342609e-03,
-    2.393452650459891e-04,
-    4.184121390081160e-07,
-    5.134115012343303e-08
-  };
+  ret = iOptionsParse (argc, argv, "resistance", dDefault, &opt);
+  if (ret != 0) {
+
+    vOptionsFree (&opt);
+    return (ret > 0) ? 0 : 1;
+  }
+
+  if (opt.bStream) {
+    long long n = -1;
+
+    if (iOptionsOpen (&opt) == 0) {
+
+      n = llNtcStreamResToTemp (opt.iIn, opt.iOut, &opt.xCfg, opt.dCoeff);
+      if (n < 0) {
+
+        perror ("Stream conversion");
+      }
+    }
+    vOptionsFree (&opt);
+    return (n < 0) ? 1 : 0;
+  }
 
   printf("Thermistor library version 1.0\n");
   printf("Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany\n\n");
-  if (argc > 1) {
+  if (opt.iVals > 0) {
 
-    for (i = 1; i < argc; i++) {
+    for (i = 0; i < opt.iVals; i++) {
 
-      sscanf(argv[i], "%lf", &r);
-      printf("tResistance : %f\tTemperature : %f\n", r, dNtcResToTemp(r, a));
+      sscanf(opt.sVals[i], "%lf", &r);
+      printf("tResistance : %f\tTemperature : %f\n", r, dNtcResToTemp(r, opt.dCoeff));
     }
   }
   else {
@@ -114,7 +141,8 @@ int main(int argc, char *argv[])
       printf("Resistance... : ");
       e = scanf("%lf", &r);
     } while (e == 0);
-    printf("Temperature.. : %f\n", dNtcResToTemp(r, a));
+    printf("Temperature.. : %f\n", dNtcResToTemp(r, opt.dCoeff));
   }
+  vOptionsFree (&opt);
   return 0;
 }
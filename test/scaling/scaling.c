@@ -0,0 +1,115 @@
+/*
+ * NTC thermistor library
+ * Version 1.0
+ * Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307
+ * USA
+ */
+
+/** @file scaling.c
+ * Benchmark of the parallel batch conversions.
+ * Converts an array of resistances to temperatures and back with 1 to n
+ * threads and prints, for each number of threads, the time per value and
+ * the speedup against one thread.
+ *
+ * Usage: scaling [values [max. threads]]
+ *
+ * The default is 2^26 values and twice the number of online processors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ntc-parallel.h>
+
+/**
+ * Steinhart-Hart coefficients of the benchmark (avx-ma3960).
+ */
+static const double dCoeff[4] = {
+  1.384458976342609e-03, 2.393452650459891e-04,
+  4.184121390081160e-07, 5.134115012343303e-08
+};
+
+/**
+ * Monotonic time.
+ * @return time in seconds.
+ */
+static double
+dNow (void) {
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Main function of the benchmark.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return 0, 1 on error.
+ */
+int main (int argc, char ** argv)
+{
+  size_t i, n = (size_t) 1 << 26;
+  double * r, * t, t0, t1, t2, base[2] = { 0.0, 0.0 };
+  int th, max;
+  xNtcModel m;
+
+  iNtcParallelSetThreads (0);
+  max = 2 * iNtcParallelThreads();
+  if (argc > 1) {
+    n = strtoul (argv[1], NULL, 0);
+  }
+  if (argc > 2) {
+    max = atoi (argv[2]);
+  }
+  r = pvNtcParallelAlloc (n, sizeof (double));
+  t = pvNtcParallelAlloc (n, sizeof (double));
+  if ( (r == NULL) || (t == NULL) || (max < 1)) {
+
+    fprintf (stderr, "Cannot allocate %zu values\n", n);
+    return 1;
+  }
+  iNtcModelInit (&m, dCoeff);
+  for (i = 0; i < n; i++) {
+
+    t[i] = -55.0 + 205.0 * (double) i / (double) n;
+  }
+
+  printf ("%zu values, %s kernel\n", n, sNtcIsaName (eNtcIsaGet()));
+  printf ("threads  r2t ns/value  speedup  t2r ns/value  speedup\n");
+  for (th = 1; th <= max; th++) {
+
+    iNtcParallelSetThreads (th);
+    t0 = dNow();
+    vNtcParallelTempToResArray (&m, t, r, n);
+    t1 = dNow();
+    vNtcParallelResToTempArray (r, t, n, dCoeff);
+    t2 = dNow();
+    if (th == 1) {
+
+      base[0] = t2 - t1;
+      base[1] = t1 - t0;
+    }
+    printf ("%7d  %12.3f  %7.2f  %12.3f  %7.2f\n", th,
+            (t2 - t1) / n * 1e9, base[0] / (t2 - t1),
+            (t1 - t0) / n * 1e9, base[1] / (t1 - t0));
+  }
+  free (r);
+  free (t);
+  return 0;
+}
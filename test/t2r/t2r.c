@@ -89,45 +89,91 @@
  *
  * The program calculates the calculates the temperature from a given resistance value of an NTC
  * according to that formula.
+ *
+ * Usage: t2r [ options ] [ temperature ... ]
+ *
+ * Without value, the program asks for one. With the option -s, it converts
+ * a stream instead: newline-delimited text or raw little endian doubles or
+ * floats read from the standard input (or -i file), converted by batches
+ * and written as text or raw binary to the standard output (or -o file).
+ * The coefficients are given by -c a0,a1,a2,a3, read by -m from a file
+ * written by ntc-coeff, or taken by -p from the models of the parts of
+ * ntc-data compiled in (ntc-parts.h, generated by ntc-catalog).
  */
 #include <stdio.h>
-#include <stdlib.h>
-#include <ntc.h>
-
+#include <ntc-stream.h>
+#include "options.h"
 
 /************
 * Variables *
 ************/
 
 /**
- * Main funktion for conversion from temperature to resistance.
+ * Default coefficients of Steinhart-Hart polynom.
+ */
+static const double dDefault[4] = {
+  4.524024725919526e-004,
+  3.934722516618191e-004,
+  -7.642331765196044e-006,
+  4.048572707661904e-007,
+};
+
+/************
+* Functions *
+************/
+
+/**
+ * Main function for conversion from temperature to resistance.
  * Calculates resistance for given temperature and prints result to console.
  * If called without parameters, the user is requested for temperature value,
  * otherwise all arguments are used as temperatures, converted to resistance
- * and printed to console.
+ * and printed to console. With the option -s, converts a stream.
  * @param argc number of arguments.
  * @param argv argument list.
- * @return 0 indicating no error.
+ * @return 0, 1 on error.
  */
 int main(int argc, char *argv[])
 {
-  int i;
+  xOptions opt;
+  int i, ret;
   double t;
-  /* Coefficients of Steinhart-Hart polynom. */
-  double a[] = {
-    4.524024725919526e-004,
-    3.934722516618191e-004,
-    -7.642331765196044e-006,
-    4.048572707661904e-007,
-  };
+  xNtcModel m;
+
+  ret = iOptionsParse (argc, argv, "temperature", dDefault, &opt);
+  if (ret != 0) {
+
+    vOptionsFree (&opt);
+    return (ret > 0) ? 0 : 1;
+  }
+  if (iNtcModelInit (&m, opt.dCoeff) != 0) {
+
+    fprintf (stderr, "Coefficients can not be inverted\n");
+    vOptionsFree (&opt);
+    return 1;
+  }
+
+  if (opt.bStream) {
+    long long n = -1;
+
+    if (iOptionsOpen (&opt) == 0) {
+
+      n = llNtcStreamTempToRes (opt.iIn, opt.iOut, &opt.xCfg, &m);
+      if (n < 0) {
+
+        perror ("Stream conversion");
+      }
+    }
+    vOptionsFree (&opt);
+    return (n < 0) ? 1 : 0;
+  }
 
   printf("Thermistor library version 1.0\n");
   printf("Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany\n\n");
-  if (argc > 1) {
+  if (opt.iVals > 0) {
 
-    for (i = 1; i < argc; i++) {
-      sscanf(argv[i], "%lf", &t);
-      printf("Temperature : %f\tResistance... : %f\n", t, dNtcTempToRes(t, a));
+    for (i = 0; i < opt.iVals; i++) {
+      sscanf(opt.sVals[i], "%lf", &t);
+      printf("Temperature : %f\tResistance... : %f\n", t, dNtcModelTempToRes(&m, t));
     }
   }
   else {
@@ -137,7 +183,8 @@ int main(int argc, char *argv[])
       printf("Temperature.. : ");
       e = scanf("%lf", &t);
     } while (e == 0);
-    printf("Resistance... : %f\n", dNtcTempToRes(t, a));
+    printf("Resistance... : %f\n", dNtcModelTempToRes(&m, t));
   }
+  vOptionsFree (&opt);
   return 0;
 }
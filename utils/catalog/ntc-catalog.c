@@ -0,0 +1,550 @@
+/*
+ * NTC thermistor library
+ * Version 1.0
+ * Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany
+ * Contact: thermistor (at) softquadrat.de
+ * Web site: thermistor.sourceforge.net
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307
+ * USA
+ */
+
+/** @file ntc-catalog.c
+ * Program building and listing the catalogs of models (see ntc-catalog.h).
+ *
+ * Each T-R table is fitted (in parallel), its part number is the name of its
+ * file without the extension. With an ADC resolution, a fixed point lookup
+ * table of the divider is stored with each model, its series resistor is
+ * the resistance of the thermistor at 25 degree Celsius if not given.
+ * With -c, a C header is written instead of a catalog: one const
+ * precomputed model per part and the array xNtcParts[] (see xNtcPart), the
+ * lookup tables being compiled only if NTC_PARTS_LUT is defined. The build
+ * generates src/ntc-parts.h in this way from the tables of ntc-data (make
+ * parts in utils/catalog).
+ *
+ * Usage: ntc-catalog [-o catalog] [-e max_error] [-m] [-j threads]
+ *                    [-b bits] [-s series] [-r vref] [-u vsupply] [-d]
+ *                    [-c header] [table ...]
+ *        ntc-catalog -l catalog [part ...]
+ *
+ * The default catalog is ntc.cat, built from the tables of ntc-data.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <ctype.h>
+#include <glob.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <ntc.h>
+#include <ntc-fit.h>
+#include <ntc-catalog.h>
+
+/** Default catalog. */
+#define CATALOG "ntc.cat"
+
+/**
+ * Temperature range of a table.
+ * @param pvUser minimal and maximal temperatures.
+ * @return 0.
+ */
+static int
+iRange (void * pvUser, double dTemp, double dRes) {
+  double * range = pvUser;
+
+  (void) dRes;
+  range[0] = (dTemp < range[0]) ? dTemp : range[0];
+  range[1] = (dTemp > range[1]) ? dTemp : range[1];
+  return 0;
+}
+
+/**
+ * Writes a string as a C string literal, '"' and '\\' escaped, the other
+ * non printable characters and a '/' following a '*' in octal so that the
+ * literal may also be written in a comment.
+ * @param f output.
+ * @param s string.
+ */
+static void
+vLiteral (FILE * f, const char * s) {
+  unsigned c, prev = 0;
+
+  fputc ('"', f);
+  for (; *s; s++, prev = c) {
+
+    c = (unsigned char) *s;
+    if ( (c == '"') || (c == '\\')) {
+
+      fprintf (f, "\\%c", c);
+    }
+    else if (!isprint (c) || ( (c == '/') && (prev == '*'))) {
+
+      fprintf (f, "\\%03o", c);
+    }
+    else {
+
+      fputc (c, f);
+    }
+  }
+  fputc ('"', f);
+}
+
+/**
+ * Writes the content of a C header of precomputed models.
+ * @param f header.
+ * @param e models.
+ * @param n number of models.
+ * @param id identifiers of the models.
+ * @return 0, -1 with errno set on a write error or to EINVAL for a model
+ * that can not be initialized.
+ */
+static int
+iHeaderWrite (FILE * f, const xNtcCatalogEntry e[], size_t n,
+              char (* id) [64]) {
+  static const char * form[] = {
+    "eNtcFormSimplified", "eNtcFormStandard", "eNtcFormExtended"
+  };
+  xNtcModel m;
+  xNtcLut * lut;
+  size_t i;
+  unsigned c;
+
+  fprintf (f, "/*\n"
+           " * Models of NTC thermistors generated by ntc-catalog -c, do not "
+           "edit.\n"
+           " * Define NTC_PARTS_LUT before including it to compile the lookup "
+           "tables.\n"
+           " */\n"
+           "#ifndef _NTC_PARTS_H_\n"
+           "#define _NTC_PARTS_H_\n"
+           "#include <ntc-catalog.h>\n\n"
+           "/** Number of parts of xNtcParts[] */\n"
+           "#define NTC_PARTS %zu\n\n"
+           "#ifdef NTC_PARTS_LUT\n"
+           "#define NTC_PARTS_TABLE(t) t\n"
+           "#else\n"
+           "#define NTC_PARTS_TABLE(t) NULL\n"
+           "#endif\n", n);
+
+  for (i = 0; i < n; i++) {
+
+    if (iNtcModelInit (&m, e[i].dCoeff) != 0) {
+
+      errno = EINVAL;
+      return -1;
+    }
+    fprintf (f, "\n/* ");
+    vLiteral (f, e[i].sPart);
+    fprintf (f, ": %g to %g degree, max. error %.3e */\n"
+             "static const xNtcModel xNtcModel_%s = {\n"
+             "  { %.17g, %.17g,\n    %.17g, %.17g },\n"
+             "  { %.17g, %.17g, %.17g },\n"
+             "  %.17g, %s\n};\n", e[i].dTmin, e[i].dTmax,
+             e[i].dMaxError, id[i], m.dA[0], m.dA[1], m.dA[2], m.dA[3],
+             m.dSeed[0], m.dSeed[1], m.dSeed[2], m.dSeedY, form[m.eForm]);
+    if (e[i].xLut == NULL) {
+      continue;
+    }
+    lut = xNtcLutNew (e[i].xLut, e[i].dCoeff, 1);
+    if (lut == NULL) {
+
+      errno = EINVAL;
+      return -1;
+    }
+    fprintf (f, "#ifdef NTC_PARTS_LUT\n"
+             "static const int16_t iNtcLut_%s[%u] = {", id[i],
+             uNtcLutSize (lut));
+    for (c = 0; c < uNtcLutSize (lut); c++) {
+
+      fprintf (f, "%s%d%s", (c % 10) ? " " : "\n  ",
+               iNtcLutCodeToTempFixed (lut, c),
+               (c + 1 < uNtcLutSize (lut)) ? "," : "");
+    }
+    fprintf (f, "\n};\n#endif\n");
+    vNtcLutDelete (lut);
+  }
+
+  fprintf (f, "\n/** Parts */\n"
+           "static const xNtcPart xNtcParts[NTC_PARTS] = {\n");
+  for (i = 0; i < n; i++) {
+    const xNtcAdcConfig * l = e[i].xLut;
+
+    fprintf (f, "  { ");
+    vLiteral (f, e[i].sPart);
+    fprintf (f, ", &xNtcModel_%s, %.17g, %.17g, %.17g,\n", id[i],
+             e[i].dTmin, e[i].dTmax, e[i].dMaxError);
+    if (l) {
+
+      fprintf (f, "    { %.17g, %.17g, %.17g, %d, %s },\n"
+               "    NTC_PARTS_TABLE (iNtcLut_%s) },\n", l->dSeries,
+               l->dVref, l->dVsupply, l->iBits,
+               (l->eDivider == eNtcPullUp) ? "eNtcPullUp" : "eNtcPullDown",
+               id[i]);
+    }
+    else {
+
+      fprintf (f, "    { 0, 0, 0, 0, eNtcPullUp }, NULL },\n");
+    }
+  }
+  fprintf (f, "};\n\n#endif /* _NTC_PARTS_H_ defined */\n");
+  return ferror (f) ? -1 : 0;
+}
+
+/**
+ * Writes a C header of precomputed models.
+ * The identifiers are the part numbers whose characters other than letters
+ * and digits are replaced by '_', truncated to 63 characters.
+ * The header is written in a temporary file of its directory, then renamed,
+ * so that a program being compiled never reads a partial header.
+ * @param sPath header.
+ * @param e models.
+ * @param n number of models.
+ * @return 0, -1 on error with errno set: EINVAL without model or for a
+ * model that can not be initialized, EEXIST if two part numbers give the
+ * same identifier.
+ */
+static int
+iHeader (const char * sPath, const xNtcCatalogEntry e[], size_t n) {
+  char (* id) [64];
+  char * tmp;
+  size_t i, j;
+  unsigned c, u = 0;
+  int fd, err = 0;
+  FILE * f;
+
+  if (n == 0) {
+
+    errno = EINVAL;
+    return -1;
+  }
+  id = calloc (n + 1, sizeof (* id));
+  if (id == NULL) {
+
+    return -1;
+  }
+  for (i = 0; i < n; i++) {
+
+    /* identifier of the part number */
+    for (j = 0; e[i].sPart[j] && (j < sizeof (id[i]) - 1); j++) {
+
+      c = (unsigned char) e[i].sPart[j];
+      id[i][j] = isalnum (c) ? c : '_';
+    }
+    for (j = 0; j < i; j++) {
+
+      if (strcmp (id[i], id[j]) == 0) {
+
+        fprintf (stderr, "%s and %s give the same identifier %s\n",
+                 e[j].sPart, e[i].sPart, id[i]);
+        free (id);
+        errno = EEXIST;
+        return -1;
+      }
+    }
+  }
+  tmp = malloc (strlen (sPath) + 32);
+  if (tmp == NULL) {
+
+    free (id);
+    return -1;
+  }
+  do {
+
+    sprintf (tmp, "%s.%ld.%u", sPath, (long) getpid (), u++);
+    fd = open (tmp, O_WRONLY | O_CREAT | O_EXCL, 0666);
+  } while ( (fd < 0) && (errno == EEXIST));
+  f = (fd < 0) ? NULL : fdopen (fd, "w");
+  if (f == NULL) {
+
+    err = errno;
+    if (fd >= 0) {
+
+      close (fd);
+      unlink (tmp);
+    }
+    goto error;
+  }
+  if (iHeaderWrite (f, e, n, id) != 0) {
+
+    err = errno;
+  }
+  if ( (fclose (f) != 0) && (err == 0)) {
+
+    err = errno;
+  }
+  if (err) {
+
+    unlink (tmp);
+    goto error;
+  }
+  if (rename (tmp, sPath) != 0) {
+
+    err = errno;
+    unlink (tmp);
+  }
+
+error:
+  free (tmp);
+  free (id);
+  if (err) {
+
+    errno = err;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Prints a model of a catalog.
+ * @param c catalog.
+ * @param m model.
+ */
+static void
+vPrint (const xNtcCatalog * c, const xNtcCatalogModel * m) {
+  xNtcAdcConfig cfg;
+  const int16_t * lut;
+
+  printf ("%s: form %u, a0=%.10e a1=%.10e a2=%.10e a3=%.10e\n",
+          sNtcCatalogPart (c, m), m->uForm, m->dCoeff[0], m->dCoeff[1],
+          m->dCoeff[2], m->dCoeff[3]);
+  printf ("  %g to %g degree, max. error %.3e, rms error %.3e\n", m->dTmin,
+          m->dTmax, m->dMaxError, m->dRmsError);
+  if (uNtcCatalogLut (c, m, &cfg, &lut)) {
+
+    printf ("  lookup table %d bits, series %g Ohm, pull-%s\n", cfg.iBits,
+            cfg.dSeries, (cfg.eDivider == eNtcPullUp) ? "up" : "down");
+  }
+}
+
+/**
+ * Lists a catalog.
+ * @param sPath catalog.
+ * @param sPart part numbers, all the models if none.
+ * @param iCount number of part numbers.
+ * @return 0, 1 on error or if a part number is not found.
+ */
+static int
+iList (const char * sPath, char ** sPart, int iCount) {
+  const xNtcCatalogModel * m;
+  xNtcCatalog * c;
+  unsigned i;
+  int failed = 0;
+
+  c = xNtcCatalogOpen (sPath);
+  if (c == NULL) {
+
+    perror (sPath);
+    return 1;
+  }
+  for (i = 0; (iCount == 0) && (i < uNtcCatalogModels (c)); i++) {
+
+    vPrint (c, xNtcCatalogModelAt (c, i));
+  }
+  for (i = 0; i < (unsigned) iCount; i++) {
+
+    m = xNtcCatalogFind (c, sPart[i]);
+    if (m == NULL) {
+
+      fprintf (stderr, "%s: not found\n", sPart[i]);
+      failed = 1;
+      continue;
+    }
+    vPrint (c, m);
+  }
+  vNtcCatalogClose (c);
+  return failed;
+}
+
+/**
+ * Main function of the catalog builder.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return 0, 1 on error.
+ */
+int main (int argc, char ** argv)
+{
+  xNtcFitOptions options = { eNtcFitLeastSquares, 0.0 };
+  xNtcAdcConfig cfg = { 0, 3.3, 0, 0, eNtcPullUp };
+  const char * output = CATALOG, * list = NULL, * header = NULL;
+  xNtcCatalogEntry * entry;
+  xNtcAdcConfig * adc;
+  xNtcFitResult * res;
+  char ** part, * ext;
+  double range[2];
+  size_t i, n;
+  int c, threads = 0, failed = 0;
+  glob_t g;
+
+  while ( (c = getopt (argc, argv, "o:e:mj:b:s:r:u:dc:l:h")) != -1) {
+    switch (c) {
+      case 'o':
+        output = optarg;
+        break;
+      case 'e':
+        options.dMaxError = atof (optarg);
+        break;
+      case 'm':
+        options.eMethod = eNtcFitMinimax;
+        break;
+      case 'j':
+        threads = atoi (optarg);
+        break;
+      case 'b':
+        cfg.iBits = atoi (optarg);
+        break;
+      case 's':
+        cfg.dSeries = atof (optarg);
+        break;
+      case 'r':
+        cfg.dVref = atof (optarg);
+        break;
+      case 'u':
+        cfg.dVsupply = atof (optarg);
+        break;
+      case 'd':
+        cfg.eDivider = eNtcPullDown;
+        break;
+      case 'c':
+        header = optarg;
+        break;
+      case 'l':
+        list = optarg;
+        break;
+      default:
+        fprintf (stderr, "usage : %s [-o catalog] [-e max_error] [-m] "
+                 "[-j threads]\n"
+                 "        [-b bits] [-s series] [-r vref] [-u vsupply] [-d] "
+                 "[-c header] [table ...]\n"
+                 "        %s -l catalog [part ...]\n", argv[0], argv[0]);
+        return 1;
+    }
+  }
+  if (list) {
+
+    return iList (list, argv + optind, argc - optind);
+  }
+  if ( (options.dMaxError < 0.0) || (cfg.iBits < 0) || (cfg.iBits > 16) ||
+       (cfg.dSeries < 0.0) || (cfg.dVref <= 0.0)) {
+
+    fprintf (stderr, "Invalid option\n");
+    return 1;
+  }
+
+  memset (&g, 0, sizeof (g));
+  if (optind >= argc) {
+
+    glob (NTC_DATA_DIR "/*.csv", 0, NULL, &g);
+  }
+  else {
+
+    g.gl_pathc = argc - optind;
+    g.gl_pathv = argv + optind;
+  }
+  n = g.gl_pathc;
+  entry = calloc (n + 1, sizeof (xNtcCatalogEntry));
+  res = calloc (n + 1, sizeof (xNtcFitResult));
+  part = calloc (n + 1, sizeof (char *));
+  adc = calloc (n + 1, sizeof (xNtcAdcConfig));
+  if ( (entry == NULL) || (res == NULL) || (part == NULL) || (adc == NULL)) {
+
+    perror (argv[0]);
+    return 1;
+  }
+
+  xNtcFitTables ( (const char * const *) g.gl_pathv, res, n, &options,
+                  threads);
+  for (i = 0; i < n; i++) {
+
+    range[0] = INFINITY;
+    range[1] = -INFINITY;
+    if (res[i].iError ||
+        (llNtcFitReadTable (g.gl_pathv[i], iRange, range, NULL) < 0)) {
+
+      fprintf (stderr, "%s: %s\n", g.gl_pathv[i],
+               strerror (res[i].iError ? res[i].iError : errno));
+      failed = 1;
+      continue;
+    }
+    /* part number: name of the file without extension */
+    part[i] = strdup (strrchr (g.gl_pathv[i], '/') ?
+                      strrchr (g.gl_pathv[i], '/') + 1 : g.gl_pathv[i]);
+    if (part[i] == NULL) {
+
+      perror (argv[0]);
+      return 1;
+    }
+    ext = strrchr (part[i], '.');
+    if (ext && (ext != part[i])) {
+      *ext = 0;
+    }
+
+    entry[i].sPart = part[i];
+    memcpy (entry[i].dCoeff, res[i].dCoeff, sizeof (res[i].dCoeff));
+    entry[i].eForm = res[i].eForm;
+    entry[i].dTmin = range[0];
+    entry[i].dTmax = range[1];
+    entry[i].dMaxError = res[i].dMaxError;
+    entry[i].dRmsError = res[i].dRmsError;
+    if (cfg.iBits) {
+
+      adc[i] = cfg;
+      if (cfg.dSeries == 0.0) {
+
+        adc[i].dSeries = dNtcTempToRes (25.0, res[i].dCoeff);
+      }
+      entry[i].xLut = &adc[i];
+    }
+  }
+
+  if (!failed && header) {
+
+    if (iHeader (header, entry, n) != 0) {
+
+      perror (header);
+      failed = 1;
+    }
+    else {
+
+      printf ("%zu models written to %s\n", n, header);
+    }
+  }
+  else if (!failed) {
+
+    if (iNtcCatalogWrite (output, entry, n) != 0) {
+
+      perror (output);
+      failed = 1;
+    }
+    else {
+
+      printf ("%zu models written to %s\n", n, output);
+    }
+  }
+  for (i = 0; i < n; i++) {
+
+    free (part[i]);
+  }
+  free (part);
+  free (adc);
+  free (res);
+  free (entry);
+  if (optind >= argc) {
+
+    globfree (&g);
+  }
+  return failed;
+}
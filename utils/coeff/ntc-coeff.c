@@ -62,6 +62,12 @@
  * Sum (1/t(r<sub>n</sub>) - 1/t<sub>n</sub>)<sup>2</sup>
  * </i></center>
  *
+ * The fit is done by the ntc-fit module of the library, the table is read
+ * once and may be larger than the memory.
+ *
+ * With several tables, a directory or the option -b, the tables are fitted
+ * in parallel and the coefficients and errors of all the tables are written
+ * to a CSV or JSON results file.
  */
 
 /***********
@@ -71,72 +77,70 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <math.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <glob.h>
+#include <sys/stat.h>
+#include <ntc-fit.h>
 
 
 /*********
 * Macros *
 *********/
 
-/** Dimension of space U. */
+/** Number of coefficients. */
 #define M 4
 
-/** Absolute Zero. */
-#define TABS (-273.15)
-
-/** Maximal line length. */
-#define MAX_LENGTH 80
-
-/** Debug flag. */
-#define DEBUG 1
 
 /***********
 * Typedefs *
 ***********/
-/** Type definition for a polynom. */
-typedef double polynom[M];
+/** Test of the approximation polynom. */
+typedef struct
+{
+  double *a;            /* coefficients */
+  double maxerr;        /* maximal error */
+  double temp;          /* temperature of the maximal error */
+} test;
+
+/** List of table files. */
+typedef struct
+{
+  char **path;
+  size_t count;
+  size_t size;
+} tables;
 
 /************
 * Variables *
 ************/
-//* Dimension of space V. */
-int n;
 static int verbose;
-
-/** Canoncical base of U. */
-polynom basis[] = {
-  {1.0L, 0.0L, 0.0L, 0.0L},             /* basis[0] = 1                         */
-  {0.0L, 1.0L, 0.0L, 0.0L},             /* basis[1] = x                         */
-  {0.0L, 0.0L, 1.0L, 0.0L},             /* basis[2] = x^2                       */
-  {0.0L, 0.0L, 0.0L, 1.0L}              /* basis[3] = x^3                       */
-};
-
-/** x-values calculated from r-values in T-R table. */
-double *x;
-/** y-values calculated from t-values in T-R table. */
-double *y;
+static double lambda = 1.0;
+static xNtcFitOptions options = { eNtcFitLeastSquares, 0.0 };
 
 /**************
 * Prototyping *
 **************/
-/* Evaluate p(x) */
-double value(polynom p, double x);
-/* Evaluate [p,q] */
-double skalarpoly(polynom p, polynom q);
-/* Evaluate p *= fact */
-void mult(polynom p, double fact);
-/* Evaluate p += fact*q */
-void linear(polynom p, polynom q, double fact);
-/* Build orthonormal base p from p */
-void orthonormal(polynom p[]);
-/* Evaluate [p, pf] */
-double skalar(polynom p);
-/* Evaluate approximating polynom. */
-polynom *approx(void);
-/* Reads all temperature- resistance pairs from an T-R table file. */
-void readtable(const char *filename);
+/* Adds a t-r pair to the fit. */
+int addpoint(void *fit, double t, double r);
+/* Tests the approximation polynom with a t-r pair. */
+int testpoint(void *result, double t, double r);
+/* Prints a pair downweighted by a robust fit. */
+void outlier(void *user, long long index, double t, double r, double err,
+             double weight);
 /* Tests the approximation polynom with all t-r pairs. */
-void testresult(polynom *erg);
+void testresult(const char *filename, double a[M]);
+/* Fits one table, printing the results. */
+void fitone(const char *filename);
+/* Fits several tables in parallel, writing a results file. */
+int fitbatch(tables *list, const char *output, const char *format,
+             int threads);
+/* Adds table files to a list. */
+void addtables(tables *list, const char *arg);
+/* Exits with the error of a table file. */
+void tableexit(const char *filename, size_t line);
 /* Exits with error message in case of errors. */
 void errexit(char *format, ...);
 
@@ -144,55 +148,91 @@ void usage (const char * me);
 
 /**
  * Main function for calculating the approximation polynom.
- * Calculation is done in several steps
- *   -# Read all t-r pairs and converting them to x-y values.
- *   -# Evaluate orthonormal base.
+ * With one table, calculation is done in several steps
+ *   -# Read all t-r pairs, adding them to the fit.
  *   -# Evaluate approximation polynom
  *   -# Test approximation polynom
+ *
+ * With several tables, they are fitted by fitbatch().
  * @return 0 indicating no error.
  */
 int main(int argc, char *argv[])
 {
-  polynom *erg;
-  const char * f;
-
-  printf("Thermistor library version 1.0\n");
-  printf("Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany\n\n");
-  if (argc < 2) {
-
-    usage (argv[0]);
-  }
-  if (argc > 2) {
-
-    if (strcmp (argv[1], "-v") == 0) {
-
-      f = argv[2];
-      verbose = 1;
-    }
-    else if (strcmp (argv[2], "-v") == 0) {
-
-      f = argv[1];
-      verbose = 1;
-    }
-    else {
-
-      usage (argv[0]);
+  tables list = { NULL, 0, 0 };
+  const char *output = NULL, *format = NULL;
+  struct stat st;
+  int c, threads = 0, batch = 0;
+
+  while ((c = getopt(argc, argv, "vl:e:mr:t:bj:o:f:h")) != -1) {
+    switch (c) {
+      case 'v':
+        verbose = 1;
+        break;
+      case 'l':
+        lambda = atof(optarg);
+        break;
+      case 'e':
+        options.dMaxError = atof(optarg);
+        if (!(options.dMaxError > 0))
+          errexit("Invalid maximal error %s\n", optarg);
+        break;
+      case 'm':
+        options.eMethod = eNtcFitMinimax;
+        break;
+      case 'r':
+        if (strcmp(optarg, "huber") == 0)
+          options.eMethod = eNtcFitHuber;
+        else if (strcmp(optarg, "trim") == 0)
+          options.eMethod = eNtcFitTrimmed;
+        else
+          errexit("Unknown robust fit %s\n", optarg);
+        break;
+      case 't':
+        options.dThreshold = atof(optarg);
+        if (!(options.dThreshold > 0))
+          errexit("Invalid threshold %s\n", optarg);
+        break;
+      case 'b':
+        batch = 1;
+        break;
+      case 'j':
+        threads = atoi(optarg);
+        batch = 1;
+        break;
+      case 'o':
+        output = optarg;
+        batch = 1;
+        break;
+      case 'f':
+        format = optarg;
+        batch = 1;
+        break;
+      default:
+        usage(argv[0]);
     }
   }
-  else {
-
-    f = argv[1];
-    verbose = 0;
+  if (optind >= argc)
+    usage(argv[0]);
+  if ((argc - optind > 1) ||
+      ((stat(argv[optind], &st) == 0) && S_ISDIR(st.st_mode)))
+    batch = 1;
+
+  if (!batch) {
+
+    printf("Thermistor library version 1.0\n");
+    printf("Copyright (C) 2007, 2013 - SoftQuadrat GmbH, Germany\n\n");
+    fitone(argv[optind]);
+    return 0;
   }
-
-  readtable(f);
-  orthonormal(basis);
-  erg = approx();
-  testresult(erg);
-  return 0;
+  if (lambda != 1.0)
+    errexit("A forgetting factor can not be used in batch mode\n");
+  for (; optind < argc; optind++)
+    addtables(&list, argv[optind]);
+  if (list.count == 0)
+    errexit("No table file found\n");
+  return fitbatch(&list, output, format, threads) ? EXIT_FAILURE : 0;
 }
 
-
 /************
 * Functions *
 ************/
@@ -201,6 +241,7 @@ void
 usage (const char * me) {
 
   fprintf(stderr, "usage : %s [ options ] file  [ options ]\n", me);
+  fprintf(stderr, "        %s [ options ] file|directory|pattern ...\n", me);
   fprintf(stderr,
   "Program calculating the coefficients of an extended Steinhart-Hart polynom.\n"
   " The Steinhart-Hart polynom allows calculation of absolute temperature\n"
@@ -208,260 +249,419 @@ usage (const char * me) {
 
   fprintf(stderr,"valid options are :\n");
   fprintf(stderr,
-  "  -v\tenables verbose output\n");
+  "  -v\tenables verbose output\n"
+  "  -l f\tforgetting factor in ]0,1] of the fit of one table, the weight of\n"
+  "\ta pair is multiplied by f at each following pair (default 1)\n"
+  "  -e err\tselects the smallest form of the polynom (simplified, standard\n"
+  "\tor extended) whose maximal error is below err degree Celsius\n"
+  "  -m\tminimizes the maximal temperature error (minimax) instead of the\n"
+  "\tsquares of the errors of 1/t\n"
+  "  -r fit\trobust fit, huber (pairs beyond the threshold are downweighted)\n"
+  "\tor trim (pairs beyond the threshold are removed), the downweighted\n"
+  "\tpairs are listed in verbose mode\n"
+  "  -t err\tthreshold of the robust fit in degree Celsius (default 1.345\n"
+  "\t(huber) or 3 (trim) robust standard deviations of the errors)\n"
+  "  -b\tbatch mode, implied by several tables or a directory\n"
+  "  -j n\tnumber of threads of the batch mode, all processors by default\n"
+  "  -o file\twrites the results of the batch mode to file (default stdout)\n"
+  "  -f fmt\tformat of the results, csv or json (default from -o extension,\n"
+  "\tcsv otherwise)\n");
   exit(EXIT_FAILURE);
 }
 
 /**
- * Evaluates p(x) for a polynom p.
- * Calculates the value of polynom p at x accordings to
- * Horners schema.
- * @param p polynom.
- * @param x value to be inserted into the polynom.
- * @return calculated polynom value.
+ * Fits one table, printing the results.
+ * @param filename name of file with all t-r pairs.
  */
-double value(polynom p, double x)
+void fitone(const char *filename)
 {
+  xNtcFit *fit;
+  xNtcFitStats stats;
+  xNtcFitResult res;
+  double a[M];
+  size_t line;
   int i;
-  double retval = 0.0L;
 
-  for (i = M - 1; i >= 0; i--)
-    retval = retval * x + p[i];
-  return retval;
+  if ((options.dMaxError > 0) || (options.eMethod != eNtcFitLeastSquares)) {
+
+    if (lambda != 1.0)
+      errexit("A forgetting factor can not be used with -e, -m or -r\n");
+    if (verbose && (options.eMethod >= eNtcFitHuber)) {
+      printf("Downweighted pairs\n");
+      printf("==================\n");
+      options.vOutlier = outlier;
+    }
+    if (iNtcFitTable(filename, &options, &res) != 0) {
+      if (res.iError == EDOM)
+        errexit("%s: less than %d different resistances\n", filename, M);
+      if (res.iError == ENOMEM)
+        errexit("Not enough memory\n");
+      errno = res.iError;
+      tableexit(filename, res.xLine);
+    }
+    if (options.eMethod >= eNtcFitHuber) {
+      if (verbose)
+        printf("\n");
+      printf("%lld of %lld pairs downweighted, maximal error=%7.5f\n",
+             res.llDownweighted, res.xStats.llCount, res.dDownweightedError);
+    }
+    printf("Form: %s, maximal error=%7.5f at temperature=%5.1f\n",
+           sNtcFormName(res.eForm), res.dMaxError, res.dMaxErrorTemp);
+    printf("Steinhart-Hart coefficients\n");
+    for (i = 0; i < M; i++)
+      printf("a[%d] = %.15e\n", i, res.dCoeff[i]);
+    if (verbose)
+      printf("\n");
+    testresult(filename, res.dCoeff);
+    return;
+  }
+  fit = xNtcFitNew();
+  if (fit == NULL)
+    errexit("Not enough memory\n");
+  if (iNtcFitSetForgetting(fit, lambda) != 0)
+    errexit("Invalid forgetting factor %g\n", lambda);
+  if (verbose)
+  {
+    printf("function readtable\n");
+    printf("==================\n");
+  }
+  if (llNtcFitReadTable(filename, addpoint, fit, &line) < 0)
+    tableexit(filename, line);
+  if (verbose)
+  {
+    printf("\n");
+    printf("function approx\n");
+    printf("===============\n");
+  }
+  if (iNtcFitSolve(fit, a, &stats) != 0)
+    errexit("%s: less than %d different resistances\n", filename, M);
+  vNtcFitDelete(fit);
+  if (verbose)
+    printf("%lld points, residual rms=%.3e\n", stats.llCount, stats.dRms);
+  printf("Steinhart-Hart coefficients\n");
+  for (i = 0; i < M; i++)
+    printf("a[%d] = %.15e\n", i, a[i]);
+  if (verbose)
+    printf("\n");
+  testresult(filename, a);
 }
 
 /**
- * Evaluates [p,q] for two polynoms p and q.
- * Calculates the scalar product of two polynoms p and q.
- * This is defined as sum
- * <center>[p, q] := Sum p(x<sub>i</sub>) * q(x<sub>i</sub>) &uuml;ber i = 0, .., N - 1</center>
- * @param p first polynom.
- * @param q second polynom.
- * @return calculated scalar product.
+ * Compares two file names for qsort().
+ * @param a first name.
+ * @param b second name.
+ * @return strcmp() of the names.
  */
-double skalarpoly(polynom p, polynom q)
+static int compare(const void *a, const void *b)
 {
-  int i;
-  double retval = 0.0L;
+  return strcmp(*(char *const *) a, *(char *const *) b);
+}
 
-  for (i = 0; i < n; i++)
-    retval += value(p, x[i]) * value(q, x[i]);
-  return retval;
+/**
+ * Appends a file name to a list of tables.
+ * @param list list of tables.
+ * @param path file name, copied.
+ */
+static void append(tables *list, const char *path)
+{
+  if (list->count == list->size) {
+    list->size = list->size ? 2 * list->size : 64;
+    list->path = realloc(list->path, list->size * sizeof(char *));
+    if (list->path == NULL)
+      errexit("Not enough memory\n");
+  }
+  list->path[list->count++] = strdup(path);
 }
 
 /**
- * Evaluates p *= fact for a polynom p and a factor fact.
- * Multiplies p with a factor fact.
- * @param p polynom.
- * @param fact factor.
+ * Adds table files to a list.
+ * A directory adds its files ending with .csv or .txt, a pattern (quoted
+ * to be passed unexpanded by the shell) adds the matching files, sorted by
+ * name, any other argument is added as it is.
+ * @param list list of tables.
+ * @param arg file, directory or pattern.
  */
-void mult(polynom p, double fact)
+void addtables(tables *list, const char *arg)
 {
-  int i;
+  struct stat st;
+  struct dirent *e;
+  glob_t g;
+  char path[4096];
+  const char *ext;
+  size_t i, first;
+  DIR *d;
+
+  if ((stat(arg, &st) == 0) && S_ISDIR(st.st_mode)) {
+
+    d = opendir(arg);
+    if (d == NULL)
+      errexit("Cannot read directory %s: %s\n", arg, strerror(errno));
+    first = list->count;
+    while ((e = readdir(d)) != NULL) {
+      ext = strrchr(e->d_name, '.');
+      if ((ext == NULL) || ((strcmp(ext, ".csv") != 0) &&
+                            (strcmp(ext, ".txt") != 0)))
+        continue;
+      snprintf(path, sizeof(path), "%s/%s", arg, e->d_name);
+      if ((stat(path, &st) == 0) && S_ISREG(st.st_mode))
+        append(list, path);
+    }
+    closedir(d);
+    qsort(list->path + first, list->count - first, sizeof(char *), compare);
+  }
+  else if ((strpbrk(arg, "*?[") != NULL) && (glob(arg, 0, NULL, &g) == 0)) {
 
-  for (i = 0; i < M; i++)
-    p[i] *= fact;
+    for (i = 0; i < g.gl_pathc; i++)
+      append(list, g.gl_pathv[i]);
+    globfree(&g);
+  }
+  else
+    append(list, arg);
 }
 
 /**
- * Evaluates p += fact*q for two polynoms p and q and a factor fact.
- * Adds a multiple of a polynom q to polynom p.
- * @param p polynom, to be added to.
- * @param q qolynom, added with a factor.
- * @param fact factor.
+ * Error message of a failed fit.
+ * @param r result of the fit.
+ * @param msg buffer of the message.
+ * @param size size of the buffer.
+ * @return msg.
  */
-void linear(polynom p, polynom q, double fact)
+static const char *message(const xNtcFitResult *r, char *msg, size_t size)
 {
-  int i;
+  if (r->iError == EDOM)
+    snprintf(msg, size, "less than %d different resistances", M);
+  else if (r->xLine == 0)
+    snprintf(msg, size, "%s", strerror(r->iError));
+  else
+    snprintf(msg, size, "line %zu: %s", r->xLine,
+             (r->iError == ERANGE) ? "value out of range" : "invalid line");
+  return msg;
+}
 
-  for (i = 0; i < M; i++)
-    p[i] += q[i] * fact;
+/**
+ * Writes a string with the escapes of JSON.
+ * @param f output.
+ * @param s string.
+ */
+static void json(FILE *f, const char *s)
+{
+  fputc('"', f);
+  for (; *s; s++) {
+    if ((*s == '"') || (*s == '\\'))
+      fprintf(f, "\\%c", *s);
+    else if ((unsigned char) *s < 0x20)
+      fprintf(f, "\\u%04x", *s);
+    else
+      fputc(*s, f);
+  }
+  fputc('"', f);
 }
 
 /**
- * Converts a base to an orthonormal base.
- * @param p base in form of an array of polynoms.
+ * Writes a string as a CSV field, quoted if needed.
+ * @param f output.
+ * @param s string.
  */
-void orthonormal(polynom p[])
+static void csv(FILE *f, const char *s)
 {
-  int i, j;
-  double fact, norm;
+  if (strpbrk(s, ",\"\r\n") == NULL) {
+    fputs(s, f);
+    return;
+  }
+  fputc('"', f);
+  for (; *s; s++) {
+    if (*s == '"')
+      fputc('"', f);
+    fputc(*s, f);
+  }
+  fputc('"', f);
+}
 
-  if (verbose)
-  {
-    printf("function orthonormal\n");
-    printf("====================\n");
+/**
+ * Fits several tables in parallel, writing a results file.
+ * Each line (CSV) or object (JSON) holds the file name, the number of
+ * pairs, the form and the coefficients, the root mean square of the residuals of 1/t,
+ * the root mean square and the maximal temperature errors, the number of
+ * pairs downweighted by a robust fit, and the error
+ * message if the fit failed.
+ * @param list list of tables.
+ * @param output name of the results file, NULL for stdout.
+ * @param format "csv", "json", NULL to choose from the output name.
+ * @param threads number of threads, 0 for all the processors.
+ * @return number of tables whose fit failed.
+ */
+int fitbatch(tables *list, const char *output, const char *format,
+             int threads)
+{
+  xNtcFitResult *res, *r;
+  const char *ext;
+  char msg[128];
+  size_t i, failed;
+  int j, isjson;
+  FILE *f;
+
+  if (format == NULL) {
+    ext = output ? strrchr(output, '.') : NULL;
+    format = (ext && (strcmp(ext, ".json") == 0)) ? "json" : "csv";
   }
-  for (i = 0; i < M; i++) {
-    if (verbose)
-      printf("Evaluating polynom number %d\n", i);
-    for (j = 0; j < i; j++) {
-      fact = skalarpoly(p[i], p[j]);
-      linear(p[i], p[j], -fact);
-    }
-    norm = skalarpoly(p[i], p[i]);
-    mult(p[i], 1.0L / sqrt(norm));
-    if (verbose)
-    {
-      printf("Polynom %d: ", i);
-      for (j = 0; j < M; j++)
-      {
-        printf("%f ", p[i][j]);
+  if ((strcmp(format, "csv") != 0) && (strcmp(format, "json") != 0))
+    errexit("Unknown format %s\n", format);
+  isjson = (strcmp(format, "json") == 0);
+  f = output ? fopen(output, "w") : stdout;
+  if (f == NULL)
+    errexit("Cannot create file %s: %s\n", output, strerror(errno));
+  res = malloc(list->count * sizeof(xNtcFitResult));
+  if (res == NULL)
+    errexit("Not enough memory\n");
+
+  failed = xNtcFitTables((const char *const *) list->path, res, list->count,
+                         &options, threads);
+
+  if (isjson)
+    fprintf(f, "[\n");
+  else
+    fprintf(f, "file,count,form,a0,a1,a2,a3,rms,rms_error,max_error,"
+               "max_error_temp,downweighted,downweighted_error,error\n");
+  for (i = 0; i < list->count; i++) {
+    r = &res[i];
+    if (isjson) {
+      fprintf(f, "  { \"file\": ");
+      json(f, list->path[i]);
+      if (r->iError) {
+        fprintf(f, ", \"error\": ");
+        json(f, message(r, msg, sizeof(msg)));
       }
-      printf("\n");
+      else {
+        fprintf(f, ", \"count\": %lld, \"form\": \"%s\", \"a\": [",
+                r->xStats.llCount, sNtcFormName(r->eForm));
+        for (j = 0; j < M; j++)
+          fprintf(f, "%s%.15e", j ? ", " : "", r->dCoeff[j]);
+        fprintf(f, "], \"rms\": %.6e, \"rms_error\": %.6e, "
+                "\"max_error\": %.6e, \"max_error_temp\": %.2f, "
+                "\"downweighted\": %lld, \"downweighted_error\": %.6e",
+                r->xStats.dRms, r->dRmsError, r->dMaxError,
+                r->dMaxErrorTemp, r->llDownweighted, r->dDownweightedError);
+      }
+      fprintf(f, " }%s\n", (i + 1 < list->count) ? "," : "");
     }
-  }
-  if (verbose) {
-    printf("Testing orthonormal base\n");
-    for (i = 0; i < M; i++) {
-      for (j = 0; j <= i; j++)
-        printf("%.15f ", skalarpoly(basis[i], basis[j]));
-      printf("\n");
+    else {
+      csv(f, list->path[i]);
+      if (r->iError) {
+        fprintf(f, ",,,,,,,,,,,,,");
+        csv(f, message(r, msg, sizeof(msg)));
+      }
+      else {
+        fprintf(f, ",%lld,%s", r->xStats.llCount, sNtcFormName(r->eForm));
+        for (j = 0; j < M; j++)
+          fprintf(f, ",%.15e", r->dCoeff[j]);
+        fprintf(f, ",%.6e,%.6e,%.6e,%.2f,%lld,%.6e,", r->xStats.dRms,
+                r->dRmsError, r->dMaxError, r->dMaxErrorTemp,
+                r->llDownweighted, r->dDownweightedError);
+      }
+      fprintf(f, "\n");
     }
-    printf("\n");
   }
+  if (isjson)
+    fprintf(f, "]\n");
+  if ((f != stdout) && (fclose(f) != 0))
+    errexit("Cannot write file %s: %s\n", output, strerror(errno));
+  if (failed)
+    fprintf(stderr, "%zu of %zu tables failed\n", failed, list->count);
+  free(res);
+  return failed != 0;
 }
 
 /**
- * Evaluates [p, p<sub>f</sub>] for given polynom p and solving polynom p<sub>f</sub>.
- * @param p polynom.
- * @return calculated scalar product.
+ * Adds a t-r pair to the fit.
+ * @param fit fit.
+ * @param t temperature.
+ * @param r resistance.
+ * @return 0, -1 if the pair is out of range.
  */
-double skalar(polynom p)
+int addpoint(void *fit, double t, double r)
 {
-  int i;
-  double retval = 0.0L;
-
-  for (i = 0; i < n; i++)
-    retval += y[i] * value(p, x[i]);
-  return retval;
+  if (verbose)
+    printf("t=%8.2f\tr=%8.2f\n", t, r);
+  return iNtcFitAdd(fit, t, r);
 }
 
 /**
- * Evaluate approximation polynom u<sub>f</sub>.
- * @return approximation polynom u<sub>f</sub>.
+ * Tests the approximation polynom with a t-r pair.
+ * @param result test in progress.
+ * @param t temperature.
+ * @param r resistance.
+ * @return 0.
  */
-polynom *approx(void)
+int testpoint(void *result, double t, double r)
 {
-  int i;
-  double fact;
-  polynom *erg = malloc(sizeof(polynom));
+  test *p = result;
+  double val, err;
 
-  if (verbose)
+  val = dNtcResToTemp(r, p->a);
+  err = fabs(val - t);
+  printf("%8.3f\t%8.1f\t%8.1f\n", val, r, t);
+  if (err > p->maxerr)
   {
-    printf("function approx\n");
-    printf("===============\n");
-  }
-  for (i = 0; i < M; i++)
-    (*erg)[i] = 0.0L;
-  for (i = 0; i < M; i++) {
-    if (verbose)
-      printf("Approximating with polynom number %d\n", i);
-    fact = skalar(basis[i]);
-    linear(*erg, basis[i], fact);
+    p->temp = t;
+    p->maxerr = err;
   }
-  printf("Steinhart-Hart coefficients\n");
-  for (i = 0; i < M; i++)
-    printf("a[%d] = %.15e\n", i, (*erg)[i]);
-  if (verbose)
-    printf("\n");
-  return erg;
+  return 0;
 }
 
 /**
- * Reads all temperature- resistance pairs from an T-R table file.
- * The resulting values are converted from t-r pairs to x-y pairs
- * where x = ln(r) and y = 1 / (t - TABS).
- * @param filename name of file with all t-r pairs.
+ * Prints a pair downweighted by a robust fit.
+ * @param user unused.
+ * @param index index of the pair in the table.
+ * @param t temperature.
+ * @param r resistance.
+ * @param err temperature error of the pair.
+ * @param weight weight of the pair.
  */
-void readtable(const char *filename)
+void outlier(void *user, long long index, double t, double r, double err,
+             double weight)
 {
-  double temp;
-  double res;
-  FILE *fr;
-  char *line;
-  double *t, *r;
-  int num;
-  int i;
-
-  if (verbose)
-  {
-    printf("function readtable\n");
-    printf("==================\n");
-  }
-  num = 50;
-  t = malloc(num * sizeof(double));
-  r = malloc(num * sizeof(double));
-  fr = fopen(filename, "r");
-  if (fr == NULL)
-    errexit("Cannot find file %s", filename);
-  line = malloc(MAX_LENGTH);
-  for (i = 0; fgets(line, MAX_LENGTH - 1, fr) != NULL; i++)
-  {
-    if (i >= num)
-    {
-      num *= 2;
-      t = realloc(t, num * sizeof(double));
-      r = realloc(r, num * sizeof(double));
-
-    }
-    sscanf(line, "%lf\t%lf", &temp, &res);
-    t[i] = temp;
-    r[i] = res;
-    if (verbose)
-      printf("t=%8.2f\tr=%8.2f\n", t[i], r[i]);
-  }
-  if (verbose)
-    printf("\n");
-  n = i;
-  x = malloc(n * sizeof(double));
-  y = malloc(n * sizeof(double));
-  for (i = 0; i < n; i++) {
-    x[i] = log(r[i]);
-    y[i] = 1.0 / (t[i] - TABS);
-    if (verbose)
-      printf("x=%8.2f\ty=%9.4f\n", x[i], y[i]);
-  }
-  if (verbose)
-    printf("\n");
+  (void) user;
+  printf("%6lld %8.3f %10.1f %9.5f %7.5f\n", index, t, r, err, weight);
 }
 
 /**
  * Tests the approximation polynom with all t-r pairs.
- * Prints out all calculated values and the maximal error.
- * The function will do nothing, if verbose mode is off
- * (Macro DEBUG = 0).
- * @param erg approximation polynom.
+ * Prints out all calculated values and the maximal error, reading the
+ * table file again.
+ * The function will do nothing, if verbose mode is off.
+ * @param filename name of file with all t-r pairs.
+ * @param a approximation polynom.
  */
-void testresult(polynom *erg)
+void testresult(const char *filename, double a[M])
 {
-  double maxerr, val1, val2, err, temp = 0;
-  int i;
+  test result = { a, 0.0, 0.0 };
 
   if (verbose)
   {
     printf("function testresult\n");
     printf("===================\n");
-    maxerr = 0.0;
-    for (i = 0; i < n; i++) {
-      val1 = 1.0 / value(*erg, x[i]) + TABS;
-      val2 = 1.0 / y[i] + TABS;
-      err = val1 - val2;
-      if (err < 0)
-        err = -err;
-      printf("%8.3f\t%8.1f\t%8.1f\n", val1, exp(x[i]), val2);
-      if (err > maxerr)
-      {
-        temp = val2;
-        maxerr = err;
-      }
-    }
+    llNtcFitReadTable(filename, testpoint, &result, NULL);
     printf("\n");
-    printf("Maximal error=%7.5f at temperature=%5.1f\n", maxerr, temp);
+    printf("Maximal error=%7.5f at temperature=%5.1f\n", result.maxerr,
+           result.temp);
     printf("\n");
   }
 }
 
+/**
+ * Exits with the error of a table file.
+ * @param filename name of file.
+ * @param line line of the error, 0 if the file can not be read.
+ */
+void tableexit(const char *filename, size_t line)
+{
+  if (line == 0)
+    errexit("Cannot read file %s: %s\n", filename, strerror(errno));
+  if (errno == ERANGE)
+    errexit("%s:%zu: value out of range\n", filename, line);
+  errexit("%s:%zu: invalid line\n", filename, line);
+}
+
 /**
  * Exits with error message in case of errors.
  * @param format of error message.
@@ -475,4 +675,3 @@ void errexit(char *format, ...)
   va_end(ap);
   exit(EXIT_FAILURE);
 }
-